@@ -0,0 +1,303 @@
+// AcquisitionDaemon.cpp : Long-running acquisition server with a local control pipe.
+//
+
+#include "stdafx.h"
+#include "AcquisitionDaemon.h"
+#include "ThermalTelemetry.h"
+#if defined(SDK_RECORD) || defined(SDK_REPLAY)
+#include "StreamReplay.h"
+#endif
+
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+#include <windows.h>
+
+static float DmMilliseconds(std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end)
+{
+	return std::chrono::duration<float, std::milli>(end - start).count();
+}
+
+static void DmFillStatus(const AcquisitionDaemon *daemon, DmReply *reply)
+{
+	ThermalSample sample;
+	if (daemon->telemetry && daemon->telemetry->GetLatest(&sample)) {
+		reply->temperature = sample.temperature;
+		reply->temperatureStatus = sample.status;
+	}
+	else {
+		reply->temperature = 0.0f;
+		reply->temperatureStatus = DRV_TEMP_NOT_SUPPORTED;
+	}
+	reply->jobsRun = daemon->jobsRun;
+}
+
+// Only the settings that differ from the previous job reach the SDK
+static unsigned int DmApplyJob(AcquisitionDaemon *daemon, const DmJob *job)
+{
+	AcquisitionSettings settings;
+	SsDefaultSettings(&settings, job->hend, job->vend);
+	settings.acquisitionMode = 3;
+	settings.exposure = job->exposure;
+	settings.triggerMode = job->triggerMode;
+	settings.hbin = job->hbin;
+	settings.vbin = job->vbin;
+	settings.hstart = job->hstart;
+	settings.vstart = job->vstart;
+	settings.numberKinetics = (int)job->frames;
+	settings.kineticCycle = job->kineticCycle;
+	return SsApply(&daemon->shadow, &settings);
+}
+
+// Keeps the broadcast ring open between jobs unless its name or size changes
+static unsigned int DmOpenBroadcast(AcquisitionDaemon *daemon, const char *name, size_t frameBytes)
+{
+	if (daemon->broadcast.header && daemon->broadcastName == name && daemon->broadcastBytes >= frameBytes)
+		return DRV_SUCCESS;
+	FbClose(&daemon->broadcast);
+	daemon->broadcastName.clear();
+	unsigned int error = FbCreate(&daemon->broadcast, name, 8, frameBytes);
+	if (error != DRV_SUCCESS)
+		return error;
+	daemon->broadcastName = name;
+	daemon->broadcastBytes = frameBytes;
+	return DRV_SUCCESS;
+}
+
+//------------------------------------------------------------------------------
+// Server
+//------------------------------------------------------------------------------
+
+void DmInitialise(AcquisitionDaemon *daemon, const char *pipeName, ThermalTelemetry *telemetry)
+{
+	daemon->pipeName = pipeName ? pipeName : DM_PIPE_NAME;
+	daemon->telemetry = telemetry;
+	memset(&daemon->broadcast, 0, sizeof(daemon->broadcast));
+	daemon->broadcastName.clear();
+	daemon->broadcastBytes = 0;
+	daemon->buffer.clear();
+	SsInitialise(&daemon->shadow);
+	daemon->jobsRun = 0;
+	daemon->stop = false;
+}
+
+unsigned int DmRunJob(AcquisitionDaemon *daemon, const DmJob *job, DmReply *reply)
+{
+	if (daemon == NULL)
+		return DRV_P1INVALID;
+	if (job == NULL)
+		return DRV_P2INVALID;
+	if (reply == NULL)
+		return DRV_P3INVALID;
+
+	reply->frames = 0;
+	reply->setupMs = 0.0f;
+	reply->acquireMs = 0.0f;
+	if (job->hbin <= 0 || job->vbin <= 0 || job->hend < job->hstart || job->vend < job->vstart || job->frames == 0)
+		return reply->result = DRV_P2INVALID;
+	int width = (job->hend - job->hstart + 1) / job->hbin;
+	int height = (job->vend - job->vstart + 1) / job->vbin;
+	size_t pixels = (size_t)width * height;
+	if (daemon->buffer.size() < pixels)
+		daemon->buffer.resize(pixels);
+
+	// Temperature sampling waits while the job drives the camera
+	std::unique_lock<std::mutex> sdkLock;
+	if (daemon->telemetry)
+		sdkLock = std::unique_lock<std::mutex>(daemon->telemetry->GetSdkLock());
+
+	std::chrono::steady_clock::time_point setupStart = std::chrono::steady_clock::now();
+	unsigned int error = DmApplyJob(daemon, job);
+	FILE *file = NULL;
+	if (error == DRV_SUCCESS && (job->sinks & DM_SINK_FILE)) {
+		file = fopen(job->path, "ab");
+		if (file == NULL)
+			error = DRV_ERROR_FILESAVE;
+	}
+	if (error == DRV_SUCCESS && (job->sinks & DM_SINK_BROADCAST))
+		error = DmOpenBroadcast(daemon, job->broadcast, pixels * sizeof(WORD));
+	std::chrono::steady_clock::time_point acquireStart = std::chrono::steady_clock::now();
+	reply->setupMs = DmMilliseconds(setupStart, acquireStart);
+	if (error == DRV_SUCCESS)
+		error = StartAcquisition();
+
+	// Frames are fetched as they arrive so jobs longer than the SDK's
+	// circular buffer do not lose any
+	uint32_t delivered = 0;
+	while (error == DRV_SUCCESS && delivered < job->frames) {
+		unsigned int waited = WaitForAcquisitionTimeOut(job->timeoutMs);
+		long first, last;
+		if (GetNumberNewImages(&first, &last) != DRV_SUCCESS) {
+			if (waited != DRV_SUCCESS)
+				error = waited;
+			continue;
+		}
+		for (long index = first; index <= last && error == DRV_SUCCESS; index++) {
+			long validFirst, validLast;
+			error = GetImages16(index, index, daemon->buffer.data(), (unsigned long)pixels, &validFirst, &validLast);
+			if (error != DRV_SUCCESS)
+				break;
+			if (file && fwrite(daemon->buffer.data(), sizeof(WORD), pixels, file) != pixels)
+				error = DRV_ERROR_FILESAVE;
+			if (job->sinks & DM_SINK_BROADCAST)
+				FbPublish(&daemon->broadcast, daemon->buffer.data(), width, height, sizeof(WORD), ThermalTelemetry::Now());
+			delivered++;
+		}
+	}
+	int status;
+	if (GetStatus(&status) == DRV_SUCCESS && status == DRV_ACQUIRING)
+		AbortAcquisition();
+	reply->acquireMs = DmMilliseconds(acquireStart, std::chrono::steady_clock::now());
+	reply->frames = delivered;
+	if (file && fclose(file) != 0 && error == DRV_SUCCESS)
+		error = DRV_ERROR_FILESAVE;
+	daemon->jobsRun++;
+	return reply->result = error;
+}
+
+// Jobs write files wherever the request says, so the pipe only accepts local
+// clients running as the same user as the daemon
+static HANDLE DmCreatePipe(const char *pipeName)
+{
+	HANDLE token;
+	if (!OpenProcessToken(GetCurrentProcess(), TOKEN_QUERY, &token))
+		return INVALID_HANDLE_VALUE;
+	struct {
+		TOKEN_USER			user;
+		BYTE				sid[SECURITY_MAX_SID_SIZE];
+	} user;
+	DWORD userBytes;
+	BOOL haveUser = GetTokenInformation(token, TokenUser, &user, sizeof(user), &userBytes);
+	CloseHandle(token);
+	if (!haveUser)
+		return INVALID_HANDLE_VALUE;
+
+	// A DACL with the one entry, granting the daemon's user everything
+	struct {
+		ACL					acl;
+		ACCESS_ALLOWED_ACE	ace;
+		BYTE				sid[SECURITY_MAX_SID_SIZE];
+	} dacl;
+	SECURITY_DESCRIPTOR descriptor;
+	if (!InitializeAcl(&dacl.acl, sizeof(dacl), ACL_REVISION)
+		|| !AddAccessAllowedAce(&dacl.acl, ACL_REVISION, GENERIC_ALL, user.user.User.Sid)
+		|| !InitializeSecurityDescriptor(&descriptor, SECURITY_DESCRIPTOR_REVISION)
+		|| !SetSecurityDescriptorDacl(&descriptor, TRUE, &dacl.acl, FALSE))
+		return INVALID_HANDLE_VALUE;
+	SECURITY_ATTRIBUTES attributes = { sizeof(attributes), &descriptor, FALSE };
+
+	// One instance, reused for every client: jobs cannot overlap anyway
+	return CreateNamedPipeA(pipeName, PIPE_ACCESS_DUPLEX,
+		PIPE_TYPE_MESSAGE | PIPE_READMODE_MESSAGE | PIPE_WAIT | PIPE_REJECT_REMOTE_CLIENTS, 1,
+		sizeof(DmReply), sizeof(DmRequest), 0, &attributes);
+}
+
+unsigned int DmServe(AcquisitionDaemon *daemon)
+{
+	if (daemon == NULL)
+		return DRV_P1INVALID;
+
+	HANDLE pipe = DmCreatePipe(daemon->pipeName.c_str());
+	if (pipe == INVALID_HANDLE_VALUE)
+		return DRV_NOT_AVAILABLE;
+
+	unsigned int result = DRV_SUCCESS;
+	while (!daemon->stop) {
+		if (!ConnectNamedPipe(pipe, NULL)) {
+			// A client that has already closed its end (ERROR_NO_DATA) fails
+			// the read below and is disconnected like any other
+			DWORD error = GetLastError();
+			if (error != ERROR_PIPE_CONNECTED && error != ERROR_NO_DATA) {
+				result = DRV_NOT_AVAILABLE;
+				break;
+			}
+		}
+
+		DmRequest request;
+		DWORD read = 0;
+		if (ReadFile(pipe, &request, sizeof(request), &read, NULL) && read == sizeof(request)
+			&& request.magic == DM_MAGIC && request.version == DM_VERSION) {
+			DmReply reply;
+			memset(&reply, 0, sizeof(reply));
+			reply.magic = DM_MAGIC;
+			reply.version = DM_VERSION;
+			reply.type = request.type;
+			reply.result = DRV_SUCCESS;
+			switch (request.type) {
+			case DM_PING:
+			case DM_GET_STATUS:
+				break;
+			case DM_RUN_JOB:
+				request.job.path[sizeof(request.job.path) - 1] = 0;
+				request.job.broadcast[sizeof(request.job.broadcast) - 1] = 0;
+				DmRunJob(daemon, &request.job, &reply);
+				break;
+			case DM_SHUTDOWN:
+				daemon->stop = true;
+				break;
+			default:
+				reply.result = DRV_NOT_SUPPORTED;
+				break;
+			}
+			DmFillStatus(daemon, &reply);
+			DWORD written;
+			WriteFile(pipe, &reply, sizeof(reply), &written, NULL);
+			FlushFileBuffers(pipe);
+		}
+		DisconnectNamedPipe(pipe);
+	}
+	CloseHandle(pipe);
+	return result;
+}
+
+void DmClose(AcquisitionDaemon *daemon)
+{
+	FbClose(&daemon->broadcast);
+	daemon->broadcastName.clear();
+	daemon->broadcastBytes = 0;
+	std::vector<WORD>().swap(daemon->buffer);
+}
+
+//------------------------------------------------------------------------------
+// Client
+//------------------------------------------------------------------------------
+
+void DmDefaultJob(DmJob *job, int xPixels, int yPixels)
+{
+	memset(job, 0, sizeof(*job));
+	job->exposure = 0.01f;
+	job->kineticCycle = 0.0f;
+	job->hbin = 1;
+	job->vbin = 1;
+	job->hstart = 1;
+	job->hend = xPixels;
+	job->vstart = 1;
+	job->vend = yPixels;
+	job->triggerMode = 0;
+	job->frames = 1;
+	job->timeoutMs = 10000;
+	job->sinks = 0;
+}
+
+unsigned int DmCall(const char *pipeName, DmMessageType type, const DmJob *job, DmReply *reply)
+{
+	if (reply == NULL)
+		return DRV_P4INVALID;
+	if (type == DM_RUN_JOB && job == NULL)
+		return DRV_P3INVALID;
+
+	DmRequest request;
+	memset(&request, 0, sizeof(request));
+	request.magic = DM_MAGIC;
+	request.version = DM_VERSION;
+	request.type = (uint16_t)type;
+	if (job)
+		request.job = *job;
+	DWORD read = 0;
+	if (!CallNamedPipeA(pipeName ? pipeName : DM_PIPE_NAME, &request, sizeof(request),
+		reply, sizeof(*reply), &read, NMPWAIT_WAIT_FOREVER))
+		return DRV_NOT_AVAILABLE;
+	if (read != sizeof(*reply) || reply->magic != DM_MAGIC || reply->version != DM_VERSION)
+		return DRV_NOT_AVAILABLE;
+	return reply->result;
+}
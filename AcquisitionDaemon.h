@@ -0,0 +1,109 @@
+// AcquisitionDaemon.h : Long-running acquisition server with a local control pipe.
+//
+// Andor_test.cpp pays for Initialize(), cooling and ShutDown() on every run.
+// Started with --daemon it instead keeps the camera initialised and cooled
+// and serves acquisition jobs from other local programs, so back-to-back
+// measurements only pay for programming the job itself.
+//
+// Jobs arrive on a named pipe as fixed-size binary messages: a DmRequest
+// carrying the settings, frame count and sinks, answered by a DmReply once
+// the job has finished. A client needs only this header and DmCall(). Frames
+// are appended to a raw file of consecutive 16-bit images, so jobs naming
+// the same file extend it, sent to a FrameBroadcast ring for live readers,
+// or both. The broadcast ring, the frame buffer and a
+// SettingsShadow are kept between jobs, so a job repeating the previous
+// one's settings starts without reprogramming the camera. Since a job names
+// the file it writes, the pipe only admits local clients running as the
+// daemon's user.
+
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "FrameBroadcast.h"
+#include "SettingsShadow.h"
+
+extern "C" {
+	#include "atmcd32d.h"
+}
+
+class ThermalTelemetry;
+
+#define DM_PIPE_NAME		"\\\\.\\pipe\\AndorDaemon"
+#define DM_MAGIC			0x4e4d4441		// "ADMN"
+#define DM_VERSION			1
+
+enum DmMessageType {
+	DM_PING				= 0,
+	DM_RUN_JOB			= 1,
+	DM_GET_STATUS		= 2,
+	DM_SHUTDOWN			= 3
+};
+
+enum DmSink {
+	DM_SINK_FILE		= 1,			// raw frames appended to job.path
+	DM_SINK_BROADCAST	= 2				// FrameBroadcast named job.broadcast
+};
+
+struct DmJob {
+	float					exposure;		// seconds
+	float					kineticCycle;	// seconds, 0 for the shortest
+	int32_t					hbin;			// image area, as for SetImage
+	int32_t					vbin;
+	int32_t					hstart;
+	int32_t					hend;
+	int32_t					vstart;
+	int32_t					vend;
+	int32_t					triggerMode;
+	uint32_t				frames;
+	int32_t					timeoutMs;		// longest wait for any one frame
+	uint32_t				sinks;			// DmSink flags
+	char					path[260];
+	char					broadcast[64];
+};
+
+struct DmRequest {
+	uint32_t				magic;
+	uint16_t				version;
+	uint16_t				type;			// DmMessageType
+	DmJob					job;			// DM_RUN_JOB only
+};
+
+struct DmReply {
+	uint32_t				magic;
+	uint16_t				version;
+	uint16_t				type;			// echoes the request
+	uint32_t				result;			// SDK error code
+	uint32_t				frames;			// frames delivered by the job
+	float					setupMs;		// programming the settings
+	float					acquireMs;		// StartAcquisition to the last frame
+	float					temperature;	// most recent telemetry
+	uint32_t				temperatureStatus;
+	uint32_t				jobsRun;
+};
+
+struct AcquisitionDaemon {
+	std::string				pipeName;
+	ThermalTelemetry		*telemetry;		// may be NULL
+	FrameBroadcast			broadcast;
+	std::string				broadcastName;
+	size_t					broadcastBytes;
+	std::vector<WORD>		buffer;
+	SettingsShadow			shadow;			// what the previous job left programmed
+	uint32_t				jobsRun;
+	bool					stop;
+};
+
+// Server side. The camera must already be initialised.
+void DmInitialise(AcquisitionDaemon *daemon, const char *pipeName, ThermalTelemetry *telemetry);
+// Serves one client at a time until a DM_SHUTDOWN request
+unsigned int DmServe(AcquisitionDaemon *daemon);
+// Runs a job in process; also used by DmServe
+unsigned int DmRunJob(AcquisitionDaemon *daemon, const DmJob *job, DmReply *reply);
+void DmClose(AcquisitionDaemon *daemon);
+
+// Client side: sends one request and waits for the reply
+void DmDefaultJob(DmJob *job, int xPixels, int yPixels);
+unsigned int DmCall(const char *pipeName, DmMessageType type, const DmJob *job, DmReply *reply);
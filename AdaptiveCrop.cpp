@@ -0,0 +1,282 @@
+// AdaptiveCrop.cpp : Adaptive isolated crop mode acquisition around a moving target.
+//
+
+#include "stdafx.h"
+#include "AdaptiveCrop.h"
+
+#include <stdio.h>
+#include <algorithm>
+
+static double AcNow(const AdaptiveCrop *ac)
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - ac->start).count();
+}
+
+// Span of at least minimum pixels around [lo, hi], a multiple of bin, inside
+// the detector. Returns the 1-based start.
+static int AcSpan(int lo, int hi, int minimum, int bin, int size, int *pLength)
+{
+	int length = std::max(hi - lo + 1, minimum);
+	length = (length + bin - 1) / bin * bin;
+	length = std::min(length, size - size % bin);
+	int start = (lo + hi + 1) / 2 - length / 2;
+	start = std::min(std::max(start, 0), size - length);
+	*pLength = length;
+	return start + 1;
+}
+
+// Brightest spot accepted by the predicate, spots being sorted brightest first
+static const Spot *AcPickTarget(const AdaptiveCrop *ac)
+{
+	for (const Spot &spot : ac->spots)
+		if (ac->params.predicate == NULL || ac->params.predicate(&spot, ac->params.context))
+			return &spot;
+	return NULL;
+}
+
+static unsigned int AcConfigure(AdaptiveCrop *ac, bool cropped, int left, int bottom, int width, int height)
+{
+	AcSwitch entry = {};
+	entry.time = AcNow(ac);
+	entry.cropped = cropped;
+	entry.left = left;
+	entry.bottom = bottom;
+	entry.width = width;
+	entry.height = height;
+	entry.latency = -1.0;
+
+	AbortAcquisition();		// DRV_IDLE the first time round
+	unsigned int error;
+	int hbin = cropped ? ac->params.hbin : 1;
+	int vbin = cropped ? ac->params.vbin : 1;
+	if (cropped)
+		error = SetIsolatedCropModeEx(1, height, width, vbin, hbin, left, bottom);
+	else
+		error = SetIsolatedCropMode(0, ac->detectorHeight, ac->detectorWidth, 1, 1);
+	if (error != DRV_SUCCESS)
+		return error;
+	// With isolated crop active the image is addressed relative to the crop
+	error = SetImage(hbin, vbin, 1, width, 1, height);
+	if (error != DRV_SUCCESS)
+		return error;
+
+	SpotParams spotParams = ac->params.spot;
+	error = SdInitialise(&ac->detector, width / hbin, height / vbin, &spotParams);
+	if (error != DRV_SUCCESS)
+		return error;
+	ac->buffer.resize((size_t)(width / hbin) * (height / vbin));
+
+	error = StartAcquisition();
+	if (error != DRV_SUCCESS)
+		return error;
+
+	ac->cropped = cropped;
+	ac->left = left;
+	ac->bottom = bottom;
+	ac->width = width;
+	ac->height = height;
+	ac->croppedFrames = 0;
+	ac->missed = 0;
+	ac->firstFrameTime = -1.0;
+	ac->log.push_back(entry);
+	return DRV_SUCCESS;
+}
+
+static unsigned int AcSurvey(AdaptiveCrop *ac)
+{
+	return AcConfigure(ac, false, 1, 1, ac->detectorWidth, ac->detectorHeight);
+}
+
+static unsigned int AcCropAround(AdaptiveCrop *ac, const Spot &target)
+{
+	const AcParams &params = ac->params;
+	int width, height;
+	int left = AcSpan(target.left - params.margin, target.right + params.margin,
+		params.minWidth, params.hbin, ac->detectorWidth, &width);
+	int bottom = AcSpan(target.bottom - params.margin, target.top + params.margin,
+		params.minHeight, params.vbin, ac->detectorHeight, &height);
+	return AcConfigure(ac, true, left, bottom, width, height);
+}
+
+// Moves a spot found in a cropped, binned frame to full-frame detector pixels
+static void AcToDetector(const AdaptiveCrop *ac, Spot *spot)
+{
+	int hbin = ac->params.hbin, vbin = ac->params.vbin;
+	int x0 = ac->left - 1, y0 = ac->bottom - 1;
+	spot->x = x0 + spot->x * hbin + (hbin - 1) * 0.5f;
+	spot->y = y0 + spot->y * vbin + (vbin - 1) * 0.5f;
+	spot->mxx *= (float)(hbin * hbin);
+	spot->myy *= (float)(vbin * vbin);
+	spot->mxy *= (float)(hbin * vbin);
+	spot->left = (short)(x0 + spot->left * hbin);
+	spot->right = (short)(x0 + spot->right * hbin + hbin - 1);
+	spot->bottom = (short)(y0 + spot->bottom * vbin);
+	spot->top = (short)(y0 + spot->top * vbin + vbin - 1);
+}
+
+//------------------------------------------------------------------------------
+// Public interface
+//------------------------------------------------------------------------------
+
+void AcDefaultParams(AcParams *params)
+{
+	SdDefaultParams(&params->spot);
+	params->predicate = NULL;
+	params->context = NULL;
+	params->margin = 16;
+	params->minWidth = 32;
+	params->minHeight = 32;
+	params->hbin = 1;
+	params->vbin = 1;
+	params->edgeMargin = 4;
+	params->lostFrames = 3;
+	params->surveyInterval = 0;
+}
+
+unsigned int AcInitialise(AdaptiveCrop *ac, int detectorWidth, int detectorHeight, const AcParams *params)
+{
+	if (ac == NULL)
+		return DRV_P1INVALID;
+	if (detectorWidth <= 0 || detectorWidth > 32767)
+		return DRV_P2INVALID;
+	if (detectorHeight <= 0 || detectorHeight > 32767)
+		return DRV_P3INVALID;
+	if (params == NULL || params->margin < 0 || params->edgeMargin < 0 || params->lostFrames <= 0
+		|| params->surveyInterval < 0
+		|| params->hbin <= 0 || params->hbin > detectorWidth
+		|| params->vbin <= 0 || params->vbin > detectorHeight
+		|| params->minWidth < params->hbin || params->minHeight < params->vbin)
+		return DRV_P4INVALID;
+
+	ac->detectorWidth = detectorWidth;
+	ac->detectorHeight = detectorHeight;
+	ac->params = *params;
+	ac->running = false;
+	ac->cropped = false;
+	ac->log.clear();
+	ac->buffer.reserve((size_t)detectorWidth * detectorHeight);
+	return DRV_SUCCESS;
+}
+
+unsigned int AcStart(AdaptiveCrop *ac)
+{
+	if (ac == NULL || ac->detectorWidth <= 0)
+		return DRV_P1INVALID;
+
+	// Isolated crop mode needs run till abort and frame transfer
+	unsigned int error = SetAcquisitionMode(5);
+	if (error != DRV_SUCCESS)
+		return error;
+	error = SetFrameTransferMode(1);
+	if (error != DRV_SUCCESS)
+		return error;
+
+	ac->start = std::chrono::steady_clock::now();
+	ac->log.clear();
+	error = AcSurvey(ac);
+	ac->running = error == DRV_SUCCESS;
+	return error;
+}
+
+unsigned int AcNextFrame(AdaptiveCrop *ac, int timeoutMs, AcFrame *frame)
+{
+	if (ac == NULL || !ac->running)
+		return DRV_P1INVALID;
+	if (frame == NULL)
+		return DRV_P3INVALID;
+
+	unsigned int error = WaitForAcquisitionTimeOut(timeoutMs);
+	if (error != DRV_SUCCESS)
+		return error;
+	error = GetMostRecentImage16(ac->buffer.data(), (unsigned long)ac->buffer.size());
+	if (error != DRV_SUCCESS)
+		return error;
+
+	double now = AcNow(ac);
+	AcSwitch &entry = ac->log.back();
+	if (ac->firstFrameTime < 0.0) {
+		ac->firstFrameTime = now;
+		entry.latency = now - entry.time;
+	}
+	ac->lastFrameTime = now;
+	entry.frames++;
+	if (entry.frames > 1)
+		entry.frameRate = (entry.frames - 1) / (ac->lastFrameTime - ac->firstFrameTime);
+
+	frame->data = ac->buffer.data();
+	frame->cropped = ac->cropped;
+	frame->hbin = ac->cropped ? ac->params.hbin : 1;
+	frame->vbin = ac->cropped ? ac->params.vbin : 1;
+	frame->width = ac->width / frame->hbin;
+	frame->height = ac->height / frame->vbin;
+	frame->left = ac->left;
+	frame->bottom = ac->bottom;
+	frame->timestamp = now;
+
+	error = SdDetect(&ac->detector, ac->buffer.data(), &ac->spots);
+	if (error != DRV_SUCCESS)
+		return error;
+	if (ac->cropped)
+		for (Spot &spot : ac->spots)
+			AcToDetector(ac, &spot);
+	const Spot *target = AcPickTarget(ac);
+	frame->found = target != NULL;
+	if (target)
+		frame->target = *target;
+
+	// Decide on the next configuration. The frame handed back stays valid:
+	// the buffer has full-frame capacity, so resizing it never reallocates.
+	if (!ac->cropped) {
+		if (target)
+			error = AcCropAround(ac, *target);
+	}
+	else if (target == NULL) {
+		if (++ac->missed >= ac->params.lostFrames)
+			error = AcSurvey(ac);
+	}
+	else {
+		ac->missed = 0;
+		int edge = ac->params.edgeMargin;
+		int x0 = ac->left - 1, y0 = ac->bottom - 1;
+		bool nearEdge = target->x < x0 + edge || target->x > x0 + ac->width - 1 - edge
+			|| target->y < y0 + edge || target->y > y0 + ac->height - 1 - edge;
+		if (ac->params.surveyInterval > 0 && ++ac->croppedFrames >= ac->params.surveyInterval)
+			error = AcSurvey(ac);
+		else if (nearEdge)
+			error = AcCropAround(ac, *target);
+	}
+	if (error != DRV_SUCCESS) {
+		AbortAcquisition();
+		ac->running = false;
+	}
+	return error;
+}
+
+unsigned int AcStop(AdaptiveCrop *ac)
+{
+	if (ac == NULL)
+		return DRV_P1INVALID;
+	if (!ac->running)
+		return DRV_SUCCESS;
+	ac->running = false;
+	AbortAcquisition();
+	return SetIsolatedCropMode(0, ac->detectorHeight, ac->detectorWidth, 1, 1);
+}
+
+unsigned int AcWriteLog(const AdaptiveCrop *ac, const char *filename)
+{
+	if (ac == NULL)
+		return DRV_P1INVALID;
+	if (filename == NULL)
+		return DRV_P2INVALID;
+
+	FILE *file = fopen(filename, "w");
+	if (file == NULL)
+		return DRV_ERROR_FILESAVE;
+	fprintf(file, "time,cropped,left,bottom,width,height,latency_ms,frames,frame_rate\n");
+	for (const AcSwitch &entry : ac->log)
+		fprintf(file, "%.6f,%d,%d,%d,%d,%d,%.3f,%d,%.1f\n", entry.time, entry.cropped ? 1 : 0,
+			entry.left, entry.bottom, entry.width, entry.height,
+			entry.latency * 1000.0, entry.frames, entry.frameRate);
+	return fclose(file) == 0 ? DRV_SUCCESS : DRV_ERROR_FILESAVE;
+}
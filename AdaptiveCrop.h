@@ -0,0 +1,114 @@
+// AdaptiveCrop.h : Adaptive isolated crop mode acquisition around a moving target.
+//
+// SetIsolatedCropModeEx(active, cropheight, cropwidth, vbin, hbin, cropleft,
+// cropbottom) raises the frame rate by orders of magnitude, but only while the
+// target stays inside the crop. This controller runs the camera in run till
+// abort, takes a full-frame survey, picks the target with the spot detector
+// (the brightest spot, or the brightest one accepted by a caller predicate),
+// and restarts the acquisition cropped around it. A target whose centroid
+// comes within edgeMargin pixels of the crop boundary is followed by cropping
+// again around its new position; a target lost for lostFrames frames, or
+// surveyInterval cropped frames in a row, send the camera back to a survey.
+//
+// Every switch is logged with the time from the decision to the first frame
+// in the new configuration, and the frame rate achieved until the next switch.
+
+#pragma once
+
+#include <stdint.h>
+#include <chrono>
+#include <vector>
+
+#include "SpotDetector.h"
+
+extern "C" {
+	#include "atmcd32d.h"
+}
+
+// Return true to accept spot as the target. Coordinates are in detector
+// pixels of the full frame.
+typedef bool (*AcPredicate)(const Spot *spot, void *context);
+
+struct AcParams {
+	SpotParams				spot;			// detection in both survey and cropped frames
+	AcPredicate				predicate;		// NULL to take the brightest spot
+	void					*context;
+	int						margin;			// pixels added around the target's bounding box
+	int						minWidth;		// smallest crop, before binning
+	int						minHeight;
+	int						hbin;			// binning while cropped
+	int						vbin;
+	int						edgeMargin;		// re-crop when the centroid is this close to an edge
+	int						lostFrames;		// re-survey after this many frames without the target
+	int						surveyInterval;	// re-survey after this many cropped frames, 0 for never
+};
+
+struct AcSwitch {
+	double					time;			// seconds since AcStart when the switch was decided
+	bool					cropped;		// configuration switched to
+	int						left;			// crop, 1-based detector pixels, as passed to the SDK
+	int						bottom;
+	int						width;
+	int						height;
+	double					latency;		// seconds from the decision to the first new frame
+	int						frames;			// frames acquired in this configuration
+	double					frameRate;		// achieved, frames per second
+};
+
+// One acquired frame. Coordinates of target are in full-frame detector pixels.
+struct AcFrame {
+	const WORD				*data;
+	int						width;			// pixels in data, after binning
+	int						height;
+	bool					cropped;
+	int						left;			// 1-based position and binning of data on the detector
+	int						bottom;
+	int						hbin;
+	int						vbin;
+	double					timestamp;		// seconds since AcStart
+	bool					found;			// target is valid for this frame
+	Spot					target;
+};
+
+struct AdaptiveCrop {
+	int						detectorWidth;
+	int						detectorHeight;
+	AcParams				params;
+
+	bool					running;
+	bool					cropped;
+	int						left;			// current crop, 1-based, unbinned
+	int						bottom;
+	int						width;
+	int						height;
+	int						croppedFrames;	// frames since the crop was entered
+	int						missed;			// consecutive cropped frames without the target
+
+	SpotDetector			detector;
+	std::vector<Spot>		spots;
+	std::vector<WORD>		buffer;
+	std::chrono::steady_clock::time_point	start;
+	double					firstFrameTime;	// of the current configuration, < 0 until it arrives
+	double					lastFrameTime;
+
+	std::vector<AcSwitch>	log;
+};
+
+void AcDefaultParams(AcParams *params);
+
+unsigned int AcInitialise(AdaptiveCrop *ac, int detectorWidth, int detectorHeight, const AcParams *params);
+
+// Puts the camera in run till abort with frame transfer and starts a survey.
+// The read mode, exposure and speeds set beforehand are left as they are.
+unsigned int AcStart(AdaptiveCrop *ac);
+
+// Waits up to timeoutMs for the next frame, evaluates it and reconfigures the
+// camera when the target calls for it. frame->data stays valid until the next
+// call.
+unsigned int AcNextFrame(AdaptiveCrop *ac, int timeoutMs, AcFrame *frame);
+
+// Aborts the acquisition, leaves isolated crop mode and closes the log
+unsigned int AcStop(AdaptiveCrop *ac);
+
+// Writes the switch log as CSV
+unsigned int AcWriteLog(const AdaptiveCrop *ac, const char *filename);
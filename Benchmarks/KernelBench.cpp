@@ -0,0 +1,337 @@
+// KernelBench.cpp : Every frame kernel across detector sizes, pixel types and thread counts.
+//
+// Stand-alone console program, build it together with FrameHistogram.cpp,
+// HostAccumulator.cpp, PixelStatistics.cpp, SimdSupport.cpp, SpotDetector.cpp,
+// SyntheticFrames.cpp, TemporalFilter.cpp and WorkerPool.cpp, linked with the
+// SDK import library (SyntheticFrames.cpp references SfQueryCamera; no camera
+// is opened). Input frames come from the synthetic frame generator, so
+// thresholds, histograms and filters see realistic data.
+//
+// Output is CSV on stdout, one line per kernel, pixel type, frame size and
+// thread count, for diffing between builds. Every configuration is compared
+// with a single-threaded or scalar reference before it is timed, and a wrong
+// result shows up as MISMATCH in the status column rather than as a speedup.
+//
+// Usage: KernelBench [maxThreads]    (default one per hardware thread)
+
+#include "../FrameHistogram.h"
+#include "../HostAccumulator.h"
+#include "../PixelKernels.h"
+#include "../PixelStatistics.h"
+#include "../SimdSupport.h"
+#include "../SpotDetector.h"
+#include "../SyntheticFrames.h"
+#include "../TemporalFilter.h"
+#include "../WorkerPool.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+static const struct {
+	int width;
+	int height;
+} kSizes[] = {
+	{ 512, 512 },
+	{ 1024, 1024 },
+	{ 2048, 2048 },
+	{ 1000, 250 },		// crops take the runtime-width kernels
+	{ 128, 128 },
+};
+
+static const int kBankFrames = 4;				// frames cycled through while timing
+static const size_t kPixelsPerSample = 1 << 22;	// small frames repeat up to this per timing run
+
+template <typename F>
+static double BestMilliseconds(F f, int repeats)
+{
+	double best = 1e30;
+	for (int run = 0; run < 7; run++) {
+		auto start = std::chrono::steady_clock::now();
+		for (int r = 0; r < repeats; r++)
+			f(r);
+		std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+		if (elapsed.count() < best)
+			best = elapsed.count();
+	}
+	return best / repeats;
+}
+
+// Calls f(begin, end, thread) for bandsPerThread bands of rows per thread
+template <typename F>
+static void ForRowBands(WorkerPool &pool, int rows, int bandsPerThread, F f)
+{
+	int bands = std::min(rows, pool.GetThreadCount() * bandsPerThread);
+	pool.Run(bands, [&](int band, int thread) {
+		f(rows * band / bands, rows * (band + 1) / bands, thread);
+	});
+}
+
+struct Context {
+	int				width;
+	int				height;
+	int				threads;
+	int				repeats;
+	WorkerPool		*pool;
+};
+
+static void Report(const char *kernel, const char *type, const Context &c, size_t bytesPerFrame, double ms, bool ok)
+{
+	printf("%s,%s,%d,%d,%d,%s,%.4f,%.1f,%.3f,%s\n", kernel, type, c.width, c.height, c.threads,
+		GetSimdLevelName(GetSimdLevel()), ms, 1000.0 / ms, bytesPerFrame / ms * 1e-6, ok ? "ok" : "MISMATCH");
+	fflush(stdout);
+}
+
+//------------------------------------------------------------------------------
+// PixelKernels, for both pixel types
+//------------------------------------------------------------------------------
+
+template <typename T>
+static void RunPixelKernels(const Context &c, const char *type, const std::vector<std::vector<T> > &bank)
+{
+	const int w = c.width, h = c.height;
+	const size_t pixels = (size_t)w * h, bytes = pixels * sizeof(T);
+	WorkerPool &pool = *c.pool;
+	const std::vector<T> &dark = bank[kBankFrames - 1];
+	std::vector<T> out(pixels), ref(pixels);
+	std::vector<std::vector<T> > scratch(pool.GetThreadCount(), std::vector<T>(w));
+
+	// min/max: bands reduce separately and are combined
+	{
+		PkKernels<T> k = PkSelect<T>(w, 1, 1);
+		std::vector<T> lows(pool.GetThreadCount() * 4), highs(lows.size());
+		T lo = 0, hi = 0;
+		auto run = [&](int r) {
+			const T *frame = bank[r % kBankFrames].data();
+			int bands = std::min(h, pool.GetThreadCount() * 4);
+			pool.Run(bands, [&](int band, int) {
+				int y0 = h * band / bands, y1 = h * (band + 1) / bands;
+				k.minMax(frame + (size_t)y0 * w, w, y1 - y0, &lows[band], &highs[band]);
+			});
+			lo = *std::min_element(lows.begin(), lows.begin() + bands);
+			hi = *std::max_element(highs.begin(), highs.begin() + bands);
+		};
+		run(0);
+		auto expected = std::minmax_element(bank[0].begin(), bank[0].end());
+		bool ok = lo == *expected.first && hi == *expected.second;
+		Report("minmax", type, c, bytes, BestMilliseconds(run, c.repeats), ok);
+	}
+
+	// Dark subtraction
+	{
+		PkKernels<T> k = PkSelect<T>(w, 1, 1);
+		auto run = [&](int r) {
+			const T *frame = bank[r % kBankFrames].data();
+			ForRowBands(pool, h, 4, [&](int y0, int y1, int) {
+				size_t row = (size_t)y0 * w;
+				k.subtract(frame + row, dark.data() + row, out.data() + row, w, y1 - y0);
+			});
+		};
+		run(0);
+		for (size_t i = 0; i < pixels; i++)
+			ref[i] = bank[0][i] > dark[i] ? (T)(bank[0][i] - dark[i]) : (T)0;
+		Report("dark-subtract", type, c, bytes, BestMilliseconds(run, c.repeats), out == ref);
+	}
+
+	// Square binning, output rows spread over the pool
+	for (int b : { 2, 4 }) {
+		PkKernels<T> k = PkSelect<T>(w, b, b);
+		PkKernels<T> scalar = PkSelectLevel<T, 0, 0>(SIMD_NONE);
+		int outWidth = w / b, outHeight = h / b;
+		auto run = [&](int r) {
+			const T *frame = bank[r % kBankFrames].data();
+			ForRowBands(pool, outHeight, 4, [&](int y0, int y1, int thread) {
+				k.bin(frame + (size_t)y0 * b * w, w, (y1 - y0) * b, b, b, out.data() + (size_t)y0 * outWidth,
+					scratch[thread].data());
+			});
+		};
+		run(0);
+		scalar.bin(bank[0].data(), w, h, b, b, ref.data(), scratch[0].data());
+		bool ok = memcmp(out.data(), ref.data(), (size_t)outWidth * outHeight * sizeof(T)) == 0;
+		Report(b == 2 ? "bin2x2" : "bin4x4", type, c, bytes, BestMilliseconds(run, c.repeats), ok);
+	}
+
+	// Full vertical binning: bands sum to one row each, then the rows are
+	// summed. Saturating addition is associative, so the split changes nothing.
+	{
+		PkKernels<T> k = PkSelect<T>(w, 1, 0);
+		PkKernels<T> scalar = PkSelectLevel<T, 0, 0>(SIMD_NONE);
+		int bands = std::min(h, pool.GetThreadCount() * 4);
+		std::vector<T> partial((size_t)bands * w);
+		auto run = [&](int r) {
+			const T *frame = bank[r % kBankFrames].data();
+			pool.Run(bands, [&](int band, int thread) {
+				int y0 = h * band / bands, y1 = h * (band + 1) / bands;
+				k.bin(frame + (size_t)y0 * w, w, y1 - y0, 1, y1 - y0, &partial[(size_t)band * w], scratch[thread].data());
+			});
+			for (int x = 0; x < w; x++) {
+				T sum = partial[x];
+				for (int band = 1; band < bands; band++)
+					sum = PkScalarOps<T>::AddSat(sum, partial[(size_t)band * w + x]);
+				out[x] = sum;
+			}
+		};
+		run(0);
+		scalar.bin(bank[0].data(), w, h, 1, h, ref.data(), scratch[0].data());
+		Report("fvb", type, c, bytes, BestMilliseconds(run, c.repeats), memcmp(out.data(), ref.data(), w * sizeof(T)) == 0);
+	}
+}
+
+//------------------------------------------------------------------------------
+// 16-bit pipeline stages
+//------------------------------------------------------------------------------
+
+static void RunStages16(const Context &c, const std::vector<std::vector<WORD> > &bank, const std::vector<std::vector<WORD> > &photons)
+{
+	const int w = c.width, h = c.height;
+	const size_t pixels = (size_t)w * h, bytes = pixels * sizeof(WORD);
+	WorkerPool &pool = *c.pool;
+
+	// Histogram and the display render driven by its clip points
+	{
+		FrameHistogram hist, single;
+		FhInitialise(&hist, 0);
+		FhInitialise(&single, 0);
+		auto run = [&](int r) { FhCompute(&hist, bank[r % kBankFrames].data(), pixels, &pool); };
+		run(0);
+		FhCompute(&single, bank[0].data(), pixels, NULL);
+		bool ok = hist.bins == single.bins && hist.total == pixels;
+		Report("histogram", "uint16", c, bytes, BestMilliseconds(run, c.repeats), ok);
+
+		ClipPoints clip;
+		FhGetClipPoints(&single, 0.005, 0.995, 65535, &clip);
+		std::vector<BYTE> display(pixels), ref(pixels);
+		auto render = [&](int r) {
+			const WORD *frame = bank[r % kBankFrames].data();
+			// One band per thread, as every call builds its own lookup table
+			ForRowBands(pool, h, 1, [&](int y0, int y1, int) {
+				size_t row = (size_t)y0 * w;
+				FhRenderToBytes(frame + row, (size_t)(y1 - y0) * w, &clip, display.data() + row);
+			});
+		};
+		render(0);
+		FhRenderToBytes(bank[0].data(), pixels, &clip, ref.data());
+		Report("render", "uint16", c, bytes, BestMilliseconds(render, c.repeats), display == ref);
+	}
+
+	// Temporal median over five frames
+	{
+		TemporalFilter tf, single;
+		std::vector<WORD> out(pixels), ref(pixels);
+		TfInitialise(&tf, w, h, 5, TEMPORAL_MEDIAN, 3.0f, &pool);
+		TfInitialise(&single, w, h, 5, TEMPORAL_MEDIAN, 3.0f, NULL);
+		for (int k = 0; k < 5; k++) {
+			TfAddFrame(&tf, bank[k % kBankFrames].data(), out.data());
+			TfAddFrame(&single, bank[k % kBankFrames].data(), ref.data());
+		}
+		bool ok = out == ref;
+		auto run = [&](int r) { TfAddFrame(&tf, bank[r % kBankFrames].data(), out.data()); };
+		Report("temporal-median5", "uint16", c, bytes, BestMilliseconds(run, c.repeats), ok);
+	}
+
+	// Running mean and variance
+	{
+		PixelStatistics ps, single;
+		PsInitialise(&ps, w, h, &pool);
+		PsInitialise(&single, w, h, NULL);
+		for (int k = 0; k < kBankFrames; k++) {
+			PsAddFrame(&ps, bank[k].data());
+			PsAddFrame(&single, bank[k].data());
+		}
+		bool ok = ps.mean == single.mean && ps.m2 == single.m2;
+		auto run = [&](int r) { PsAddFrame(&ps, bank[r % kBankFrames].data()); };
+		Report("pixel-stats", "uint16", c, bytes, BestMilliseconds(run, c.repeats), ok);
+	}
+
+	// The remaining stages run on the calling thread only
+	if (c.threads != 1)
+		return;
+
+	// Host-side accumulation into 32 bits
+	{
+		HostAccumulator acc;
+		HaInitialise(&acc, w, h, 0, 0.0);
+		HaAddFrame(&acc, bank[0].data(), 0.0, NULL);
+		std::vector<uint64_t> sum(pixels);
+		HaGetPartialSum(&acc, sum.data(), NULL);
+		bool ok = std::equal(sum.begin(), sum.end(), bank[0].begin());
+		auto run = [&](int r) { HaAddFrame(&acc, bank[r % kBankFrames].data(), 0.0, NULL); };
+		Report("accumulate", "uint16", c, bytes, BestMilliseconds(run, c.repeats), ok);
+	}
+
+	// Photon counting on EM frames: every pixel over threshold is an event
+	{
+		SpotParams params;
+		SdDefaultParams(&params);
+		params.thresholdMin = 250;		// bias 100, read noise 5 counts: 30 sigma
+		params.minPixels = 1;
+		SpotDetector sd;
+		SdInitialise(&sd, w, h, &params);
+		std::vector<Spot> spots;
+		SdDetect(&sd, photons[0].data(), &spots);
+		size_t counted = 0, expected = 0;
+		for (const Spot &spot : spots)
+			counted += spot.pixels;
+		for (WORD value : photons[0])
+			expected += value > params.thresholdMin;
+		auto run = [&](int r) { SdDetect(&sd, photons[r % kBankFrames].data(), &spots); };
+		Report("photon-count", "uint16", c, bytes, BestMilliseconds(run, c.repeats), counted == expected);
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	int maxThreads = argc > 1 ? atoi(argv[1]) : (int)std::thread::hardware_concurrency();
+	if (maxThreads < 1)
+		maxThreads = 1;
+	std::vector<int> threadCounts;
+	for (int t = 1; t < maxThreads; t *= 2)
+		threadCounts.push_back(t);
+	threadCounts.push_back(maxThreads);
+
+	printf("# SIMD level: %s, up to %d threads\n", GetSimdLevelName(GetSimdLevel()), maxThreads);
+	printf("kernel,type,width,height,threads,simd,ms_per_frame,frames_per_s,gb_per_s,status\n");
+
+	WorkerPool generatorPool(maxThreads);
+	for (const auto &size : kSizes) {
+		SfParameters params;
+		SfDefaultParameters(&params, size.width, size.height);
+		SyntheticFrames sf;
+		SfInitialise(&sf, &params, &generatorPool);
+
+		// Low-light EM frames for photon counting
+		SfParameters emParams = params;
+		emParams.emGain = 300.0f;
+		emParams.sensitivity = 10.0f;
+		emParams.readNoise = 50.0f;
+		emParams.background = 0.1f;
+		emParams.sources = 0;
+		SyntheticFrames em;
+		SfInitialise(&em, &emParams, &generatorPool);
+
+		size_t pixels = (size_t)size.width * size.height;
+		std::vector<std::vector<WORD> > bank16(kBankFrames, std::vector<WORD>(pixels));
+		std::vector<std::vector<WORD> > photons(kBankFrames, std::vector<WORD>(pixels));
+		std::vector<std::vector<uint32_t> > bank32(kBankFrames, std::vector<uint32_t>(pixels));
+		std::vector<at_32> frame32(pixels);
+		for (int k = 0; k < kBankFrames; k++) {
+			SfGenerate16(&sf, k, bank16[k].data());
+			SfGenerate16(&em, k, photons[k].data());
+			SfGenerate32(&sf, k, frame32.data());
+			std::copy(frame32.begin(), frame32.end(), bank32[k].begin());
+		}
+
+		for (int threads : threadCounts) {
+			WorkerPool pool(threads);
+			Context c = { size.width, size.height, threads, (int)std::max<size_t>(1, kPixelsPerSample / pixels), &pool };
+			RunPixelKernels<uint16_t>(c, "uint16", bank16);
+			RunPixelKernels<uint32_t>(c, "uint32", bank32);
+			RunStages16(c, bank16, photons);
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,85 @@
+// CameraManager.cpp : Thread-safe access to several cameras from one process.
+//
+
+#include "stdafx.h"
+#include "CameraManager.h"
+#if defined(SDK_RECORD) || defined(SDK_REPLAY)
+#include "StreamReplay.h"
+#endif
+
+#include <chrono>
+
+typedef std::chrono::steady_clock CmClock;
+
+CameraManager::CameraManager()
+	: mCurrent(-1), mCalls(0), mHeldTicks(0), mWaitedTicks(0)
+{
+}
+
+unsigned int CameraManager::Open()
+{
+	std::lock_guard<std::mutex> guard(mSdkLock);
+	mHandles.clear();
+	mCurrent = -1;
+	mCalls = 0;
+	mHeldTicks = 0;
+	mWaitedTicks = 0;
+
+	long count = 0;
+	unsigned int error = GetAvailableCameras(&count);
+	if (error != DRV_SUCCESS)
+		return error;
+	for (long i = 0; i < count; i++) {
+		long handle;
+		error = GetCameraHandle(i, &handle);
+		if (error != DRV_SUCCESS) {
+			mHandles.clear();
+			return error;
+		}
+		mHandles.push_back(handle);
+	}
+	// Whatever was current before, the next Call() selects its own camera
+	return DRV_SUCCESS;
+}
+
+unsigned int CameraManager::Call(int camera, const std::function<unsigned int()> &fn)
+{
+	if (camera < 0 || camera >= (int)mHandles.size())
+		return DRV_P1INVALID;
+
+	CmClock::time_point queued = CmClock::now();
+	std::lock_guard<std::mutex> guard(mSdkLock);
+	CmClock::time_point start = CmClock::now();
+
+	unsigned int error = DRV_SUCCESS;
+	long handle = mHandles[camera];
+	if (handle != mCurrent) {
+		error = SetCurrentCamera(handle);
+		mCurrent = error == DRV_SUCCESS ? handle : -1;
+	}
+	if (error == DRV_SUCCESS)
+		error = fn();
+
+	mCalls++;
+	mWaitedTicks += (start - queued).count();
+	mHeldTicks += (CmClock::now() - start).count();
+	return error;
+}
+
+unsigned int CameraManager::Wait(int camera, int timeoutMs)
+{
+	if (camera < 0 || camera >= (int)mHandles.size())
+		return DRV_P1INVALID;
+	return WaitForAcquisitionByHandleTimeOut(mHandles[camera], timeoutMs);
+}
+
+void CameraManager::GetLockStats(long long *pCalls, double *pHeld, double *pWaited) const
+{
+	double tick = (double)CmClock::period::num / CmClock::period::den;
+	if (pCalls)
+		*pCalls = mCalls;
+	if (pHeld)
+		*pHeld = mHeldTicks * tick;
+	if (pWaited)
+		*pWaited = mWaitedTicks * tick;
+}
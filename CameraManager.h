@@ -0,0 +1,58 @@
+// CameraManager.h : Thread-safe access to several cameras from one process.
+//
+// The SDK addresses every call except the WaitForAcquisitionByHandle family to
+// a process-global current camera chosen with SetCurrentCamera, so two threads
+// driving two cameras would race. The manager owns one handle per camera and
+// a single lock around the SDK: Call() selects the camera and runs a short
+// burst of SDK calls under the lock, skipping SetCurrentCamera when the camera
+// is already current. Wait() blocks in WaitForAcquisitionByHandleTimeOut
+// without the lock, so every camera waits at once and a per-camera thread
+// only holds the lock for the brief fetch after each frame:
+//
+//     while (manager.Wait(camera, 1000) == DRV_SUCCESS)
+//         manager.Call(camera, [&] { return GetMostRecentImage16(buffer, size); });
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+extern "C" {
+	#include "atmcd32d.h"
+}
+
+class CameraManager {
+public:
+	CameraManager();
+
+	CameraManager(const CameraManager &) = delete;
+	CameraManager &operator=(const CameraManager &) = delete;
+
+	// Finds the cameras with GetAvailableCameras and takes a handle for each.
+	// May be called before Initialize(); cameras are numbered from 0.
+	unsigned int Open();
+
+	int GetCameraCount() const { return (int)mHandles.size(); }
+	long GetHandle(int camera) const { return mHandles[camera]; }
+
+	// Makes camera current and returns fn(), all under the SDK lock. fn should
+	// not wait on the camera; use Wait() for that.
+	unsigned int Call(int camera, const std::function<unsigned int()> &fn);
+
+	// WaitForAcquisitionByHandleTimeOut on camera, without the SDK lock
+	unsigned int Wait(int camera, int timeoutMs);
+
+	// Lock statistics since Open(), for checking that no caller holds the
+	// lock for long. Times are in seconds.
+	void GetLockStats(long long *pCalls, double *pHeld, double *pWaited) const;
+
+private:
+	std::vector<long>		mHandles;
+	std::mutex				mSdkLock;
+	long					mCurrent;		// handle last passed to SetCurrentCamera, under mSdkLock
+	std::atomic<long long>	mCalls;
+	std::atomic<long long>	mHeldTicks;		// steady_clock ticks
+	std::atomic<long long>	mWaitedTicks;
+};
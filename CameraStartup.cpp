@@ -0,0 +1,187 @@
+// CameraStartup.cpp : Parallel start-up of every connected camera with a per-step timeline.
+//
+
+#include "stdafx.h"
+#include "CameraStartup.h"
+#if defined(SDK_RECORD) || defined(SDK_REPLAY)
+#include "StreamReplay.h"
+#endif
+
+#include <stdio.h>
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+//------------------------------------------------------------------------------
+// Default SDK sequences. Each assumes its camera is current.
+//------------------------------------------------------------------------------
+
+unsigned int CsIdentify(CameraInfo *info)
+{
+	unsigned int error = GetCameraSerialNumber(&info->serial);
+	if (error != DRV_SUCCESS)
+		return error;
+	error = GetHeadModel(info->headModel);
+	if (error != DRV_SUCCESS)
+		return error;
+	return GetDetector(&info->xPixels, &info->yPixels);
+}
+
+unsigned int CsQueryCapabilities(CameraInfo *info)
+{
+	// The temperature range is worth having even without the capabilities
+	info->caps.ulSize = sizeof(AndorCapabilities);
+	unsigned int error = GetCapabilities(&info->caps);
+	unsigned int rangeError = GetTemperatureRange(&info->minTemp, &info->maxTemp);
+	return error != DRV_SUCCESS ? error : rangeError;
+}
+
+unsigned int CsScanSpeeds(CameraInfo *info)
+{
+	// Fastest horizontal speed over every AD channel, as the single-camera
+	// start-up in Andor_test.cpp picks it
+	int channels;
+	unsigned int error = GetNumberADChannels(&channels);
+	if (error != DRV_SUCCESS)
+		return error;
+	info->adChannel = 0;
+	info->hsSpeedIndex = 0;
+	info->hsSpeed = 0.0f;
+	for (int channel = 0; channel < channels; channel++) {
+		int speeds;
+		error = GetNumberHSSpeeds(channel, 0, &speeds);
+		if (error != DRV_SUCCESS)
+			return error;
+		for (int index = 0; index < speeds; index++) {
+			float speed;
+			error = GetHSSpeed(channel, 0, index, &speed);
+			if (error != DRV_SUCCESS)
+				return error;
+			if (speed > info->hsSpeed) {
+				info->hsSpeed = speed;
+				info->hsSpeedIndex = index;
+				info->adChannel = channel;
+			}
+		}
+	}
+	return GetFastestRecommendedVSSpeed(&info->vsSpeedIndex, &info->vsSpeed);
+}
+
+unsigned int CsApplySpeeds(const CameraInfo *info)
+{
+	unsigned int error = SetADChannel(info->adChannel);
+	if (error != DRV_SUCCESS)
+		return error;
+	error = SetHSSpeed(0, info->hsSpeedIndex);
+	if (error != DRV_SUCCESS)
+		return error;
+	return SetVSSpeed(info->vsSpeedIndex);
+}
+
+void CsDefaultSteps(const char *driverDir, std::vector<StartupStep> *steps)
+{
+	std::string dir = driverDir ? driverDir : "";
+	steps->clear();
+	steps->push_back({ "Initialize", true, [dir](int, CameraInfo *) {
+		std::vector<char> path(dir.begin(), dir.end());
+		path.push_back('\0');
+		return Initialize(path.data());
+	} });
+	steps->push_back({ "Identify", true, [](int, CameraInfo *info) { return CsIdentify(info); } });
+	steps->push_back({ "Capabilities", true, [](int, CameraInfo *info) { return CsQueryCapabilities(info); } });
+	steps->push_back({ "SpeedTable", true, [](int, CameraInfo *info) { return CsScanSpeeds(info); } });
+	steps->push_back({ "ApplySpeeds", true, [](int, CameraInfo *info) { return CsApplySpeeds(info); } });
+	steps->push_back({ "CoolerOn", true, [](int, CameraInfo *) { return CoolerON(); } });
+}
+
+//------------------------------------------------------------------------------
+// Orchestration
+//------------------------------------------------------------------------------
+
+unsigned int CsRunStartup(CameraManager *manager, const std::vector<StartupStep> &steps,
+	std::vector<CameraInfo> *infos, std::vector<StartupEvent> *timeline)
+{
+	if (manager == NULL)
+		return DRV_P1INVALID;
+	if (infos == NULL)
+		return DRV_P3INVALID;
+	if (timeline == NULL)
+		return DRV_P4INVALID;
+
+	int cameras = manager->GetCameraCount();
+	infos->assign(cameras, CameraInfo());
+	timeline->clear();
+	if (cameras == 0)
+		return DRV_SUCCESS;
+
+	typedef std::chrono::steady_clock Clock;
+	Clock::time_point origin = Clock::now();
+	auto seconds = [&](Clock::time_point t) { return std::chrono::duration<double>(t - origin).count(); };
+
+	std::mutex timelineLock;
+	std::vector<unsigned int> results(cameras, DRV_SUCCESS);
+	auto cameraMain = [&](int camera) {
+		CameraInfo *info = &(*infos)[camera];
+		for (size_t s = 0; s < steps.size(); s++) {
+			const StartupStep &step = steps[s];
+			StartupEvent event;
+			event.camera = camera;
+			event.step = (int)s;
+			event.ready = seconds(Clock::now());
+			event.start = event.ready;
+			if (step.sdk) {
+				// The step's own start is taken inside the lock
+				event.result = manager->Call(camera, [&] {
+					event.start = seconds(Clock::now());
+					return step.run(camera, info);
+				});
+			}
+			else
+				event.result = step.run(camera, info);
+			event.end = seconds(Clock::now());
+			{
+				std::lock_guard<std::mutex> guard(timelineLock);
+				timeline->push_back(event);
+			}
+			if (event.result != DRV_SUCCESS) {
+				results[camera] = event.result;
+				return;
+			}
+		}
+	};
+
+	std::vector<std::thread> threads;
+	for (int camera = 1; camera < cameras; camera++)
+		threads.emplace_back(cameraMain, camera);
+	cameraMain(0);
+	for (auto &thread : threads)
+		thread.join();
+
+	std::sort(timeline->begin(), timeline->end(), [](const StartupEvent &a, const StartupEvent &b) {
+		return a.camera != b.camera ? a.camera < b.camera : a.step < b.step;
+	});
+	for (int camera = 0; camera < cameras; camera++)
+		if (results[camera] != DRV_SUCCESS)
+			return results[camera];
+	return DRV_SUCCESS;
+}
+
+unsigned int CsWriteTimeline(const std::vector<StartupStep> &steps,
+	const std::vector<StartupEvent> &timeline, const char *filename)
+{
+	if (filename == NULL)
+		return DRV_P3INVALID;
+
+	FILE *file = fopen(filename, "w");
+	if (file == NULL)
+		return DRV_ERROR_FILESAVE;
+	fprintf(file, "camera,step,ready_ms,start_ms,end_ms,lock_wait_ms,duration_ms,result\n");
+	for (const StartupEvent &event : timeline) {
+		const char *name = event.step < (int)steps.size() ? steps[event.step].name.c_str() : "?";
+		fprintf(file, "%d,%s,%.3f,%.3f,%.3f,%.3f,%.3f,%u\n", event.camera, name,
+			event.ready * 1000.0, event.start * 1000.0, event.end * 1000.0,
+			(event.start - event.ready) * 1000.0, (event.end - event.start) * 1000.0, event.result);
+	}
+	return fclose(file) == 0 ? DRV_SUCCESS : DRV_ERROR_FILESAVE;
+}
@@ -0,0 +1,76 @@
+// CameraStartup.h : Parallel start-up of every connected camera with a per-step timeline.
+//
+// Initialize(), the capability queries, the speed table scan and cooler start
+// cost seconds per camera. Each camera gets its own start-up thread running
+// the same list of steps. Steps marked sdk run inside CameraManager::Call(),
+// so the SDK itself stays serialised, but one camera's host-side steps (buffer
+// allocation, loading calibration, building lookup tables) overlap with the
+// other cameras' SDK steps, and no camera waits for another to finish
+// completely. Every step of every camera is recorded with the time it became
+// ready, the time it got the SDK, and the time it finished, so the timeline
+// shows where the seconds go and how much of it is queueing for the lock.
+
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "CameraManager.h"
+
+extern "C" {
+	#include "atmcd32d.h"
+}
+
+// What start-up learns about a camera
+struct CameraInfo {
+	int						serial;
+	char					headModel[32];
+	int						xPixels;
+	int						yPixels;
+	AndorCapabilities		caps;
+	int						minTemp;
+	int						maxTemp;
+	int						adChannel;		// fastest horizontal readout found by the scan
+	int						hsSpeedIndex;
+	float					hsSpeed;		// MHz
+	int						vsSpeedIndex;	// fastest recommended vertical shift
+	float					vsSpeed;		// microseconds per row
+};
+
+typedef std::function<unsigned int(int camera, CameraInfo *info)> StartupFn;
+
+struct StartupStep {
+	std::string				name;
+	bool					sdk;			// run under the SDK lock with the camera current
+	StartupFn				run;
+};
+
+struct StartupEvent {
+	int						camera;
+	int						step;			// index into the step list
+	double					ready;			// seconds since start-up began
+	double					start;			// when the step began running (after the lock, for sdk steps)
+	double					end;
+	unsigned int			result;
+};
+
+// Initialize(driverDir), identify, capabilities, speed table scan, apply the
+// fastest speeds, cooler on. Host-side steps can be inserted anywhere.
+void CsDefaultSteps(const char *driverDir, std::vector<StartupStep> *steps);
+
+// SDK sequences used by the default steps, for the current camera
+unsigned int CsIdentify(CameraInfo *info);
+unsigned int CsQueryCapabilities(CameraInfo *info);
+unsigned int CsScanSpeeds(CameraInfo *info);
+unsigned int CsApplySpeeds(const CameraInfo *info);
+
+// Runs steps on every camera of manager at once. A camera stops at its first
+// failing step; the first failure is returned. infos and timeline are
+// replaced, infos indexed by camera.
+unsigned int CsRunStartup(CameraManager *manager, const std::vector<StartupStep> &steps,
+	std::vector<CameraInfo> *infos, std::vector<StartupEvent> *timeline);
+
+// Writes the timeline as CSV, one line per step per camera
+unsigned int CsWriteTimeline(const std::vector<StartupStep> &steps,
+	const std::vector<StartupEvent> &timeline, const char *filename);
@@ -0,0 +1,153 @@
+// CapabilityCache.cpp : On-disk cache of camera capabilities and readout speeds.
+//
+
+#include "stdafx.h"
+#include "CapabilityCache.h"
+#if defined(SDK_RECORD) || defined(SDK_REPLAY)
+#include "StreamReplay.h"
+#endif
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+static const char kCcMagic[8] = { 'A', 'N', 'D', 'O', 'R', 'C', 'A', 'P' };
+static const uint32_t kCcVersion = 1;
+
+unsigned int CcQueryKey(CameraKey *key)
+{
+	if (key == NULL)
+		return DRV_P1INVALID;
+
+	memset(key, 0, sizeof(*key));
+	unsigned int error = GetCameraSerialNumber(&key->serial);
+	if (error != DRV_SUCCESS)
+		return error;
+	unsigned int *s = key->software, *h = key->hardware;
+	error = GetSoftwareVersion(&s[0], &s[1], &s[2], &s[3], &s[4], &s[5]);
+	if (error != DRV_SUCCESS)
+		return error;
+	return GetHardwareVersion(&h[0], &h[1], &h[2], &h[3], &h[4], &h[5]);
+}
+
+unsigned int CcLoad(CapabilityCache *cache, const char *filename)
+{
+	if (cache == NULL)
+		return DRV_P1INVALID;
+	if (filename == NULL)
+		return DRV_P2INVALID;
+
+	std::lock_guard<std::mutex> guard(cache->lock);
+	cache->records.clear();
+	cache->dirty = false;
+
+	FILE *file = fopen(filename, "rb");
+	if (file == NULL)
+		return DRV_ERROR_FILELOAD;
+
+	char magic[8];
+	uint32_t header[3];
+	bool ok = fread(magic, sizeof(magic), 1, file) == 1
+		&& memcmp(magic, kCcMagic, sizeof(magic)) == 0
+		&& fread(header, sizeof(header), 1, file) == 1
+		&& header[0] == kCcVersion
+		&& header[1] == sizeof(CapabilityRecord)
+		&& header[2] < 4096;
+	if (ok) {
+		cache->records.resize(header[2]);
+		ok = fread(cache->records.data(), sizeof(CapabilityRecord), header[2], file) == header[2];
+	}
+	fclose(file);
+	if (!ok) {
+		cache->records.clear();
+		return DRV_ERROR_FILELOAD;
+	}
+	return DRV_SUCCESS;
+}
+
+unsigned int CcSave(CapabilityCache *cache, const char *filename)
+{
+	if (cache == NULL)
+		return DRV_P1INVALID;
+	if (filename == NULL)
+		return DRV_P2INVALID;
+
+	std::lock_guard<std::mutex> guard(cache->lock);
+	FILE *file = fopen(filename, "wb");
+	if (file == NULL)
+		return DRV_ERROR_FILESAVE;
+
+	uint32_t header[3] = { kCcVersion, (uint32_t)sizeof(CapabilityRecord), (uint32_t)cache->records.size() };
+	bool ok = fwrite(kCcMagic, sizeof(kCcMagic), 1, file) == 1
+		&& fwrite(header, sizeof(header), 1, file) == 1
+		&& fwrite(cache->records.data(), sizeof(CapabilityRecord), cache->records.size(), file) == cache->records.size();
+	if (fclose(file) != 0)
+		ok = false;
+	if (ok)
+		cache->dirty = false;
+	return ok ? DRV_SUCCESS : DRV_ERROR_FILESAVE;
+}
+
+unsigned int CcGetCameraInfo(CapabilityCache *cache, CameraInfo *info, bool *pHit)
+{
+	if (cache == NULL)
+		return DRV_P1INVALID;
+	if (info == NULL)
+		return DRV_P2INVALID;
+
+	if (pHit)
+		*pHit = false;
+
+	// Without a key the camera is enumerated but not cached
+	CameraKey key;
+	bool keyed = CcQueryKey(&key) == DRV_SUCCESS;
+	if (keyed) {
+		std::lock_guard<std::mutex> guard(cache->lock);
+		for (const CapabilityRecord &record : cache->records) {
+			if (memcmp(&record.key, &key, sizeof(key)) == 0) {
+				*info = record.info;
+				if (pHit)
+					*pHit = true;
+				return DRV_SUCCESS;
+			}
+		}
+	}
+
+	// Every query runs even when an earlier one fails, so a camera that cannot
+	// report its capabilities still gets its detector size and speeds
+	memset(info, 0, sizeof(*info));
+	unsigned int error = CsIdentify(info);
+	if (info->xPixels == 0)
+		GetDetector(&info->xPixels, &info->yPixels);
+	unsigned int stepError = CsQueryCapabilities(info);
+	if (error == DRV_SUCCESS)
+		error = stepError;
+	stepError = CsScanSpeeds(info);
+	if (error == DRV_SUCCESS)
+		error = stepError;
+	if (error != DRV_SUCCESS || !keyed)
+		return error;
+
+	std::lock_guard<std::mutex> guard(cache->lock);
+	CapabilityRecord record;
+	memset(&record, 0, sizeof(record));
+	record.key = key;
+	record.info = *info;
+	// Replace any record for the same camera left by an older driver
+	size_t r = 0;
+	while (r < cache->records.size() && cache->records[r].key.serial != key.serial)
+		r++;
+	if (r < cache->records.size())
+		cache->records[r] = record;
+	else
+		cache->records.push_back(record);
+	cache->dirty = true;
+	return DRV_SUCCESS;
+}
+
+StartupStep CcStartupStep(CapabilityCache *cache)
+{
+	return { "CachedCapabilities", true, [cache](int, CameraInfo *info) {
+		return CcGetCameraInfo(cache, info, NULL);
+	} };
+}
@@ -0,0 +1,62 @@
+// CapabilityCache.h : On-disk cache of camera capabilities and readout speeds.
+//
+// The capability queries and the AD channel x horizontal speed scan give the
+// same answers every time for a given camera, driver and firmware, yet they
+// run on every start. The cache keeps one record per camera, keyed by
+// GetCameraSerialNumber plus everything GetSoftwareVersion and
+// GetHardwareVersion report. Checking the key costs three quick calls; when
+// it matches, the stored CameraInfo is used and the enumeration skipped.
+// A new driver or firmware changes the key, so stale records never match.
+
+#pragma once
+
+#include <mutex>
+#include <vector>
+
+#include "CameraStartup.h"
+
+extern "C" {
+	#include "atmcd32d.h"
+}
+
+struct CameraKey {
+	int						serial;
+	unsigned int			software[6];	// eprom, coffile, vxdrev, vxdver, dllrev, dllver
+	unsigned int			hardware[6];	// PCB, decode, dummy1, dummy2, firmware version, firmware build
+};
+
+struct CapabilityRecord {
+	CameraKey				key;
+	CameraInfo				info;
+};
+
+struct CapabilityCache {
+	std::vector<CapabilityRecord>	records;
+	bool					dirty;			// changed since loaded
+	std::mutex				lock;			// cameras may start up on several threads
+};
+
+// Reads the key of the current camera
+unsigned int CcQueryKey(CameraKey *key);
+
+// Cache file, native layout (the record size guards against other builds):
+//   char     magic[8]        "ANDORCAP"
+//   uint32   version         1
+//   uint32   recordSize      sizeof(CapabilityRecord)
+//   uint32   count
+//   CapabilityRecord records[count]
+// A missing or unreadable file leaves the cache empty and returns
+// DRV_ERROR_FILELOAD; start-up then simply fills it.
+unsigned int CcLoad(CapabilityCache *cache, const char *filename);
+unsigned int CcSave(CapabilityCache *cache, const char *filename);
+
+// Fills info for the current camera, from the cache when the key matches and
+// from the SDK (CsIdentify, CsQueryCapabilities, CsScanSpeeds) otherwise, in
+// which case the record is added. *pHit (may be NULL) tells which. A failing
+// query returns its error but leaves the rest of info filled, and nothing is
+// cached; a camera whose key cannot be read is enumerated every time.
+unsigned int CcGetCameraInfo(CapabilityCache *cache, CameraInfo *info, bool *pHit);
+
+// Start-up step running CcGetCameraInfo, to replace the Identify,
+// Capabilities and SpeedTable steps of CsDefaultSteps
+StartupStep CcStartupStep(CapabilityCache *cache);
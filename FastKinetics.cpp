@@ -0,0 +1,129 @@
+// FastKinetics.cpp : Fast kinetics sub-frame splitter and stacker.
+//
+
+#include "stdafx.h"
+#include "FastKinetics.h"
+
+unsigned int FkQueryTiming(FkConfig *config, int shiftSpeedIndex)
+{
+	if (config == NULL)
+		return DRV_P1INVALID;
+
+	int speeds = 0;
+	unsigned int error = GetNumberFKVShiftSpeeds(&speeds);
+	if (error != DRV_SUCCESS)
+		return error;
+	if (shiftSpeedIndex < 0 || shiftSpeedIndex >= speeds)
+		return DRV_P2INVALID;
+
+	error = GetFKExposureTime(&config->exposure);
+	if (error != DRV_SUCCESS)
+		return error;
+	return GetFKVShiftSpeedF(shiftSpeedIndex, &config->shiftTime);
+}
+
+unsigned int FkInitialise(FkSeries *series, const FkConfig *config)
+{
+	if (series == NULL)
+		return DRV_P1INVALID;
+	if (config == NULL || config->width <= 0 || config->subHeight <= 0
+		|| config->seriesLength <= 0 || config->exposedRows <= 0
+		|| config->exposure < 0.0f || config->shiftTime < 0.0f
+		|| config->hbin <= 0 || config->hbin > config->width
+		|| config->vbin <= 0 || config->vbin > config->subHeight)
+		return DRV_P2INVALID;
+
+	series->config = *config;
+	series->period = (double)config->exposure + config->exposedRows * (double)config->shiftTime * 1e-6;
+	series->kernels = PkSelect<WORD>(config->width, config->hbin, config->vbin);
+	series->scratch.resize(config->width);
+	FkReset(series);
+	return DRV_SUCCESS;
+}
+
+unsigned int FkAddReadout(FkSeries *series, std::vector<WORD> *readout, double start)
+{
+	if (series == NULL || series->config.width <= 0)
+		return DRV_P1INVALID;
+	const FkConfig &config = series->config;
+	size_t subPixels = (size_t)config.width * config.subHeight;
+	if (readout == NULL || readout->size() != subPixels * config.seriesLength)
+		return DRV_P2INVALID;
+
+	int readoutIndex = series->frames.empty() ? 0 : series->frames.back().readout + 1;
+	series->readouts.push_back(std::vector<WORD>());
+	series->readouts.back().swap(*readout);
+	const WORD *data = series->readouts.back().data();
+
+	bool binning = config.hbin > 1 || config.vbin > 1;
+	int outWidth = config.width / config.hbin;
+	int outHeight = config.subHeight / config.vbin;
+	size_t outPixels = (size_t)outWidth * outHeight;
+	WORD *binnedData = NULL;
+	if (binning) {
+		series->binned.push_back(std::vector<WORD>(outPixels * config.seriesLength));
+		binnedData = series->binned.back().data();
+	}
+
+	for (int k = 0; k < config.seriesLength; k++) {
+		int position = config.lastFirst ? config.seriesLength - 1 - k : k;
+		const WORD *sub = data + subPixels * position;
+		FkFrame frame;
+		frame.width = outWidth;
+		frame.height = outHeight;
+		frame.stride = outWidth;
+		frame.timestamp = start + k * series->period;
+		frame.readout = readoutIndex;
+		frame.index = k;
+		if (binning) {
+			WORD *out = binnedData + outPixels * k;
+			series->kernels.bin(sub, config.width, config.subHeight, config.hbin, config.vbin,
+				out, series->scratch.data());
+			frame.data = out;
+		}
+		else
+			frame.data = sub;
+		series->frames.push_back(frame);
+	}
+	return DRV_SUCCESS;
+}
+
+int FkGetFrameCount(const FkSeries *series)
+{
+	return (int)series->frames.size();
+}
+
+const FkFrame *FkGetFrame(const FkSeries *series, int frame)
+{
+	if (frame < 0 || frame >= (int)series->frames.size())
+		return NULL;
+	return &series->frames[frame];
+}
+
+unsigned int FkTrim(FkSeries *series, int keep)
+{
+	if (series == NULL)
+		return DRV_P1INVALID;
+	if (keep < 0)
+		return DRV_P2INVALID;
+
+	bool binning = !series->binned.empty();
+	int drop = (int)series->readouts.size() - keep;
+	if (drop <= 0)
+		return DRV_SUCCESS;
+	for (int i = 0; i < drop; i++) {
+		series->readouts.pop_front();
+		if (binning)
+			series->binned.pop_front();
+	}
+	series->frames.erase(series->frames.begin(),
+		series->frames.begin() + (size_t)drop * series->config.seriesLength);
+	return DRV_SUCCESS;
+}
+
+void FkReset(FkSeries *series)
+{
+	series->readouts.clear();
+	series->binned.clear();
+	series->frames.clear();
+}
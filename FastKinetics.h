@@ -0,0 +1,77 @@
+// FastKinetics.h : Fast kinetics sub-frame splitter and stacker.
+//
+// SetFastKinetics/SetFastKineticsEx(exposedRows, seriesLength, ...) return one
+// readout holding seriesLength sub-areas, each a separate time point. This
+// stage takes ownership of each readout buffer and appends one view per
+// sub-area to a time series, so the sub-frames are addressed in place rather
+// than copied. Sub-frame k of a readout is stamped
+//
+//     start + k * (fkExposure + exposedRows * shiftTime)
+//
+// with fkExposure from GetFKExposureTime and shiftTime from GetFKVShiftSpeedF
+// for the selected SetFKVShiftSpeed index. When software binning is requested
+// the binned sub-frames are written to one buffer per readout and the views
+// point there instead.
+
+#pragma once
+
+#include <stdint.h>
+#include <deque>
+#include <vector>
+
+#include "PixelKernels.h"
+
+extern "C" {
+	#include "atmcd32d.h"
+}
+
+struct FkConfig {
+	int						width;			// readout width after hardware hbin
+	int						subHeight;		// rows per sub-area after hardware vbin
+	int						seriesLength;	// sub-areas per readout
+	int						exposedRows;	// unbinned rows shifted between exposures
+	float					exposure;		// GetFKExposureTime, seconds
+	float					shiftTime;		// GetFKVShiftSpeedF, microseconds per row
+	bool					lastFirst;		// readout lists the last exposure first
+	int						hbin;			// software binning per sub-frame, 1 for none
+	int						vbin;
+};
+
+// Zero-copy view of one sub-frame
+struct FkFrame {
+	const WORD				*data;
+	int						width;
+	int						height;
+	int						stride;			// pixels between rows
+	double					timestamp;		// seconds, start of the sub-area's exposure
+	int						readout;		// readout it came from
+	int						index;			// position within that readout
+};
+
+struct FkSeries {
+	FkConfig				config;
+	double					period;			// seconds between sub-frame exposures
+	std::deque<std::vector<WORD> >	readouts;	// owned; a deque never moves its elements
+	std::deque<std::vector<WORD> >	binned;
+	std::vector<FkFrame>	frames;
+	PkKernels<WORD>			kernels;		// binning, chosen for the readout geometry
+	std::vector<WORD>		scratch;
+};
+
+// Fills exposure and shiftTime from the SDK for the given fast kinetics
+// vertical shift speed index
+unsigned int FkQueryTiming(FkConfig *config, int shiftSpeedIndex);
+
+unsigned int FkInitialise(FkSeries *series, const FkConfig *config);
+
+// Takes ownership of a readout of width * subHeight * seriesLength pixels
+// (the vector is left empty) and appends its sub-frames in exposure order
+unsigned int FkAddReadout(FkSeries *series, std::vector<WORD> *readout, double start);
+
+int FkGetFrameCount(const FkSeries *series);
+const FkFrame *FkGetFrame(const FkSeries *series, int frame);
+
+// Drops the oldest readouts and their sub-frames, keeping the newest keep
+unsigned int FkTrim(FkSeries *series, int keep);
+
+void FkReset(FkSeries *series);
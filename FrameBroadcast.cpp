@@ -0,0 +1,294 @@
+// FrameBroadcast.cpp : Shared-memory frame ring for other local processes.
+//
+
+#include "stdafx.h"
+#include "FrameBroadcast.h"
+
+#include <atomic>
+#include <string.h>
+#include <windows.h>
+
+static const char kFbMagic[8] = { 'A', 'N', 'D', 'O', 'R', 'S', 'H', 'M' };
+static const uint32_t kFbVersion = 1;
+static const size_t kFbAlign = 64;
+
+// Both live in the mapping, so only fixed-size, address-free types
+struct FbHeader {
+	char					magic[8];
+	uint32_t				version;
+	uint32_t				slotCount;
+	uint64_t				slotStride;
+	uint64_t				maxFrameBytes;
+	std::atomic<uint64_t>	published;		// frames completed
+};
+
+struct FbSlot {
+	std::atomic<uint64_t>	seq;			// 2n + 1 while frame n is written, 2n + 2 once done
+	std::atomic<int32_t>	width;
+	std::atomic<int32_t>	height;
+	std::atomic<int32_t>	bytesPerPixel;
+	std::atomic<uint64_t>	bytes;
+	std::atomic<double>		timestamp;
+};
+
+static size_t FbAlignUp(size_t value)
+{
+	return (value + kFbAlign - 1) & ~(kFbAlign - 1);
+}
+
+static size_t FbHeaderBytes()
+{
+	return FbAlignUp(sizeof(FbHeader));
+}
+
+static size_t FbSlotHeaderBytes()
+{
+	return FbAlignUp(sizeof(FbSlot));
+}
+
+static FbSlot *FbGetSlot(const FrameBroadcast *fb, uint64_t n)
+{
+	const FbHeader *header = fb->header;
+	return (FbSlot *)(fb->base + FbHeaderBytes() + (n % header->slotCount) * header->slotStride);
+}
+
+static uint8_t *FbSlotData(FbSlot *slot)
+{
+	return (uint8_t *)slot + FbSlotHeaderBytes();
+}
+
+static unsigned int FbMap(FrameBroadcast *fb, HANDLE mapping, DWORD access)
+{
+	void *view = MapViewOfFile(mapping, access, 0, 0, 0);
+	if (view == NULL) {
+		CloseHandle(mapping);
+		return fb->writer ? DRV_ERROR_FILESAVE : DRV_ERROR_FILELOAD;
+	}
+	fb->mapping = mapping;
+	fb->base = (uint8_t *)view;
+	fb->header = (FbHeader *)view;
+	return DRV_SUCCESS;
+}
+
+// Reads a completed frame's description, or fails if slot n holds another frame
+static bool FbDescribe(const FrameBroadcast *fb, uint64_t n, FbFrame *frame)
+{
+	FbSlot *slot = FbGetSlot(fb, n);
+	uint64_t seq = slot->seq.load(std::memory_order_acquire);
+	if (seq != 2 * n + 2)
+		return false;
+	frame->data = FbSlotData(slot);
+	frame->sequence = n;
+	frame->width = slot->width.load(std::memory_order_relaxed);
+	frame->height = slot->height.load(std::memory_order_relaxed);
+	frame->bytesPerPixel = slot->bytesPerPixel.load(std::memory_order_relaxed);
+	frame->bytes = (size_t)slot->bytes.load(std::memory_order_relaxed);
+	frame->timestamp = slot->timestamp.load(std::memory_order_relaxed);
+	frame->dropped = 0;
+	frame->slot = slot;
+	return FbIsValid(fb, frame);
+}
+
+//------------------------------------------------------------------------------
+// Writer
+//------------------------------------------------------------------------------
+
+unsigned int FbCreate(FrameBroadcast *fb, const char *name, int slots, size_t maxFrameBytes)
+{
+	if (fb == NULL)
+		return DRV_P1INVALID;
+	if (name == NULL)
+		return DRV_P2INVALID;
+	if (slots < 2)
+		return DRV_P3INVALID;
+	if (maxFrameBytes == 0)
+		return DRV_P4INVALID;
+
+	memset(fb, 0, sizeof(*fb));
+	fb->writer = true;
+	uint64_t stride = FbSlotHeaderBytes() + FbAlignUp(maxFrameBytes);
+	uint64_t size = FbHeaderBytes() + stride * (uint64_t)slots;
+	HANDLE mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE,
+		(DWORD)(size >> 32), (DWORD)size, name);
+	if (mapping == NULL)
+		return DRV_ERROR_FILESAVE;
+	bool existed = GetLastError() == ERROR_ALREADY_EXISTS;
+	unsigned int error = FbMap(fb, mapping, FILE_MAP_ALL_ACCESS);
+	if (error != DRV_SUCCESS)
+		return error;
+
+	FbHeader *header = fb->header;
+	if (existed) {
+		// Readers kept the mapping alive across a restart of the writer; carry
+		// on from its count so they notice nothing, if the layout still fits
+		if (memcmp(header->magic, kFbMagic, sizeof(kFbMagic)) == 0 && header->version == kFbVersion
+			&& header->slotCount == (uint32_t)slots && header->maxFrameBytes == maxFrameBytes)
+			return DRV_SUCCESS;
+		FbClose(fb);
+		return DRV_ERROR_FILESAVE;
+	}
+
+	// A new mapping is zero filled, so every slot reads as never written
+	header->version = kFbVersion;
+	header->slotCount = (uint32_t)slots;
+	header->slotStride = stride;
+	header->maxFrameBytes = maxFrameBytes;
+	header->published.store(0, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	memcpy(header->magic, kFbMagic, sizeof(kFbMagic));
+	return DRV_SUCCESS;
+}
+
+uint8_t *FbBeginWrite(FrameBroadcast *fb)
+{
+	if (fb == NULL || fb->header == NULL || !fb->writer)
+		return NULL;
+	uint64_t n = fb->header->published.load(std::memory_order_relaxed);
+	FbSlot *slot = FbGetSlot(fb, n);
+	slot->seq.store(2 * n + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	fb->writing = n;
+	return FbSlotData(slot);
+}
+
+unsigned int FbEndWrite(FrameBroadcast *fb, int width, int height, int bytesPerPixel, double timestamp)
+{
+	if (fb == NULL || fb->header == NULL || !fb->writer)
+		return DRV_P1INVALID;
+	uint64_t bytes = (uint64_t)width * height * bytesPerPixel;
+	if (width <= 0 || height <= 0 || bytesPerPixel <= 0 || bytes > fb->header->maxFrameBytes)
+		return DRV_P2INVALID;
+
+	uint64_t n = fb->writing;
+	FbSlot *slot = FbGetSlot(fb, n);
+	slot->width.store(width, std::memory_order_relaxed);
+	slot->height.store(height, std::memory_order_relaxed);
+	slot->bytesPerPixel.store(bytesPerPixel, std::memory_order_relaxed);
+	slot->bytes.store(bytes, std::memory_order_relaxed);
+	slot->timestamp.store(timestamp, std::memory_order_relaxed);
+	slot->seq.store(2 * n + 2, std::memory_order_release);
+	fb->header->published.store(n + 1, std::memory_order_release);
+	return DRV_SUCCESS;
+}
+
+unsigned int FbPublish(FrameBroadcast *fb, const void *data, int width, int height, int bytesPerPixel, double timestamp)
+{
+	if (fb == NULL || fb->header == NULL || !fb->writer)
+		return DRV_P1INVALID;
+	if (data == NULL)
+		return DRV_P2INVALID;
+	uint64_t bytes = (uint64_t)width * height * bytesPerPixel;
+	if (width <= 0 || height <= 0 || bytesPerPixel <= 0 || bytes > fb->header->maxFrameBytes)
+		return DRV_P3INVALID;
+
+	memcpy(FbBeginWrite(fb), data, (size_t)bytes);
+	return FbEndWrite(fb, width, height, bytesPerPixel, timestamp);
+}
+
+//------------------------------------------------------------------------------
+// Reader
+//------------------------------------------------------------------------------
+
+unsigned int FbOpen(FrameBroadcast *fb, const char *name)
+{
+	if (fb == NULL)
+		return DRV_P1INVALID;
+	if (name == NULL)
+		return DRV_P2INVALID;
+
+	memset(fb, 0, sizeof(*fb));
+	HANDLE mapping = OpenFileMappingA(FILE_MAP_READ, FALSE, name);
+	if (mapping == NULL)
+		return DRV_ERROR_FILELOAD;
+	unsigned int error = FbMap(fb, mapping, FILE_MAP_READ);
+	if (error != DRV_SUCCESS)
+		return error;
+
+	const FbHeader *header = fb->header;
+	if (memcmp(header->magic, kFbMagic, sizeof(kFbMagic)) != 0 || header->version != kFbVersion) {
+		FbClose(fb);
+		return DRV_ERROR_FILELOAD;
+	}
+	std::atomic_thread_fence(std::memory_order_acquire);
+	return DRV_SUCCESS;
+}
+
+uint64_t FbGetPublishedCount(const FrameBroadcast *fb)
+{
+	return fb->header->published.load(std::memory_order_acquire);
+}
+
+unsigned int FbReadLatest(const FrameBroadcast *fb, FbFrame *frame)
+{
+	if (fb == NULL || fb->header == NULL)
+		return DRV_P1INVALID;
+	if (frame == NULL)
+		return DRV_P2INVALID;
+
+	// Losing the race means a newer frame has been published; take that one
+	for (;;) {
+		uint64_t published = FbGetPublishedCount(fb);
+		if (published == 0)
+			return DRV_NO_NEW_DATA;
+		if (FbDescribe(fb, published - 1, frame))
+			return DRV_SUCCESS;
+	}
+}
+
+unsigned int FbRead(const FrameBroadcast *fb, uint64_t *next, FbFrame *frame)
+{
+	if (fb == NULL || fb->header == NULL)
+		return DRV_P1INVALID;
+	if (next == NULL)
+		return DRV_P2INVALID;
+	if (frame == NULL)
+		return DRV_P3INVALID;
+
+	uint64_t wanted = *next;
+	for (;;) {
+		uint64_t published = FbGetPublishedCount(fb);
+		if (wanted >= published)
+			return DRV_NO_NEW_DATA;
+		// The slot after the newest may already be being overwritten
+		uint64_t slots = fb->header->slotCount;
+		uint64_t oldest = published >= slots ? published - slots + 1 : 0;
+		uint64_t n = wanted > oldest ? wanted : oldest;
+		if (FbDescribe(fb, n, frame)) {
+			frame->dropped = n - wanted;
+			*next = n + 1;
+			return DRV_SUCCESS;
+		}
+	}
+}
+
+bool FbIsValid(const FrameBroadcast *fb, const FbFrame *frame)
+{
+	(void)fb;
+	std::atomic_thread_fence(std::memory_order_acquire);
+	const FbSlot *slot = (const FbSlot *)frame->slot;
+	return slot->seq.load(std::memory_order_relaxed) == 2 * frame->sequence + 2;
+}
+
+unsigned int FbCopy(const FrameBroadcast *fb, const FbFrame *frame, void *buffer, size_t size)
+{
+	if (fb == NULL || fb->header == NULL)
+		return DRV_P1INVALID;
+	if (frame == NULL)
+		return DRV_P2INVALID;
+	if (buffer == NULL || size < frame->bytes)
+		return DRV_P3INVALID;
+
+	memcpy(buffer, frame->data, frame->bytes);
+	return FbIsValid(fb, frame) ? DRV_SUCCESS : DRV_NO_NEW_DATA;
+}
+
+void FbClose(FrameBroadcast *fb)
+{
+	if (fb == NULL)
+		return;
+	if (fb->base)
+		UnmapViewOfFile(fb->base);
+	if (fb->mapping)
+		CloseHandle(fb->mapping);
+	memset(fb, 0, sizeof(*fb));
+}
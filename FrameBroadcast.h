@@ -0,0 +1,70 @@
+// FrameBroadcast.h : Shared-memory frame ring for other local processes.
+//
+// Only the process that called Initialize() can talk to the camera, but a
+// viewer, an archiver and an analysis process all want its frames. The
+// acquiring process creates a named file mapping holding a ring of frame
+// slots; any number of readers open it read-only and look at frames in place.
+//
+// Each slot starts with a sequence number, odd while the writer fills the slot
+// and even once the frame is complete, so the writer never waits for anybody:
+// a reader notes the sequence, works on the frame where it lies, and then
+// calls FbIsValid() to learn whether the writer lapped it meanwhile. Readers
+// wanting an exact copy use FbCopy(), which does the same check around a
+// memcpy. Readers can follow the latest frame or step through every one, in
+// which case frames the writer has already overwritten are counted as dropped.
+//
+// The writer can also fill a slot in place with FbBeginWrite()/FbEndWrite(),
+// passing the slot memory straight to GetMostRecentImage16.
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+extern "C" {
+	#include "atmcd32d.h"
+}
+
+struct FbHeader;
+
+struct FrameBroadcast {
+	void					*mapping;		// file mapping handle
+	uint8_t					*base;			// mapped view
+	FbHeader				*header;
+	bool					writer;
+	uint64_t				writing;		// sequence of the slot between FbBeginWrite and FbEndWrite
+};
+
+struct FbFrame {
+	const uint8_t			*data;			// inside the mapping; only valid while FbIsValid()
+	uint64_t				sequence;		// frames published before this one
+	int						width;
+	int						height;
+	int						bytesPerPixel;
+	size_t					bytes;
+	double					timestamp;		// as given by the writer
+	uint64_t				dropped;		// frames overwritten before FbRead reached them
+	const void				*slot;
+};
+
+// Writer. maxFrameBytes bounds the frames that can be published.
+unsigned int FbCreate(FrameBroadcast *fb, const char *name, int slots, size_t maxFrameBytes);
+unsigned int FbPublish(FrameBroadcast *fb, const void *data, int width, int height, int bytesPerPixel, double timestamp);
+// Returns the memory of the next slot to fill, maxFrameBytes long
+uint8_t *FbBeginWrite(FrameBroadcast *fb);
+unsigned int FbEndWrite(FrameBroadcast *fb, int width, int height, int bytesPerPixel, double timestamp);
+
+// Reader
+unsigned int FbOpen(FrameBroadcast *fb, const char *name);
+// Most recently published frame; DRV_NO_NEW_DATA when there is none yet
+unsigned int FbReadLatest(const FrameBroadcast *fb, FbFrame *frame);
+// Frame *next, or the oldest still held if that has been overwritten; on
+// success *next is advanced past it. DRV_NO_NEW_DATA when *next is not yet
+// published.
+unsigned int FbRead(const FrameBroadcast *fb, uint64_t *next, FbFrame *frame);
+bool FbIsValid(const FrameBroadcast *fb, const FbFrame *frame);
+// Copies the frame out, failing with DRV_NO_NEW_DATA if it was overwritten
+unsigned int FbCopy(const FrameBroadcast *fb, const FbFrame *frame, void *buffer, size_t size);
+uint64_t FbGetPublishedCount(const FrameBroadcast *fb);
+
+void FbClose(FrameBroadcast *fb);
@@ -0,0 +1,264 @@
+// FrameHistogram.cpp : Per-frame histogram, percentile clip points and auto-contrast.
+//
+
+#include "stdafx.h"
+#include "FrameHistogram.h"
+#include "SimdSupport.h"
+#include "WorkerPool.h"
+
+#include <string.h>
+#include <algorithm>
+
+static const size_t kFhTilePixels = 65536;
+static const int kFhCoarseReplicas = 4;			// interleaved counter copies for small histograms
+static const int kFhMaxCoarseBins = 4096;		// above this the copies no longer fit in L1/L2
+
+static int FhBinCount(const FrameHistogram *hist)
+{
+	return 65536 >> hist->binShift;
+}
+
+static int FhReplicas(const FrameHistogram *hist)
+{
+	return FhBinCount(hist) <= kFhMaxCoarseBins ? kFhCoarseReplicas : 1;
+}
+
+//------------------------------------------------------------------------------
+// Counting kernels. counts holds `replicas` consecutive histograms.
+//------------------------------------------------------------------------------
+
+static void FhCountScalar(const WORD *p, size_t n, int shift, int bins, int replicas,
+	uint32_t *counts, WORD *pMin, WORD *pMax)
+{
+	WORD lo = *pMin, hi = *pMax;
+	size_t i = 0;
+	if (replicas == 4) {
+		uint32_t *c1 = counts + bins, *c2 = counts + 2 * bins, *c3 = counts + 3 * bins;
+		for (; i + 4 <= n; i += 4) {
+			counts[p[i] >> shift]++;
+			c1[p[i + 1] >> shift]++;
+			c2[p[i + 2] >> shift]++;
+			c3[p[i + 3] >> shift]++;
+			lo = std::min(lo, std::min(std::min(p[i], p[i + 1]), std::min(p[i + 2], p[i + 3])));
+			hi = std::max(hi, std::max(std::max(p[i], p[i + 1]), std::max(p[i + 2], p[i + 3])));
+		}
+	}
+	for (; i < n; i++) {
+		counts[p[i] >> shift]++;
+		lo = std::min(lo, p[i]);
+		hi = std::max(hi, p[i]);
+	}
+	*pMin = lo;
+	*pMax = hi;
+}
+
+#if SIMD_X86
+SIMD_TARGET_AVX2
+static void FhCountAVX2(const WORD *p, size_t n, int shift, int bins, int replicas,
+	uint32_t *counts, WORD *pMin, WORD *pMax)
+{
+	// Bin indices and the extremes come out of the vector unit, the increments
+	// themselves stay scalar (AVX2 has no conflict-free scatter)
+	const __m128i count = _mm_cvtsi32_si128(shift);
+	__m256i vmin = _mm256_set1_epi16((short)*pMin);
+	__m256i vmax = _mm256_set1_epi16((short)*pMax);
+	alignas(32) WORD index[16];
+	size_t i = 0;
+	for (; i + 16 <= n; i += 16) {
+		__m256i v = _mm256_loadu_si256((const __m256i *)(p + i));
+		vmin = _mm256_min_epu16(vmin, v);
+		vmax = _mm256_max_epu16(vmax, v);
+		_mm256_store_si256((__m256i *)index, _mm256_srl_epi16(v, count));
+		if (replicas == 4) {
+			for (int k = 0; k < 16; k += 4) {
+				counts[index[k]]++;
+				counts[bins + index[k + 1]]++;
+				counts[2 * bins + index[k + 2]]++;
+				counts[3 * bins + index[k + 3]]++;
+			}
+		}
+		else {
+			for (int k = 0; k < 16; k++)
+				counts[index[k]]++;
+		}
+	}
+
+	alignas(32) WORD lanes[2][16];
+	_mm256_store_si256((__m256i *)lanes[0], vmin);
+	_mm256_store_si256((__m256i *)lanes[1], vmax);
+	for (int k = 0; k < 16; k++) {
+		*pMin = std::min(*pMin, lanes[0][k]);
+		*pMax = std::max(*pMax, lanes[1][k]);
+	}
+	FhCountScalar(p + i, n - i, shift, bins, 1, counts, pMin, pMax);
+}
+#endif
+
+//------------------------------------------------------------------------------
+// Public interface
+//------------------------------------------------------------------------------
+
+unsigned int FhInitialise(FrameHistogram *hist, int binShift)
+{
+	if (hist == NULL)
+		return DRV_P1INVALID;
+	if (binShift < 0 || binShift > 15)
+		return DRV_P2INVALID;
+	hist->binShift = binShift;
+	hist->bins.assign(FhBinCount(hist), 0);
+	hist->total = 0;
+	hist->minValue = 0;
+	hist->maxValue = 0;
+	hist->scratch.clear();
+	return DRV_SUCCESS;
+}
+
+unsigned int FhCompute(FrameHistogram *hist, const WORD *frame, size_t pixels, WorkerPool *pool)
+{
+	if (hist == NULL || hist->bins.empty())
+		return DRV_P1INVALID;
+	if (frame == NULL)
+		return DRV_P2INVALID;
+	if (pixels == 0)
+		return DRV_P3INVALID;
+
+	int bins = FhBinCount(hist);
+	int replicas = FhReplicas(hist);
+	int threads = pool ? pool->GetThreadCount() : 1;
+	size_t perThread = (size_t)bins * replicas;
+	hist->scratch.resize(perThread * threads);
+
+	// Each thread clears its own sub-histograms on first use, so threads that
+	// got no tile cost nothing in either the clear or the merge
+	std::vector<char> used(threads, 0);
+	std::vector<WORD> mins(threads, 0xFFFF), maxs(threads, 0);
+
+	auto count = FhCountScalar;
+#if SIMD_X86
+	if (GetSimdLevel() >= SIMD_AVX2)
+		count = FhCountAVX2;
+#endif
+
+	int shift = hist->binShift;
+	int tiles = (int)((pixels + kFhTilePixels - 1) / kFhTilePixels);
+	auto task = [&](int tile, int thread) {
+		uint32_t *counts = hist->scratch.data() + perThread * thread;
+		if (!used[thread]) {
+			memset(counts, 0, perThread * sizeof(uint32_t));
+			used[thread] = 1;
+		}
+		size_t begin = (size_t)tile * kFhTilePixels;
+		size_t n = std::min(kFhTilePixels, pixels - begin);
+		count(frame + begin, n, shift, bins, replicas, counts, &mins[thread], &maxs[thread]);
+	};
+	if (pool)
+		pool->Run(tiles, task);
+	else
+		for (int tile = 0; tile < tiles; tile++)
+			task(tile, 0);
+
+	std::fill(hist->bins.begin(), hist->bins.end(), 0);
+	hist->minValue = 0xFFFF;
+	hist->maxValue = 0;
+	uint32_t *merged = hist->bins.data();
+	for (int t = 0; t < threads; t++) {
+		if (!used[t])
+			continue;
+		hist->minValue = std::min(hist->minValue, mins[t]);
+		hist->maxValue = std::max(hist->maxValue, maxs[t]);
+		const uint32_t *counts = hist->scratch.data() + perThread * t;
+		for (int r = 0; r < replicas; r++, counts += bins)
+			for (int b = 0; b < bins; b++)
+				merged[b] += counts[b];
+	}
+	hist->total = pixels;
+	return DRV_SUCCESS;
+}
+
+WORD FhPercentile(const FrameHistogram *hist, double fraction)
+{
+	if (hist->total == 0)
+		return 0;
+	if (fraction <= 0.0)
+		return hist->minValue;
+	if (fraction >= 1.0)
+		return hist->maxValue;
+
+	double target = fraction * (double)hist->total;
+	uint64_t below = 0;
+	int bins = (int)hist->bins.size();
+	for (int b = 0; b < bins; b++) {
+		uint64_t next = below + hist->bins[b];
+		if ((double)next >= target) {
+			// Spread the bin's pixels evenly over the values it covers
+			int width = 1 << hist->binShift;
+			double within = hist->bins[b] ? (target - (double)below) / hist->bins[b] : 0.0;
+			int value = (b << hist->binShift) + (int)(within * (width - 1) + 0.5);
+			return (WORD)std::min(std::max(value, (int)hist->minValue), (int)hist->maxValue);
+		}
+		below = next;
+	}
+	return hist->maxValue;
+}
+
+unsigned int FhGetClipPoints(const FrameHistogram *hist, double lowFraction, double highFraction,
+	WORD saturation, ClipPoints *clip)
+{
+	if (hist == NULL || hist->total == 0)
+		return DRV_P1INVALID;
+	if (lowFraction < 0.0 || lowFraction >= highFraction)
+		return DRV_P2INVALID;
+	if (highFraction > 1.0)
+		return DRV_P3INVALID;
+	if (clip == NULL)
+		return DRV_P5INVALID;
+
+	clip->low = FhPercentile(hist, lowFraction);
+	clip->high = FhPercentile(hist, highFraction);
+	clip->median = FhPercentile(hist, 0.5);
+
+	uint64_t saturated = 0;
+	for (int b = saturation >> hist->binShift; b < (int)hist->bins.size(); b++)
+		saturated += hist->bins[b];
+	clip->saturated = (float)((double)saturated / (double)hist->total);
+	return DRV_SUCCESS;
+}
+
+unsigned int FhRenderToBytes(const WORD *frame, size_t pixels, const ClipPoints *clip, BYTE *out)
+{
+	if (frame == NULL)
+		return DRV_P1INVALID;
+	if (clip == NULL)
+		return DRV_P3INVALID;
+	if (out == NULL)
+		return DRV_P4INVALID;
+
+	// A full 16-bit lookup table costs 64 KB to build and turns the scaling
+	// into one load per pixel
+	std::vector<BYTE> lut(65536);
+	int low = clip->low;
+	int range = std::max((int)clip->high - low, 1);
+	for (int v = 0; v < 65536; v++) {
+		int scaled = ((v - low) * 255 + range / 2) / range;
+		lut[v] = (BYTE)std::min(std::max(scaled, 0), 255);
+	}
+	for (size_t i = 0; i < pixels; i++)
+		out[i] = lut[frame[i]];
+	return DRV_SUCCESS;
+}
+
+float FhSuggestExposure(const ClipPoints *clip, float exposure, WORD saturation,
+	float targetFraction, float maxStep)
+{
+	float low = clip->low;
+	float target = low + targetFraction * ((float)saturation - low);
+	float signal = (float)clip->high - low;
+	float factor = signal > 0.0f ? (target - low) / signal : maxStep;
+
+	// A saturated clip point hides how far over we are, so always back off.
+	// Isolated hot pixels sit above the clip point and do not trigger this.
+	if (clip->high >= saturation && factor > 0.5f)
+		factor = 0.5f;
+	factor = std::min(std::max(factor, 1.0f / maxStep), maxStep);
+	return exposure * factor;
+}
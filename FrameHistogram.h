@@ -0,0 +1,64 @@
+// FrameHistogram.h : Per-frame histogram, percentile clip points and auto-contrast.
+//
+// PaintImage() in the examples scales linearly between the frame minimum and
+// maximum, so one hot pixel or cosmic ray flattens the whole display. Here a
+// histogram is built once per frame and the clip points read from it (e.g. the
+// 0.5% and 99.5% percentiles) drive both the display scaling and the exposure
+// suggestion, so the renderer and auto-exposure always agree.
+//
+// Bins are either full 16-bit resolution (binShift 0) or coarse (value >> binShift).
+// Each thread counts into private sub-histograms that are merged at the end,
+// and within a thread consecutive pixels go to interleaved copies of the
+// counters so runs of equal values do not serialise on one counter.
+
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+extern "C" {
+	#include "atmcd32d.h"
+}
+
+class WorkerPool;
+
+struct FrameHistogram {
+	int						binShift;		// bin = value >> binShift
+	std::vector<uint32_t>	bins;			// 65536 >> binShift counts
+	uint64_t				total;
+	WORD					minValue;
+	WORD					maxValue;
+	std::vector<uint32_t>	scratch;		// per-thread sub-histograms, reused between frames
+};
+
+struct ClipPoints {
+	WORD					low;			// value at the low percentile
+	WORD					high;			// value at the high percentile
+	WORD					median;
+	float					saturated;		// fraction of pixels at or above the saturation level
+};
+
+unsigned int FhInitialise(FrameHistogram *hist, int binShift);
+
+// Histogram of one frame. pool may be NULL.
+unsigned int FhCompute(FrameHistogram *hist, const WORD *frame, size_t pixels, WorkerPool *pool);
+
+// Smallest value v with at least fraction of the pixels <= v. With coarse bins
+// the answer is interpolated within the bin.
+WORD FhPercentile(const FrameHistogram *hist, double fraction);
+
+// Clip points for the display and for exposure control, e.g. 0.005 and 0.995.
+// saturation is the level counted as saturated, e.g. 65535 or the ADC maximum.
+unsigned int FhGetClipPoints(const FrameHistogram *hist, double lowFraction, double highFraction,
+	WORD saturation, ClipPoints *clip);
+
+// 8-bit display data scaled between the clip points, a drop-in for the
+// DataArray fill in PaintImage(). Values outside the clip points saturate.
+unsigned int FhRenderToBytes(const WORD *frame, size_t pixels, const ClipPoints *clip, BYTE *out);
+
+// Exposure that would put the high clip point at targetFraction of the range
+// above the low clip point (the bias level in a dark-dominated frame) and
+// saturation. The change per call is limited to maxStep times either way so
+// the loop converges without oscillating.
+float FhSuggestExposure(const ClipPoints *clip, float exposure, WORD saturation,
+	float targetFraction, float maxStep);
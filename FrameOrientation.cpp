@@ -0,0 +1,458 @@
+// FrameOrientation.cpp : Host-side rotate, flip and transpose of acquired frames.
+//
+// Transpose and both 90 degree rotations share one tiled kernel. A tile is
+// loaded row by row, transposed in registers and stored row by row; the
+// rotations only differ in where the tile is read from and written to and in
+// the sign of the strides, e.g. a clockwise rotation reads the source rows
+// bottom-up. Tiles are walked in blocks small enough that the source and
+// destination lines of a block stay in L1.
+
+#include "stdafx.h"
+#include "FrameOrientation.h"
+#include "SimdSupport.h"
+
+#include <string.h>
+#include <algorithm>
+
+static const int kBlock = 64;		// block edge in pixels, 64x64x4 bytes x2 fits L1
+
+typedef void (*TileKernel)(const void *src, ptrdiff_t srcStride, void *dst, ptrdiff_t dstStride);
+
+//------------------------------------------------------------------------------
+// Tile kernels. Strides are in elements and may be negative.
+//------------------------------------------------------------------------------
+
+template <typename T, int N>
+static void TransposeTileScalar(const void *src, ptrdiff_t srcStride, void *dst, ptrdiff_t dstStride)
+{
+	const T *s = (const T *)src;
+	T *d = (T *)dst;
+	for (int j = 0; j < N; j++)
+		for (int k = 0; k < N; k++)
+			d[j * dstStride + k] = s[k * srcStride + j];
+}
+
+#if SIMD_X86
+static void TransposeTile16x8_SSE2(const void *src, ptrdiff_t srcStride, void *dst, ptrdiff_t dstStride)
+{
+	const uint16_t *s = (const uint16_t *)src;
+	uint16_t *d = (uint16_t *)dst;
+
+	__m128i a0 = _mm_loadu_si128((const __m128i *)(s + 0 * srcStride));
+	__m128i a1 = _mm_loadu_si128((const __m128i *)(s + 1 * srcStride));
+	__m128i a2 = _mm_loadu_si128((const __m128i *)(s + 2 * srcStride));
+	__m128i a3 = _mm_loadu_si128((const __m128i *)(s + 3 * srcStride));
+	__m128i a4 = _mm_loadu_si128((const __m128i *)(s + 4 * srcStride));
+	__m128i a5 = _mm_loadu_si128((const __m128i *)(s + 5 * srcStride));
+	__m128i a6 = _mm_loadu_si128((const __m128i *)(s + 6 * srcStride));
+	__m128i a7 = _mm_loadu_si128((const __m128i *)(s + 7 * srcStride));
+
+	__m128i b0 = _mm_unpacklo_epi16(a0, a1);
+	__m128i b1 = _mm_unpackhi_epi16(a0, a1);
+	__m128i b2 = _mm_unpacklo_epi16(a2, a3);
+	__m128i b3 = _mm_unpackhi_epi16(a2, a3);
+	__m128i b4 = _mm_unpacklo_epi16(a4, a5);
+	__m128i b5 = _mm_unpackhi_epi16(a4, a5);
+	__m128i b6 = _mm_unpacklo_epi16(a6, a7);
+	__m128i b7 = _mm_unpackhi_epi16(a6, a7);
+
+	__m128i c0 = _mm_unpacklo_epi32(b0, b2);
+	__m128i c1 = _mm_unpackhi_epi32(b0, b2);
+	__m128i c2 = _mm_unpacklo_epi32(b1, b3);
+	__m128i c3 = _mm_unpackhi_epi32(b1, b3);
+	__m128i c4 = _mm_unpacklo_epi32(b4, b6);
+	__m128i c5 = _mm_unpackhi_epi32(b4, b6);
+	__m128i c6 = _mm_unpacklo_epi32(b5, b7);
+	__m128i c7 = _mm_unpackhi_epi32(b5, b7);
+
+	_mm_storeu_si128((__m128i *)(d + 0 * dstStride), _mm_unpacklo_epi64(c0, c4));
+	_mm_storeu_si128((__m128i *)(d + 1 * dstStride), _mm_unpackhi_epi64(c0, c4));
+	_mm_storeu_si128((__m128i *)(d + 2 * dstStride), _mm_unpacklo_epi64(c1, c5));
+	_mm_storeu_si128((__m128i *)(d + 3 * dstStride), _mm_unpackhi_epi64(c1, c5));
+	_mm_storeu_si128((__m128i *)(d + 4 * dstStride), _mm_unpacklo_epi64(c2, c6));
+	_mm_storeu_si128((__m128i *)(d + 5 * dstStride), _mm_unpackhi_epi64(c2, c6));
+	_mm_storeu_si128((__m128i *)(d + 6 * dstStride), _mm_unpacklo_epi64(c3, c7));
+	_mm_storeu_si128((__m128i *)(d + 7 * dstStride), _mm_unpackhi_epi64(c3, c7));
+}
+
+static void TransposeTile32x4_SSE2(const void *src, ptrdiff_t srcStride, void *dst, ptrdiff_t dstStride)
+{
+	// Shuffles move bits untouched, so 32-bit integers ride in float registers
+	const float *s = (const float *)src;
+	float *d = (float *)dst;
+
+	__m128 r0 = _mm_loadu_ps(s + 0 * srcStride);
+	__m128 r1 = _mm_loadu_ps(s + 1 * srcStride);
+	__m128 r2 = _mm_loadu_ps(s + 2 * srcStride);
+	__m128 r3 = _mm_loadu_ps(s + 3 * srcStride);
+	_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+	_mm_storeu_ps(d + 0 * dstStride, r0);
+	_mm_storeu_ps(d + 1 * dstStride, r1);
+	_mm_storeu_ps(d + 2 * dstStride, r2);
+	_mm_storeu_ps(d + 3 * dstStride, r3);
+}
+
+SIMD_TARGET_AVX2
+static void TransposeTile32x8_AVX2(const void *src, ptrdiff_t srcStride, void *dst, ptrdiff_t dstStride)
+{
+	const float *s = (const float *)src;
+	float *d = (float *)dst;
+
+	__m256 r0 = _mm256_loadu_ps(s + 0 * srcStride);
+	__m256 r1 = _mm256_loadu_ps(s + 1 * srcStride);
+	__m256 r2 = _mm256_loadu_ps(s + 2 * srcStride);
+	__m256 r3 = _mm256_loadu_ps(s + 3 * srcStride);
+	__m256 r4 = _mm256_loadu_ps(s + 4 * srcStride);
+	__m256 r5 = _mm256_loadu_ps(s + 5 * srcStride);
+	__m256 r6 = _mm256_loadu_ps(s + 6 * srcStride);
+	__m256 r7 = _mm256_loadu_ps(s + 7 * srcStride);
+
+	__m256 t0 = _mm256_unpacklo_ps(r0, r1);
+	__m256 t1 = _mm256_unpackhi_ps(r0, r1);
+	__m256 t2 = _mm256_unpacklo_ps(r2, r3);
+	__m256 t3 = _mm256_unpackhi_ps(r2, r3);
+	__m256 t4 = _mm256_unpacklo_ps(r4, r5);
+	__m256 t5 = _mm256_unpackhi_ps(r4, r5);
+	__m256 t6 = _mm256_unpacklo_ps(r6, r7);
+	__m256 t7 = _mm256_unpackhi_ps(r6, r7);
+
+	__m256 u0 = _mm256_shuffle_ps(t0, t2, 0x44);
+	__m256 u1 = _mm256_shuffle_ps(t0, t2, 0xEE);
+	__m256 u2 = _mm256_shuffle_ps(t1, t3, 0x44);
+	__m256 u3 = _mm256_shuffle_ps(t1, t3, 0xEE);
+	__m256 u4 = _mm256_shuffle_ps(t4, t6, 0x44);
+	__m256 u5 = _mm256_shuffle_ps(t4, t6, 0xEE);
+	__m256 u6 = _mm256_shuffle_ps(t5, t7, 0x44);
+	__m256 u7 = _mm256_shuffle_ps(t5, t7, 0xEE);
+
+	_mm256_storeu_ps(d + 0 * dstStride, _mm256_permute2f128_ps(u0, u4, 0x20));
+	_mm256_storeu_ps(d + 1 * dstStride, _mm256_permute2f128_ps(u1, u5, 0x20));
+	_mm256_storeu_ps(d + 2 * dstStride, _mm256_permute2f128_ps(u2, u6, 0x20));
+	_mm256_storeu_ps(d + 3 * dstStride, _mm256_permute2f128_ps(u3, u7, 0x20));
+	_mm256_storeu_ps(d + 4 * dstStride, _mm256_permute2f128_ps(u0, u4, 0x31));
+	_mm256_storeu_ps(d + 5 * dstStride, _mm256_permute2f128_ps(u1, u5, 0x31));
+	_mm256_storeu_ps(d + 6 * dstStride, _mm256_permute2f128_ps(u2, u6, 0x31));
+	_mm256_storeu_ps(d + 7 * dstStride, _mm256_permute2f128_ps(u3, u7, 0x31));
+}
+#endif
+
+// Pick the widest tile kernel for the element size
+template <typename T>
+static TileKernel SelectTileKernel(int *pTile)
+{
+#if SIMD_X86
+	SimdLevel level = GetSimdLevel();
+	if (sizeof(T) == 2 && level >= SIMD_SSE2) {
+		*pTile = 8;
+		return TransposeTile16x8_SSE2;
+	}
+	if (sizeof(T) == 4 && level >= SIMD_AVX2) {
+		*pTile = 8;
+		return TransposeTile32x8_AVX2;
+	}
+	if (sizeof(T) == 4 && level >= SIMD_SSE2) {
+		*pTile = 4;
+		return TransposeTile32x4_SSE2;
+	}
+#endif
+	*pTile = 8;
+	return TransposeTileScalar<T, 8>;
+}
+
+//------------------------------------------------------------------------------
+// Row reversal, used by the horizontal flip and the 180 degree rotation
+//------------------------------------------------------------------------------
+
+#if SIMD_X86
+static inline __m128i Reverse16_SSE2(__m128i v)
+{
+	v = _mm_shufflelo_epi16(v, 0x1B);
+	v = _mm_shufflehi_epi16(v, 0x1B);
+	return _mm_shuffle_epi32(v, 0x4E);
+}
+
+static inline __m128i Reverse32_SSE2(__m128i v)
+{
+	return _mm_shuffle_epi32(v, 0x1B);
+}
+
+template <typename T>
+static inline __m128i ReverseVector(__m128i v)
+{
+	return sizeof(T) == 2 ? Reverse16_SSE2(v) : Reverse32_SSE2(v);
+}
+#endif
+
+// dst[i] = src[n - 1 - i], src and dst must not overlap
+template <typename T>
+static void ReverseCopy(const T *src, T *dst, int n)
+{
+	int i = 0;
+#if SIMD_X86
+	const int lanes = 16 / sizeof(T);
+	for (; i + lanes <= n; i += lanes) {
+		__m128i v = _mm_loadu_si128((const __m128i *)(src + n - i - lanes));
+		_mm_storeu_si128((__m128i *)(dst + i), ReverseVector<T>(v));
+	}
+#endif
+	for (; i < n; i++)
+		dst[i] = src[n - 1 - i];
+}
+
+template <typename T>
+static void ReverseInPlace(T *p, int n)
+{
+	int lo = 0;
+	int hi = n;
+#if SIMD_X86
+	const int lanes = 16 / sizeof(T);
+	for (; hi - lo >= 2 * lanes; lo += lanes, hi -= lanes) {
+		__m128i a = _mm_loadu_si128((const __m128i *)(p + lo));
+		__m128i b = _mm_loadu_si128((const __m128i *)(p + hi - lanes));
+		_mm_storeu_si128((__m128i *)(p + lo), ReverseVector<T>(b));
+		_mm_storeu_si128((__m128i *)(p + hi - lanes), ReverseVector<T>(a));
+	}
+#endif
+	std::reverse(p + lo, p + hi);
+}
+
+//------------------------------------------------------------------------------
+// Operations
+//------------------------------------------------------------------------------
+
+// Destination index of source pixel (x, y) for the transposing operations
+static inline size_t TransposedIndex(FrameOrientation op, int x, int y, int width, int height)
+{
+	switch (op) {
+	case ORIENT_ROTATE_90_CW:
+		return (size_t)x * height + (height - 1 - y);
+	case ORIENT_ROTATE_90_ACW:
+		return (size_t)(width - 1 - x) * height + y;
+	default:
+		return (size_t)x * height + y;
+	}
+}
+
+template <typename T>
+static void TransposeLike(const T *src, T *dst, int width, int height, FrameOrientation op)
+{
+	int tile;
+	TileKernel kernel = SelectTileKernel<T>(&tile);
+	int fullW = width - width % tile;
+	int fullH = height - height % tile;
+
+	for (int by = 0; by < fullH; by += kBlock) {
+		int byEnd = std::min(by + kBlock, fullH);
+		for (int bx = 0; bx < fullW; bx += kBlock) {
+			int bxEnd = std::min(bx + kBlock, fullW);
+			for (int y0 = by; y0 < byEnd; y0 += tile) {
+				for (int x0 = bx; x0 < bxEnd; x0 += tile) {
+					switch (op) {
+					case ORIENT_ROTATE_90_CW:
+						kernel(src + (size_t)(y0 + tile - 1) * width + x0, -(ptrdiff_t)width,
+							dst + (size_t)x0 * height + (height - tile - y0), height);
+						break;
+					case ORIENT_ROTATE_90_ACW:
+						kernel(src + (size_t)y0 * width + x0, width,
+							dst + (size_t)(width - 1 - x0) * height + y0, -(ptrdiff_t)height);
+						break;
+					default:
+						kernel(src + (size_t)y0 * width + x0, width,
+							dst + (size_t)x0 * height + y0, height);
+						break;
+					}
+				}
+			}
+		}
+	}
+
+	// Right-hand columns and top rows that do not fill a whole tile
+	for (int y = 0; y < height; y++) {
+		int x = (y < fullH) ? fullW : 0;
+		for (; x < width; x++)
+			dst[TransposedIndex(op, x, y, width, height)] = src[(size_t)y * width + x];
+	}
+}
+
+template <typename T>
+static void TransposeSquareInPlace(T *p, int n)
+{
+	int tile;
+	TileKernel kernel = SelectTileKernel<T>(&tile);
+	int full = n - n % tile;
+	T a[8 * 8];
+
+	for (int y0 = 0; y0 < full; y0 += tile) {
+		for (int x0 = y0; x0 < full; x0 += tile) {
+			T *upper = p + (size_t)y0 * n + x0;
+			T *lower = p + (size_t)x0 * n + y0;
+			kernel(upper, n, a, tile);
+			if (x0 != y0)
+				kernel(lower, n, upper, n);
+			for (int r = 0; r < tile; r++)
+				memcpy(lower + (size_t)r * n, a + r * tile, tile * sizeof(T));
+		}
+	}
+	for (int x = full; x < n; x++)
+		for (int y = 0; y < x; y++)
+			std::swap(p[(size_t)y * n + x], p[(size_t)x * n + y]);
+}
+
+template <typename T>
+static void FlipVertical(const T *src, T *dst, int width, int height)
+{
+	size_t rowBytes = (size_t)width * sizeof(T);
+	if (src == dst) {
+		for (int y = 0; y < height / 2; y++)
+			std::swap_ranges(dst + (size_t)y * width, dst + (size_t)(y + 1) * width,
+				dst + (size_t)(height - 1 - y) * width);
+	}
+	else {
+		for (int y = 0; y < height; y++)
+			memcpy(dst + (size_t)(height - 1 - y) * width, src + (size_t)y * width, rowBytes);
+	}
+}
+
+template <typename T>
+static void FlipHorizontal(const T *src, T *dst, int width, int height)
+{
+	for (int y = 0; y < height; y++) {
+		if (src == dst)
+			ReverseInPlace(dst + (size_t)y * width, width);
+		else
+			ReverseCopy(src + (size_t)y * width, dst + (size_t)y * width, width);
+	}
+}
+
+template <typename T>
+static unsigned int OrientFrameT(const T *src, T *dst, int width, int height, FrameOrientation op)
+{
+	if (src == NULL)
+		return DRV_P1INVALID;
+	if (dst == NULL)
+		return DRV_P2INVALID;
+	if (width <= 0)
+		return DRV_P3INVALID;
+	if (height <= 0)
+		return DRV_P4INVALID;
+
+	bool inPlace = (src == dst);
+	size_t pixels = (size_t)width * height;
+
+	switch (op) {
+	case ORIENT_NONE:
+		if (!inPlace)
+			memcpy(dst, src, pixels * sizeof(T));
+		break;
+	case ORIENT_FLIP_HORIZONTAL:
+		FlipHorizontal(src, dst, width, height);
+		break;
+	case ORIENT_FLIP_VERTICAL:
+		FlipVertical(src, dst, width, height);
+		break;
+	case ORIENT_ROTATE_180:
+		// The frame is contiguous, so a 180 degree turn is one long reversal
+		if (inPlace)
+			ReverseInPlace(dst, (int)pixels);
+		else
+			ReverseCopy(src, dst, (int)pixels);
+		break;
+	case ORIENT_TRANSPOSE:
+	case ORIENT_ROTATE_90_CW:
+	case ORIENT_ROTATE_90_ACW:
+		if (!inPlace) {
+			TransposeLike(src, dst, width, height, op);
+			break;
+		}
+		if (width != height)
+			return DRV_P2INVALID;
+		TransposeSquareInPlace(dst, width);
+		if (op == ORIENT_ROTATE_90_CW)
+			FlipHorizontal(dst, dst, width, height);
+		else if (op == ORIENT_ROTATE_90_ACW)
+			FlipVertical(dst, dst, width, height);
+		break;
+	default:
+		return DRV_P5INVALID;
+	}
+	return DRV_SUCCESS;
+}
+
+template <typename T>
+static unsigned int OrientFrameNaiveT(const T *src, T *dst, int width, int height, FrameOrientation op)
+{
+	if (src == NULL)
+		return DRV_P1INVALID;
+	if (dst == NULL || dst == src)
+		return DRV_P2INVALID;
+	if (width <= 0)
+		return DRV_P3INVALID;
+	if (height <= 0)
+		return DRV_P4INVALID;
+
+	for (int y = 0; y < height; y++) {
+		for (int x = 0; x < width; x++) {
+			size_t to;
+			switch (op) {
+			case ORIENT_NONE:
+				to = (size_t)y * width + x;
+				break;
+			case ORIENT_FLIP_HORIZONTAL:
+				to = (size_t)y * width + (width - 1 - x);
+				break;
+			case ORIENT_FLIP_VERTICAL:
+				to = (size_t)(height - 1 - y) * width + x;
+				break;
+			case ORIENT_ROTATE_180:
+				to = (size_t)(height - 1 - y) * width + (width - 1 - x);
+				break;
+			case ORIENT_TRANSPOSE:
+			case ORIENT_ROTATE_90_CW:
+			case ORIENT_ROTATE_90_ACW:
+				to = TransposedIndex(op, x, y, width, height);
+				break;
+			default:
+				return DRV_P5INVALID;
+			}
+			dst[to] = src[(size_t)y * width + x];
+		}
+	}
+	return DRV_SUCCESS;
+}
+
+void GetOrientedSize(FrameOrientation op, int width, int height, int *pWidth, int *pHeight)
+{
+	bool swap = (op == ORIENT_TRANSPOSE || op == ORIENT_ROTATE_90_CW || op == ORIENT_ROTATE_90_ACW);
+	*pWidth = swap ? height : width;
+	*pHeight = swap ? width : height;
+}
+
+unsigned int OrientFrame(const uint16_t *src, uint16_t *dst, int width, int height, FrameOrientation op)
+{
+	return OrientFrameT(src, dst, width, height, op);
+}
+
+unsigned int OrientFrame(const uint32_t *src, uint32_t *dst, int width, int height, FrameOrientation op)
+{
+	return OrientFrameT(src, dst, width, height, op);
+}
+
+unsigned int OrientFrame(const float *src, float *dst, int width, int height, FrameOrientation op)
+{
+	return OrientFrameT(src, dst, width, height, op);
+}
+
+unsigned int OrientFrameNaive(const uint16_t *src, uint16_t *dst, int width, int height, FrameOrientation op)
+{
+	return OrientFrameNaiveT(src, dst, width, height, op);
+}
+
+unsigned int OrientFrameNaive(const uint32_t *src, uint32_t *dst, int width, int height, FrameOrientation op)
+{
+	return OrientFrameNaiveT(src, dst, width, height, op);
+}
+
+unsigned int OrientFrameNaive(const float *src, float *dst, int width, int height, FrameOrientation op)
+{
+	return OrientFrameNaiveT(src, dst, width, height, op);
+}
@@ -0,0 +1,40 @@
+// FrameOrientation.h : Host-side rotate, flip and transpose of acquired frames.
+//
+// Replaces SetImageRotate()/SetImageFlip() in the driver with kernels whose cost
+// we can measure, and adds a plain transpose for spectral code that wants the
+// data column-major. Frames are processed in cache-sized blocks of SIMD tiles
+// that are transposed in registers.
+//
+// src and dst may be the same buffer for the flips and the 180 degree rotation,
+// and for the 90 degree rotations and transpose when the frame is square.
+
+#pragma once
+
+#include <stdint.h>
+
+extern "C" {
+	#include "atmcd32d.h"
+}
+
+enum FrameOrientation {
+	ORIENT_NONE = 0,
+	ORIENT_FLIP_HORIZONTAL,		// SetImageFlip(1, 0)
+	ORIENT_FLIP_VERTICAL,		// SetImageFlip(0, 1)
+	ORIENT_ROTATE_90_CW,		// SetImageRotate(1)
+	ORIENT_ROTATE_180,
+	ORIENT_ROTATE_90_ACW,		// SetImageRotate(2)
+	ORIENT_TRANSPOSE			// row-major to column-major
+};
+
+// Size of the frame produced by op from a width x height source
+void GetOrientedSize(FrameOrientation op, int width, int height, int *pWidth, int *pHeight);
+
+unsigned int OrientFrame(const uint16_t *src, uint16_t *dst, int width, int height, FrameOrientation op);
+unsigned int OrientFrame(const uint32_t *src, uint32_t *dst, int width, int height, FrameOrientation op);
+unsigned int OrientFrame(const float *src, float *dst, int width, int height, FrameOrientation op);
+
+// Straightforward per-pixel versions (out of place only), kept as the
+// reference the tiled kernels are checked and benchmarked against
+unsigned int OrientFrameNaive(const uint16_t *src, uint16_t *dst, int width, int height, FrameOrientation op);
+unsigned int OrientFrameNaive(const uint32_t *src, uint32_t *dst, int width, int height, FrameOrientation op);
+unsigned int OrientFrameNaive(const float *src, float *dst, int width, int height, FrameOrientation op);
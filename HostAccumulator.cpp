@@ -0,0 +1,300 @@
+// HostAccumulator.cpp : Host-side accumulate mode for long sums of short frames.
+//
+
+#include "stdafx.h"
+#include "HostAccumulator.h"
+#include "SimdSupport.h"
+
+#include <string.h>
+#include <algorithm>
+
+//------------------------------------------------------------------------------
+// Widening add kernels. Each returns the largest pixel of the frame, which
+// feeds the overflow bound for the 32-bit accumulators.
+//------------------------------------------------------------------------------
+
+static WORD AddTo32Scalar(const WORD *src, uint32_t *sum, size_t begin, size_t n)
+{
+	WORD peak = 0;
+	for (size_t i = begin; i < n; i++) {
+		sum[i] += src[i];
+		peak = std::max(peak, src[i]);
+	}
+	return peak;
+}
+
+static WORD AddTo64Scalar(const WORD *src, uint64_t *sum, size_t begin, size_t n)
+{
+	WORD peak = 0;
+	for (size_t i = begin; i < n; i++) {
+		sum[i] += src[i];
+		peak = std::max(peak, src[i]);
+	}
+	return peak;
+}
+
+#if SIMD_X86
+static WORD AddTo32_SSE2(const WORD *src, uint32_t *sum, size_t n)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i bias = _mm_set1_epi16((short)0x8000);	// SSE2 has only a signed 16-bit max
+	__m128i peak = _mm_set1_epi16((short)0x8000);
+	size_t i = 0;
+	for (; i + 8 <= n; i += 8) {
+		__m128i v = _mm_loadu_si128((const __m128i *)(src + i));
+		peak = _mm_max_epi16(peak, _mm_xor_si128(v, bias));
+		__m128i s0 = _mm_loadu_si128((const __m128i *)(sum + i));
+		__m128i s1 = _mm_loadu_si128((const __m128i *)(sum + i + 4));
+		_mm_storeu_si128((__m128i *)(sum + i), _mm_add_epi32(s0, _mm_unpacklo_epi16(v, zero)));
+		_mm_storeu_si128((__m128i *)(sum + i + 4), _mm_add_epi32(s1, _mm_unpackhi_epi16(v, zero)));
+	}
+	WORD lanes[8];
+	_mm_storeu_si128((__m128i *)lanes, _mm_xor_si128(peak, bias));
+	WORD result = AddTo32Scalar(src, sum, i, n);
+	for (int k = 0; k < 8; k++)
+		result = std::max(result, lanes[k]);
+	return result;
+}
+
+SIMD_TARGET_AVX2
+static WORD AddTo32_AVX2(const WORD *src, uint32_t *sum, size_t n)
+{
+	__m256i peak = _mm256_setzero_si256();
+	size_t i = 0;
+	for (; i + 16 <= n; i += 16) {
+		__m256i v = _mm256_loadu_si256((const __m256i *)(src + i));
+		peak = _mm256_max_epu16(peak, v);
+		__m256i lo = _mm256_cvtepu16_epi32(_mm256_castsi256_si128(v));
+		__m256i hi = _mm256_cvtepu16_epi32(_mm256_extracti128_si256(v, 1));
+		__m256i s0 = _mm256_loadu_si256((const __m256i *)(sum + i));
+		__m256i s1 = _mm256_loadu_si256((const __m256i *)(sum + i + 8));
+		_mm256_storeu_si256((__m256i *)(sum + i), _mm256_add_epi32(s0, lo));
+		_mm256_storeu_si256((__m256i *)(sum + i + 8), _mm256_add_epi32(s1, hi));
+	}
+	WORD lanes[16];
+	_mm256_storeu_si256((__m256i *)lanes, peak);
+	WORD result = AddTo32Scalar(src, sum, i, n);
+	for (int k = 0; k < 16; k++)
+		result = std::max(result, lanes[k]);
+	return result;
+}
+
+SIMD_TARGET_AVX2
+static WORD AddTo64_AVX2(const WORD *src, uint64_t *sum, size_t n)
+{
+	__m256i peak = _mm256_setzero_si256();
+	size_t i = 0;
+	for (; i + 16 <= n; i += 16) {
+		__m256i v = _mm256_loadu_si256((const __m256i *)(src + i));
+		peak = _mm256_max_epu16(peak, v);
+		__m128i lo = _mm256_castsi256_si128(v);
+		__m128i hi = _mm256_extracti128_si256(v, 1);
+		__m256i w0 = _mm256_cvtepu16_epi64(lo);
+		__m256i w1 = _mm256_cvtepu16_epi64(_mm_srli_si128(lo, 8));
+		__m256i w2 = _mm256_cvtepu16_epi64(hi);
+		__m256i w3 = _mm256_cvtepu16_epi64(_mm_srli_si128(hi, 8));
+		uint64_t *s = sum + i;
+		_mm256_storeu_si256((__m256i *)(s + 0), _mm256_add_epi64(_mm256_loadu_si256((const __m256i *)(s + 0)), w0));
+		_mm256_storeu_si256((__m256i *)(s + 4), _mm256_add_epi64(_mm256_loadu_si256((const __m256i *)(s + 4)), w1));
+		_mm256_storeu_si256((__m256i *)(s + 8), _mm256_add_epi64(_mm256_loadu_si256((const __m256i *)(s + 8)), w2));
+		_mm256_storeu_si256((__m256i *)(s + 12), _mm256_add_epi64(_mm256_loadu_si256((const __m256i *)(s + 12)), w3));
+	}
+	WORD lanes[16];
+	_mm256_storeu_si256((__m256i *)lanes, peak);
+	WORD result = AddTo64Scalar(src, sum, i, n);
+	for (int k = 0; k < 16; k++)
+		result = std::max(result, lanes[k]);
+	return result;
+}
+#endif
+
+static WORD AddTo32(const WORD *src, uint32_t *sum, size_t n)
+{
+#if SIMD_X86
+	SimdLevel level = GetSimdLevel();
+	if (level >= SIMD_AVX2)
+		return AddTo32_AVX2(src, sum, n);
+	if (level >= SIMD_SSE2)
+		return AddTo32_SSE2(src, sum, n);
+#endif
+	return AddTo32Scalar(src, sum, 0, n);
+}
+
+static WORD AddTo64(const WORD *src, uint64_t *sum, size_t n)
+{
+#if SIMD_X86
+	if (GetSimdLevel() >= SIMD_AVX2)
+		return AddTo64_AVX2(src, sum, n);
+#endif
+	return AddTo64Scalar(src, sum, 0, n);
+}
+
+//------------------------------------------------------------------------------
+// Window handling, all called with acc->lock held
+//------------------------------------------------------------------------------
+
+static void HaClearLive(HostAccumulator *acc)
+{
+	if (acc->wide) {
+		// Drop back to 32 bits for the next window, most never need more
+		acc->wide = false;
+		std::vector<uint64_t>().swap(acc->sum64);
+		acc->sum32.assign((size_t)acc->width * acc->height, 0);
+	}
+	else {
+		memset(acc->sum32.data(), 0, acc->sum32.size() * sizeof(uint32_t));
+	}
+	acc->bound = 0;
+	acc->frames = 0;
+}
+
+static void HaCopyLive(const HostAccumulator *acc, uint64_t *out)
+{
+	size_t pixels = (size_t)acc->width * acc->height;
+	if (acc->wide)
+		memcpy(out, acc->sum64.data(), pixels * sizeof(uint64_t));
+	else
+		std::copy(acc->sum32.begin(), acc->sum32.end(), out);
+}
+
+static void HaCloseLocked(HostAccumulator *acc)
+{
+	if (acc->frames == 0)
+		return;
+	if (acc->wide)
+		acc->completed.swap(acc->sum64);
+	else {
+		acc->completed.resize(acc->sum32.size());
+		HaCopyLive(acc, acc->completed.data());
+	}
+	acc->completedFrames = acc->frames;
+	acc->completedWindows++;
+	HaClearLive(acc);
+}
+
+static void HaWiden(HostAccumulator *acc)
+{
+	acc->sum64.assign(acc->sum32.begin(), acc->sum32.end());
+	std::vector<uint32_t>().swap(acc->sum32);
+	acc->wide = true;
+}
+
+//------------------------------------------------------------------------------
+// Public interface
+//------------------------------------------------------------------------------
+
+unsigned int HaInitialise(HostAccumulator *acc, int width, int height, int windowFrames, double windowSeconds)
+{
+	if (acc == NULL)
+		return DRV_P1INVALID;
+	if (width <= 0)
+		return DRV_P2INVALID;
+	if (height <= 0)
+		return DRV_P3INVALID;
+	if (windowFrames < 0)
+		return DRV_P4INVALID;
+	if (windowSeconds < 0.0)
+		return DRV_P5INVALID;
+
+	std::lock_guard<std::mutex> guard(acc->lock);
+	acc->width = width;
+	acc->height = height;
+	acc->windowFrames = windowFrames;
+	acc->windowSeconds = windowSeconds;
+	acc->wide = false;
+	acc->sum32.assign((size_t)width * height, 0);
+	std::vector<uint64_t>().swap(acc->sum64);
+	std::vector<uint64_t>().swap(acc->completed);
+	acc->bound = 0;
+	acc->frames = 0;
+	acc->firstTimestamp = 0.0;
+	acc->completedFrames = 0;
+	acc->completedWindows = 0;
+	return DRV_SUCCESS;
+}
+
+void HaReset(HostAccumulator *acc)
+{
+	std::lock_guard<std::mutex> guard(acc->lock);
+	HaClearLive(acc);
+	std::vector<uint64_t>().swap(acc->completed);
+	acc->completedFrames = 0;
+}
+
+unsigned int HaAddFrame(HostAccumulator *acc, const WORD *frame, double timestamp, bool *pClosed)
+{
+	if (acc == NULL || (acc->sum32.empty() && acc->sum64.empty()))
+		return DRV_P1INVALID;
+	if (frame == NULL)
+		return DRV_P2INVALID;
+
+	bool closed = false;
+	size_t pixels = (size_t)acc->width * acc->height;
+	std::lock_guard<std::mutex> guard(acc->lock);
+
+	// A time window covers [first, first + windowSeconds), so the frame that
+	// crosses the boundary starts the next window rather than ending this one
+	if (acc->windowSeconds > 0.0 && acc->frames > 0
+		&& timestamp - acc->firstTimestamp >= acc->windowSeconds) {
+		HaCloseLocked(acc);
+		closed = true;
+	}
+	if (acc->frames == 0)
+		acc->firstTimestamp = timestamp;
+
+	if (!acc->wide && acc->bound + 0xFFFF > 0xFFFFFFFFull)
+		HaWiden(acc);
+	WORD peak = acc->wide ? AddTo64(frame, acc->sum64.data(), pixels)
+		: AddTo32(frame, acc->sum32.data(), pixels);
+	acc->bound += peak;
+	acc->frames++;
+
+	if (acc->windowFrames > 0 && acc->frames >= acc->windowFrames) {
+		HaCloseLocked(acc);
+		closed = true;
+	}
+	if (pClosed)
+		*pClosed = closed;
+	return DRV_SUCCESS;
+}
+
+unsigned int HaCloseWindow(HostAccumulator *acc)
+{
+	if (acc == NULL)
+		return DRV_P1INVALID;
+	std::lock_guard<std::mutex> guard(acc->lock);
+	if (acc->frames == 0)
+		return DRV_NO_NEW_DATA;
+	HaCloseLocked(acc);
+	return DRV_SUCCESS;
+}
+
+unsigned int HaGetPartialSum(HostAccumulator *acc, uint64_t *sum, int *pFrames)
+{
+	if (acc == NULL)
+		return DRV_P1INVALID;
+	if (sum == NULL)
+		return DRV_P2INVALID;
+	std::lock_guard<std::mutex> guard(acc->lock);
+	if (pFrames)
+		*pFrames = acc->frames;
+	if (acc->frames == 0)
+		return DRV_NO_NEW_DATA;
+	HaCopyLive(acc, sum);
+	return DRV_SUCCESS;
+}
+
+unsigned int HaGetCompletedSum(HostAccumulator *acc, uint64_t *sum, int *pFrames)
+{
+	if (acc == NULL)
+		return DRV_P1INVALID;
+	if (sum == NULL)
+		return DRV_P2INVALID;
+	std::lock_guard<std::mutex> guard(acc->lock);
+	if (pFrames)
+		*pFrames = acc->completedFrames;
+	if (acc->completed.empty())
+		return DRV_NO_NEW_DATA;
+	memcpy(sum, acc->completed.data(), acc->completed.size() * sizeof(uint64_t));
+	return DRV_SUCCESS;
+}
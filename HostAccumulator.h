@@ -0,0 +1,60 @@
+// HostAccumulator.h : Host-side accumulate mode for long sums of short frames.
+//
+// Acquisition mode 2 accumulates in the camera and is limited by
+// SetNumberAccumulations(). This stage sums 16-bit frames on the host instead,
+// into 32-bit accumulators that are widened to 64 bits once the running bound
+// on the sum could overflow, so thousands of frames sum without saturating.
+//
+// A window closes after a number of frames, after a span of frame time, or
+// never; the closed sum is kept for collection while the next window starts.
+// The sum so far can be read at any time from another thread without stopping
+// the acquisition.
+
+#pragma once
+
+#include <stdint.h>
+#include <mutex>
+#include <vector>
+
+extern "C" {
+	#include "atmcd32d.h"
+}
+
+struct HostAccumulator {
+	int						width;
+	int						height;
+	int						windowFrames;		// close after this many frames, 0 for no limit
+	double					windowSeconds;		// close after this span of timestamps, 0 for no limit
+
+	bool					wide;				// live sum is in sum64 rather than sum32
+	uint64_t				bound;				// upper bound on any pixel of the live sum
+	std::vector<uint32_t>	sum32;
+	std::vector<uint64_t>	sum64;
+	int						frames;				// frames in the live window
+	double					firstTimestamp;
+
+	std::vector<uint64_t>	completed;			// last closed window
+	int						completedFrames;
+	int						completedWindows;	// windows closed since initialisation
+
+	std::mutex				lock;				// held while a frame is added or a sum read
+};
+
+unsigned int HaInitialise(HostAccumulator *acc, int width, int height, int windowFrames, double windowSeconds);
+
+// Adds a frame stamped with the acquisition time in seconds. *pClosed (may be
+// NULL) is set when the frame completed a window.
+unsigned int HaAddFrame(HostAccumulator *acc, const WORD *frame, double timestamp, bool *pClosed);
+
+// Copies the live sum without disturbing it. Returns DRV_NO_NEW_DATA when no
+// frame has been added to the live window yet.
+unsigned int HaGetPartialSum(HostAccumulator *acc, uint64_t *sum, int *pFrames);
+
+// Copies the most recently closed window. Returns DRV_NO_NEW_DATA when none
+// has closed yet.
+unsigned int HaGetCompletedSum(HostAccumulator *acc, uint64_t *sum, int *pFrames);
+
+// Closes the live window now, whatever its size
+unsigned int HaCloseWindow(HostAccumulator *acc);
+
+void HaReset(HostAccumulator *acc);
@@ -0,0 +1,374 @@
+// PixelKernels.h : Header-only pixel kernels specialised on pixel type, row width and bin factor.
+//
+// Each kernel is written once as a template over an Ops type (the vector
+// operations for one pixel type on one instruction set), the pixel type, and
+// optionally the row width W and square bin factor B as compile-time
+// constants. With W and B known the compiler sees constant trip counts and
+// unrolls the inner loops completely; W = 0 or B = 0 take them from the
+// arguments instead.
+//
+// PkSelect<T>(width, hbin, vbin) picks, once per configuration, the highest
+// instruction set the machine supports and the instantiation for the known
+// detector widths (512, 1024, 2048) and bin factors (2, 4) when they match,
+// falling back to the runtime-geometry instantiation otherwise. Stages keep
+// the returned PkKernels<T> and call through it per frame.
+//
+// Unsigned pixel types saturate on add and clamp at zero on subtract, like
+// on-chip binning; float pixels add and subtract plainly.
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <limits>
+
+#include "SimdSupport.h"
+
+//------------------------------------------------------------------------------
+// Vector operations per pixel type and instruction set
+//------------------------------------------------------------------------------
+
+SIMD_BEGIN_KERNELS
+
+template <typename T>
+struct PkScalarOps {
+	typedef T V;
+	enum { kLanes = 1 };
+	static SIMD_INLINE V Load(const T *p) { return *p; }
+	static SIMD_INLINE void Store(T *p, V v) { *p = v; }
+	static SIMD_INLINE V Min(V a, V b) { return a < b ? a : b; }
+	static SIMD_INLINE V Max(V a, V b) { return a < b ? b : a; }
+	static SIMD_INLINE V AddSat(V a, V b) { V s = (V)(a + b); return s < a ? std::numeric_limits<T>::max() : s; }
+	static SIMD_INLINE V SubSat(V a, V b) { return a > b ? (V)(a - b) : (V)0; }
+};
+
+template <> SIMD_INLINE float PkScalarOps<float>::AddSat(float a, float b) { return a + b; }
+template <> SIMD_INLINE float PkScalarOps<float>::SubSat(float a, float b) { return a - b; }
+
+#if SIMD_X86
+#if defined(__GNUC__) && !defined(__clang__)
+// GCC flags the _mm512_undefined_* placeholders inside its own AVX-512 headers;
+// popped again after the instantiations below
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+template <typename T> struct PkSse42Ops;
+template <typename T> struct PkAvx2Ops;
+template <typename T> struct PkAvx512Ops;
+
+template <>
+struct PkSse42Ops<uint16_t> {
+	typedef __m128i V;
+	enum { kLanes = 8 };
+	static SIMD_TARGET_SSE42 SIMD_INLINE V Load(const uint16_t *p) { return _mm_loadu_si128((const __m128i *)p); }
+	static SIMD_TARGET_SSE42 SIMD_INLINE void Store(uint16_t *p, V v) { _mm_storeu_si128((__m128i *)p, v); }
+	static SIMD_TARGET_SSE42 SIMD_INLINE V Min(V a, V b) { return _mm_min_epu16(a, b); }
+	static SIMD_TARGET_SSE42 SIMD_INLINE V Max(V a, V b) { return _mm_max_epu16(a, b); }
+	static SIMD_TARGET_SSE42 SIMD_INLINE V AddSat(V a, V b) { return _mm_adds_epu16(a, b); }
+	static SIMD_TARGET_SSE42 SIMD_INLINE V SubSat(V a, V b) { return _mm_subs_epu16(a, b); }
+};
+
+template <>
+struct PkSse42Ops<uint32_t> {
+	typedef __m128i V;
+	enum { kLanes = 4 };
+	static SIMD_TARGET_SSE42 SIMD_INLINE V Load(const uint32_t *p) { return _mm_loadu_si128((const __m128i *)p); }
+	static SIMD_TARGET_SSE42 SIMD_INLINE void Store(uint32_t *p, V v) { _mm_storeu_si128((__m128i *)p, v); }
+	static SIMD_TARGET_SSE42 SIMD_INLINE V Min(V a, V b) { return _mm_min_epu32(a, b); }
+	static SIMD_TARGET_SSE42 SIMD_INLINE V Max(V a, V b) { return _mm_max_epu32(a, b); }
+	// No saturating 32-bit add: a + min(b, ~a) stops at 0xFFFFFFFF
+	static SIMD_TARGET_SSE42 SIMD_INLINE V AddSat(V a, V b) { return _mm_add_epi32(a, _mm_min_epu32(b, _mm_xor_si128(a, _mm_set1_epi32(-1)))); }
+	static SIMD_TARGET_SSE42 SIMD_INLINE V SubSat(V a, V b) { return _mm_sub_epi32(a, _mm_min_epu32(a, b)); }
+};
+
+template <>
+struct PkSse42Ops<float> {
+	typedef __m128 V;
+	enum { kLanes = 4 };
+	static SIMD_TARGET_SSE42 SIMD_INLINE V Load(const float *p) { return _mm_loadu_ps(p); }
+	static SIMD_TARGET_SSE42 SIMD_INLINE void Store(float *p, V v) { _mm_storeu_ps(p, v); }
+	static SIMD_TARGET_SSE42 SIMD_INLINE V Min(V a, V b) { return _mm_min_ps(a, b); }
+	static SIMD_TARGET_SSE42 SIMD_INLINE V Max(V a, V b) { return _mm_max_ps(a, b); }
+	static SIMD_TARGET_SSE42 SIMD_INLINE V AddSat(V a, V b) { return _mm_add_ps(a, b); }
+	static SIMD_TARGET_SSE42 SIMD_INLINE V SubSat(V a, V b) { return _mm_sub_ps(a, b); }
+};
+
+template <>
+struct PkAvx2Ops<uint16_t> {
+	typedef __m256i V;
+	enum { kLanes = 16 };
+	static SIMD_TARGET_AVX2 SIMD_INLINE V Load(const uint16_t *p) { return _mm256_loadu_si256((const __m256i *)p); }
+	static SIMD_TARGET_AVX2 SIMD_INLINE void Store(uint16_t *p, V v) { _mm256_storeu_si256((__m256i *)p, v); }
+	static SIMD_TARGET_AVX2 SIMD_INLINE V Min(V a, V b) { return _mm256_min_epu16(a, b); }
+	static SIMD_TARGET_AVX2 SIMD_INLINE V Max(V a, V b) { return _mm256_max_epu16(a, b); }
+	static SIMD_TARGET_AVX2 SIMD_INLINE V AddSat(V a, V b) { return _mm256_adds_epu16(a, b); }
+	static SIMD_TARGET_AVX2 SIMD_INLINE V SubSat(V a, V b) { return _mm256_subs_epu16(a, b); }
+};
+
+template <>
+struct PkAvx2Ops<uint32_t> {
+	typedef __m256i V;
+	enum { kLanes = 8 };
+	static SIMD_TARGET_AVX2 SIMD_INLINE V Load(const uint32_t *p) { return _mm256_loadu_si256((const __m256i *)p); }
+	static SIMD_TARGET_AVX2 SIMD_INLINE void Store(uint32_t *p, V v) { _mm256_storeu_si256((__m256i *)p, v); }
+	static SIMD_TARGET_AVX2 SIMD_INLINE V Min(V a, V b) { return _mm256_min_epu32(a, b); }
+	static SIMD_TARGET_AVX2 SIMD_INLINE V Max(V a, V b) { return _mm256_max_epu32(a, b); }
+	static SIMD_TARGET_AVX2 SIMD_INLINE V AddSat(V a, V b) { return _mm256_add_epi32(a, _mm256_min_epu32(b, _mm256_xor_si256(a, _mm256_set1_epi32(-1)))); }
+	static SIMD_TARGET_AVX2 SIMD_INLINE V SubSat(V a, V b) { return _mm256_sub_epi32(a, _mm256_min_epu32(a, b)); }
+};
+
+template <>
+struct PkAvx2Ops<float> {
+	typedef __m256 V;
+	enum { kLanes = 8 };
+	static SIMD_TARGET_AVX2 SIMD_INLINE V Load(const float *p) { return _mm256_loadu_ps(p); }
+	static SIMD_TARGET_AVX2 SIMD_INLINE void Store(float *p, V v) { _mm256_storeu_ps(p, v); }
+	static SIMD_TARGET_AVX2 SIMD_INLINE V Min(V a, V b) { return _mm256_min_ps(a, b); }
+	static SIMD_TARGET_AVX2 SIMD_INLINE V Max(V a, V b) { return _mm256_max_ps(a, b); }
+	static SIMD_TARGET_AVX2 SIMD_INLINE V AddSat(V a, V b) { return _mm256_add_ps(a, b); }
+	static SIMD_TARGET_AVX2 SIMD_INLINE V SubSat(V a, V b) { return _mm256_sub_ps(a, b); }
+};
+
+template <>
+struct PkAvx512Ops<uint16_t> {
+	typedef __m512i V;
+	enum { kLanes = 32 };
+	static SIMD_TARGET_AVX512 SIMD_INLINE V Load(const uint16_t *p) { return _mm512_loadu_si512((const void *)p); }
+	static SIMD_TARGET_AVX512 SIMD_INLINE void Store(uint16_t *p, V v) { _mm512_storeu_si512((void *)p, v); }
+	static SIMD_TARGET_AVX512 SIMD_INLINE V Min(V a, V b) { return _mm512_min_epu16(a, b); }
+	static SIMD_TARGET_AVX512 SIMD_INLINE V Max(V a, V b) { return _mm512_max_epu16(a, b); }
+	static SIMD_TARGET_AVX512 SIMD_INLINE V AddSat(V a, V b) { return _mm512_adds_epu16(a, b); }
+	static SIMD_TARGET_AVX512 SIMD_INLINE V SubSat(V a, V b) { return _mm512_subs_epu16(a, b); }
+};
+
+template <>
+struct PkAvx512Ops<uint32_t> {
+	typedef __m512i V;
+	enum { kLanes = 16 };
+	static SIMD_TARGET_AVX512 SIMD_INLINE V Load(const uint32_t *p) { return _mm512_loadu_si512((const void *)p); }
+	static SIMD_TARGET_AVX512 SIMD_INLINE void Store(uint32_t *p, V v) { _mm512_storeu_si512((void *)p, v); }
+	static SIMD_TARGET_AVX512 SIMD_INLINE V Min(V a, V b) { return _mm512_min_epu32(a, b); }
+	static SIMD_TARGET_AVX512 SIMD_INLINE V Max(V a, V b) { return _mm512_max_epu32(a, b); }
+	static SIMD_TARGET_AVX512 SIMD_INLINE V AddSat(V a, V b) { return _mm512_add_epi32(a, _mm512_min_epu32(b, _mm512_xor_si512(a, _mm512_set1_epi32(-1)))); }
+	static SIMD_TARGET_AVX512 SIMD_INLINE V SubSat(V a, V b) { return _mm512_sub_epi32(a, _mm512_min_epu32(a, b)); }
+};
+
+template <>
+struct PkAvx512Ops<float> {
+	typedef __m512 V;
+	enum { kLanes = 16 };
+	static SIMD_TARGET_AVX512 SIMD_INLINE V Load(const float *p) { return _mm512_loadu_ps(p); }
+	static SIMD_TARGET_AVX512 SIMD_INLINE void Store(float *p, V v) { _mm512_storeu_ps(p, v); }
+	static SIMD_TARGET_AVX512 SIMD_INLINE V Min(V a, V b) { return _mm512_min_ps(a, b); }
+	static SIMD_TARGET_AVX512 SIMD_INLINE V Max(V a, V b) { return _mm512_max_ps(a, b); }
+	static SIMD_TARGET_AVX512 SIMD_INLINE V AddSat(V a, V b) { return _mm512_add_ps(a, b); }
+	static SIMD_TARGET_AVX512 SIMD_INLINE V SubSat(V a, V b) { return _mm512_sub_ps(a, b); }
+};
+#endif
+
+//------------------------------------------------------------------------------
+// Kernel bodies. W and B of 0 mean "from the arguments".
+//------------------------------------------------------------------------------
+
+template <class Ops, typename T>
+SIMD_INLINE void PkSubtractRow(const T *a, const T *b, T *out, int n)
+{
+	int x = 0;
+	for (; x + (int)Ops::kLanes <= n; x += Ops::kLanes)
+		Ops::Store(out + x, Ops::SubSat(Ops::Load(a + x), Ops::Load(b + x)));
+	for (; x < n; x++)
+		out[x] = PkScalarOps<T>::SubSat(a[x], b[x]);
+}
+
+template <class Ops, typename T, int W>
+SIMD_INLINE void PkSubtractBody(const T *frame, const T *dark, T *out, int width, int height)
+{
+	const int w = W > 0 ? W : width;
+	for (int y = 0; y < height; y++) {
+		size_t row = (size_t)y * w;
+		PkSubtractRow<Ops, T>(frame + row, dark + row, out + row, w);
+	}
+}
+
+template <class Ops, typename T, int W>
+SIMD_INLINE void PkMinMaxBody(const T *frame, int width, int height, T *pMin, T *pMax)
+{
+	typedef PkScalarOps<T> S;
+	const int w = W > 0 ? W : width;
+	T lo = std::numeric_limits<T>::max();
+	T hi = std::numeric_limits<T>::lowest();
+	if (w >= (int)Ops::kLanes) {
+		typename Ops::V vmin = Ops::Load(frame), vmax = vmin;
+		for (int y = 0; y < height; y++) {
+			const T *row = frame + (size_t)y * w;
+			int x = 0;
+			for (; x + (int)Ops::kLanes <= w; x += Ops::kLanes) {
+				typename Ops::V v = Ops::Load(row + x);
+				vmin = Ops::Min(vmin, v);
+				vmax = Ops::Max(vmax, v);
+			}
+			for (; x < w; x++) {
+				lo = S::Min(lo, row[x]);
+				hi = S::Max(hi, row[x]);
+			}
+		}
+		alignas(64) T lanes[2][Ops::kLanes];
+		Ops::Store(lanes[0], vmin);
+		Ops::Store(lanes[1], vmax);
+		for (int k = 0; k < (int)Ops::kLanes; k++) {
+			lo = S::Min(lo, lanes[0][k]);
+			hi = S::Max(hi, lanes[1][k]);
+		}
+	}
+	else {
+		for (size_t i = 0; i < (size_t)w * height; i++) {
+			lo = S::Min(lo, frame[i]);
+			hi = S::Max(hi, frame[i]);
+		}
+	}
+	*pMin = lo;
+	*pMax = hi;
+}
+
+// Sums hbin x vbin blocks; partial blocks at the right and top are dropped.
+// scratch holds one input row.
+template <class Ops, typename T, int W, int B>
+SIMD_INLINE void PkBinBody(const T *frame, int width, int height, int hbin, int vbin, T *out, T *scratch)
+{
+	typedef PkScalarOps<T> S;
+	const int w = W > 0 ? W : width;
+	const int hb = B > 0 ? B : hbin;
+	const int vb = B > 0 ? B : vbin;
+	const int outWidth = w / hb;
+	const int outHeight = height / vb;
+	for (int oy = 0; oy < outHeight; oy++) {
+		const T *row = frame + (size_t)oy * vb * w;
+		int x = 0;
+		for (; x + (int)Ops::kLanes <= w; x += Ops::kLanes) {
+			typename Ops::V sum = Ops::Load(row + x);
+			for (int j = 1; j < vb; j++)
+				sum = Ops::AddSat(sum, Ops::Load(row + (size_t)j * w + x));
+			Ops::Store(scratch + x, sum);
+		}
+		for (; x < w; x++) {
+			T sum = row[x];
+			for (int j = 1; j < vb; j++)
+				sum = S::AddSat(sum, row[(size_t)j * w + x]);
+			scratch[x] = sum;
+		}
+		T *dst = out + (size_t)oy * outWidth;
+		for (int ox = 0; ox < outWidth; ox++) {
+			T sum = scratch[ox * hb];
+			for (int i = 1; i < hb; i++)
+				sum = S::AddSat(sum, scratch[ox * hb + i]);
+			dst[ox] = sum;
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+// Instantiations per instruction set
+//------------------------------------------------------------------------------
+
+#define PK_DEFINE_KERNELS(SUFFIX, OPS, TARGET) \
+template <typename T, int W> \
+TARGET SIMD_FLATTEN void PkSubtract##SUFFIX(const T *frame, const T *dark, T *out, int width, int height) \
+{ PkSubtractBody<OPS<T>, T, W>(frame, dark, out, width, height); } \
+template <typename T, int W> \
+TARGET SIMD_FLATTEN void PkMinMax##SUFFIX(const T *frame, int width, int height, T *pMin, T *pMax) \
+{ PkMinMaxBody<OPS<T>, T, W>(frame, width, height, pMin, pMax); } \
+template <typename T, int W, int B> \
+TARGET SIMD_FLATTEN void PkBin##SUFFIX(const T *frame, int width, int height, int hbin, int vbin, T *out, T *scratch) \
+{ PkBinBody<OPS<T>, T, W, B>(frame, width, height, hbin, vbin, out, scratch); }
+
+PK_DEFINE_KERNELS(Scalar, PkScalarOps, )
+#if SIMD_X86
+PK_DEFINE_KERNELS(Sse42, PkSse42Ops, SIMD_TARGET_SSE42)
+PK_DEFINE_KERNELS(Avx2, PkAvx2Ops, SIMD_TARGET_AVX2)
+PK_DEFINE_KERNELS(Avx512, PkAvx512Ops, SIMD_TARGET_AVX512)
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+#endif
+
+#undef PK_DEFINE_KERNELS
+
+SIMD_END_KERNELS
+
+//------------------------------------------------------------------------------
+// Runtime selection
+//------------------------------------------------------------------------------
+
+template <typename T>
+struct PkKernels {
+	// out = frame - dark, frames of width x height
+	void			(*subtract)(const T *frame, const T *dark, T *out, int width, int height);
+	void			(*minMax)(const T *frame, int width, int height, T *pMin, T *pMax);
+	// out is (width / hbin) x (height / vbin); scratch holds width pixels
+	void			(*bin)(const T *frame, int width, int height, int hbin, int vbin, T *out, T *scratch);
+	SimdLevel		level;			// instruction set chosen
+	int				width;			// compile-time width, 0 for the runtime-width instantiation
+	int				binFactor;		// compile-time bin factor, 0 for runtime
+};
+
+template <typename T, int W, int B>
+PkKernels<T> PkSelectLevel(SimdLevel level)
+{
+	PkKernels<T> k;
+	k.width = W;
+	k.binFactor = B;
+#if SIMD_X86
+	if (level >= SIMD_AVX512) {
+		k.subtract = PkSubtractAvx512<T, W>;
+		k.minMax = PkMinMaxAvx512<T, W>;
+		k.bin = PkBinAvx512<T, W, B>;
+		k.level = SIMD_AVX512;
+		return k;
+	}
+	if (level >= SIMD_AVX2) {
+		k.subtract = PkSubtractAvx2<T, W>;
+		k.minMax = PkMinMaxAvx2<T, W>;
+		k.bin = PkBinAvx2<T, W, B>;
+		k.level = SIMD_AVX2;
+		return k;
+	}
+	if (level >= SIMD_SSE42) {
+		k.subtract = PkSubtractSse42<T, W>;
+		k.minMax = PkMinMaxSse42<T, W>;
+		k.bin = PkBinSse42<T, W, B>;
+		k.level = SIMD_SSE42;
+		return k;
+	}
+#endif
+	k.subtract = PkSubtractScalar<T, W>;
+	k.minMax = PkMinMaxScalar<T, W>;
+	k.bin = PkBinScalar<T, W, B>;
+	k.level = SIMD_NONE;
+	return k;
+}
+
+template <typename T, int W>
+PkKernels<T> PkSelectBin(SimdLevel level, int hbin, int vbin)
+{
+	if (hbin == vbin) {
+		switch (hbin) {
+		case 2: return PkSelectLevel<T, W, 2>(level);
+		case 4: return PkSelectLevel<T, W, 4>(level);
+		}
+	}
+	return PkSelectLevel<T, W, 0>(level);
+}
+
+// Best kernels for frames of the given width and binning on this machine
+template <typename T>
+PkKernels<T> PkSelect(int width, int hbin, int vbin)
+{
+	SimdLevel level = GetSimdLevel();
+	switch (width) {
+	case 512: return PkSelectBin<T, 512>(level, hbin, vbin);
+	case 1024: return PkSelectBin<T, 1024>(level, hbin, vbin);
+	case 2048: return PkSelectBin<T, 2048>(level, hbin, vbin);
+	}
+	return PkSelectBin<T, 0>(level, hbin, vbin);
+}
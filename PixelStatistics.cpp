@@ -0,0 +1,285 @@
+// PixelStatistics.cpp : Per-pixel running mean and variance for sensor characterisation.
+//
+// Every pixel has seen the same number of frames, so the Welford update
+//     delta = x - mean;  mean += delta / n;  m2 += delta * (x - mean)
+// uses one broadcast 1/n for the whole frame and needs no per-pixel count.
+
+#include "stdafx.h"
+#include "PixelStatistics.h"
+#include "SimdSupport.h"
+#include "WorkerPool.h"
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+#include <algorithm>
+
+static const size_t kPsTilePixels = 32768;
+static const size_t kPsSampleLimit = 65536;		// pixels sampled for the population statistics
+
+static const char kPsMagic[8] = { 'A', 'N', 'D', 'O', 'R', 'C', 'A', 'L' };
+static const uint32_t kPsVersion = 1;
+
+static void PsUpdateScalar(const WORD *frame, float *mean, float *m2, size_t begin, size_t end, float invN)
+{
+	for (size_t i = begin; i < end; i++) {
+		float x = frame[i];
+		float delta = x - mean[i];
+		mean[i] += delta * invN;
+		m2[i] += delta * (x - mean[i]);
+	}
+}
+
+#if SIMD_X86
+SIMD_TARGET_AVX2
+static void PsUpdateAVX2(const WORD *frame, float *mean, float *m2, size_t begin, size_t end, float invN)
+{
+	const __m256 scale = _mm256_set1_ps(invN);
+	size_t i = begin;
+	for (; i + 16 <= end; i += 16) {
+		__m256i raw = _mm256_loadu_si256((const __m256i *)(frame + i));
+		__m256 x[2];
+		x[0] = _mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(_mm256_castsi256_si128(raw)));
+		x[1] = _mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(_mm256_extracti128_si256(raw, 1)));
+		for (int h = 0; h < 2; h++) {
+			float *pm = mean + i + 8 * h;
+			float *pq = m2 + i + 8 * h;
+			__m256 mu = _mm256_loadu_ps(pm);
+			__m256 delta = _mm256_sub_ps(x[h], mu);
+			mu = _mm256_fmadd_ps(delta, scale, mu);
+			__m256 q = _mm256_fmadd_ps(delta, _mm256_sub_ps(x[h], mu), _mm256_loadu_ps(pq));
+			_mm256_storeu_ps(pm, mu);
+			_mm256_storeu_ps(pq, q);
+		}
+	}
+	PsUpdateScalar(frame, mean, m2, i, end, invN);
+}
+#endif
+
+unsigned int PsInitialise(PixelStatistics *ps, int width, int height, WorkerPool *pool)
+{
+	if (ps == NULL)
+		return DRV_P1INVALID;
+	if (width <= 0)
+		return DRV_P2INVALID;
+	if (height <= 0)
+		return DRV_P3INVALID;
+
+	std::lock_guard<std::mutex> guard(ps->lock);
+	ps->width = width;
+	ps->height = height;
+	ps->pool = pool;
+	ps->frames = 0;
+	ps->mean.assign((size_t)width * height, 0.0f);
+	ps->m2.assign((size_t)width * height, 0.0f);
+	return DRV_SUCCESS;
+}
+
+void PsReset(PixelStatistics *ps)
+{
+	std::lock_guard<std::mutex> guard(ps->lock);
+	ps->frames = 0;
+	std::fill(ps->mean.begin(), ps->mean.end(), 0.0f);
+	std::fill(ps->m2.begin(), ps->m2.end(), 0.0f);
+}
+
+unsigned int PsAddFrame(PixelStatistics *ps, const WORD *frame)
+{
+	if (ps == NULL || ps->mean.empty())
+		return DRV_P1INVALID;
+	if (frame == NULL)
+		return DRV_P2INVALID;
+
+	std::lock_guard<std::mutex> guard(ps->lock);
+	ps->frames++;
+	float invN = 1.0f / (float)ps->frames;
+	size_t pixels = ps->mean.size();
+	float *mean = ps->mean.data();
+	float *m2 = ps->m2.data();
+
+	void (*update)(const WORD *, float *, float *, size_t, size_t, float) = PsUpdateScalar;
+#if SIMD_X86
+	if (GetSimdLevel() >= SIMD_AVX2)
+		update = PsUpdateAVX2;
+#endif
+
+	int tiles = (int)((pixels + kPsTilePixels - 1) / kPsTilePixels);
+	auto task = [&](int tile, int) {
+		size_t begin = (size_t)tile * kPsTilePixels;
+		update(frame, mean, m2, begin, std::min(begin + kPsTilePixels, pixels), invN);
+	};
+	if (ps->pool)
+		ps->pool->Run(tiles, task);
+	else
+		for (int tile = 0; tile < tiles; tile++)
+			task(tile, 0);
+	return DRV_SUCCESS;
+}
+
+void PsDefaultThresholds(PixelStatsThresholds *thresholds)
+{
+	thresholds->hotSigma = 5.0f;
+	thresholds->deadSigma = 5.0f;
+	thresholds->noisyFactor = 10.0f;
+}
+
+// Median of an evenly spaced sample of values, enough for population limits
+static float PsSampledMedian(const std::vector<float> &values, std::vector<float> &scratch)
+{
+	size_t step = std::max<size_t>(1, values.size() / kPsSampleLimit);
+	scratch.clear();
+	for (size_t i = 0; i < values.size(); i += step)
+		scratch.push_back(values[i]);
+	std::nth_element(scratch.begin(), scratch.begin() + scratch.size() / 2, scratch.end());
+	return scratch[scratch.size() / 2];
+}
+
+unsigned int PsSnapshot(PixelStatistics *ps, const PixelStatsThresholds *thresholds, PixelStatsSnapshot *snapshot)
+{
+	if (ps == NULL || ps->mean.empty())
+		return DRV_P1INVALID;
+	if (snapshot == NULL)
+		return DRV_P3INVALID;
+
+	PixelStatsThresholds defaults;
+	if (thresholds == NULL) {
+		PsDefaultThresholds(&defaults);
+		thresholds = &defaults;
+	}
+
+	// Only the copy happens under the lock, so acquisition keeps flowing
+	{
+		std::lock_guard<std::mutex> guard(ps->lock);
+		if (ps->frames < 2)
+			return DRV_NO_NEW_DATA;
+		snapshot->width = ps->width;
+		snapshot->height = ps->height;
+		snapshot->frames = ps->frames;
+		snapshot->mean = ps->mean;
+		snapshot->variance = ps->m2;
+	}
+
+	size_t pixels = snapshot->mean.size();
+	float invDof = 1.0f / (float)(snapshot->frames - 1);
+	for (size_t i = 0; i < pixels; i++)
+		snapshot->variance[i] *= invDof;
+
+	std::vector<float> scratch;
+	scratch.reserve(std::min(pixels, kPsSampleLimit + 1));
+	snapshot->medianMean = PsSampledMedian(snapshot->mean, scratch);
+	snapshot->medianVariance = PsSampledMedian(snapshot->variance, scratch);
+	size_t step = std::max<size_t>(1, pixels / kPsSampleLimit);
+	scratch.clear();
+	for (size_t i = 0; i < pixels; i += step)
+		scratch.push_back(fabsf(snapshot->mean[i] - snapshot->medianMean));
+	std::nth_element(scratch.begin(), scratch.begin() + scratch.size() / 2, scratch.end());
+	snapshot->sigmaMean = 1.4826f * scratch[scratch.size() / 2];
+
+	// Quantised dark frames can give a MAD of zero, never clip inside one ADU
+	float sigma = std::max(snapshot->sigmaMean, 1.0f);
+	float hotLimit = snapshot->medianMean + thresholds->hotSigma * sigma;
+	float deadLimit = snapshot->medianMean - thresholds->deadSigma * sigma;
+	float noisyLimit = thresholds->noisyFactor * std::max(snapshot->medianVariance, 1.0f);
+
+	snapshot->mask.assign(pixels, 0);
+	snapshot->hotPixels = 0;
+	snapshot->deadPixels = 0;
+	snapshot->noisyPixels = 0;
+	snapshot->stuckPixels = 0;
+	for (size_t i = 0; i < pixels; i++) {
+		BYTE bits = 0;
+		if (snapshot->mean[i] > hotLimit) {
+			bits |= PIXEL_HOT;
+			snapshot->hotPixels++;
+		}
+		else if (snapshot->mean[i] < deadLimit) {
+			bits |= PIXEL_DEAD;
+			snapshot->deadPixels++;
+		}
+		if (snapshot->variance[i] > noisyLimit) {
+			bits |= PIXEL_NOISY;
+			snapshot->noisyPixels++;
+		}
+		else if (snapshot->variance[i] <= 0.0f) {
+			bits |= PIXEL_STUCK;
+			snapshot->stuckPixels++;
+		}
+		snapshot->mask[i] = bits;
+	}
+	return DRV_SUCCESS;
+}
+
+unsigned int PsWriteCalibrationFile(const PixelStatsSnapshot *snapshot, const char *filename)
+{
+	if (snapshot == NULL || snapshot->mean.empty())
+		return DRV_P1INVALID;
+	if (filename == NULL)
+		return DRV_P2INVALID;
+
+	FILE *file = fopen(filename, "wb");
+	if (file == NULL)
+		return DRV_ERROR_FILESAVE;
+
+	uint32_t header[4] = { kPsVersion, (uint32_t)snapshot->width, (uint32_t)snapshot->height, (uint32_t)snapshot->frames };
+	float population[3] = { snapshot->medianMean, snapshot->sigmaMean, snapshot->medianVariance };
+	size_t pixels = snapshot->mean.size();
+
+	bool ok = fwrite(kPsMagic, sizeof(kPsMagic), 1, file) == 1
+		&& fwrite(header, sizeof(header), 1, file) == 1
+		&& fwrite(population, sizeof(population), 1, file) == 1
+		&& fwrite(snapshot->mean.data(), sizeof(float), pixels, file) == pixels
+		&& fwrite(snapshot->variance.data(), sizeof(float), pixels, file) == pixels
+		&& fwrite(snapshot->mask.data(), 1, pixels, file) == pixels;
+	if (fclose(file) != 0)
+		ok = false;
+	return ok ? DRV_SUCCESS : DRV_ERROR_FILESAVE;
+}
+
+unsigned int PsReadCalibrationFile(PixelStatsSnapshot *snapshot, const char *filename)
+{
+	if (snapshot == NULL)
+		return DRV_P1INVALID;
+	if (filename == NULL)
+		return DRV_P2INVALID;
+
+	FILE *file = fopen(filename, "rb");
+	if (file == NULL)
+		return DRV_ERROR_FILELOAD;
+
+	char magic[8];
+	uint32_t header[4];
+	float population[3];
+	bool ok = fread(magic, sizeof(magic), 1, file) == 1
+		&& memcmp(magic, kPsMagic, sizeof(magic)) == 0
+		&& fread(header, sizeof(header), 1, file) == 1
+		&& header[0] == kPsVersion
+		&& header[1] > 0 && header[2] > 0
+		&& fread(population, sizeof(population), 1, file) == 1;
+	if (ok) {
+		size_t pixels = (size_t)header[1] * header[2];
+		snapshot->width = (int)header[1];
+		snapshot->height = (int)header[2];
+		snapshot->frames = (int)header[3];
+		snapshot->medianMean = population[0];
+		snapshot->sigmaMean = population[1];
+		snapshot->medianVariance = population[2];
+		snapshot->mean.resize(pixels);
+		snapshot->variance.resize(pixels);
+		snapshot->mask.resize(pixels);
+		ok = fread(snapshot->mean.data(), sizeof(float), pixels, file) == pixels
+			&& fread(snapshot->variance.data(), sizeof(float), pixels, file) == pixels
+			&& fread(snapshot->mask.data(), 1, pixels, file) == pixels;
+	}
+	fclose(file);
+	if (!ok)
+		return DRV_ERROR_FILELOAD;
+
+	snapshot->hotPixels = snapshot->deadPixels = snapshot->noisyPixels = snapshot->stuckPixels = 0;
+	for (BYTE bits : snapshot->mask) {
+		snapshot->hotPixels += (bits & PIXEL_HOT) != 0;
+		snapshot->deadPixels += (bits & PIXEL_DEAD) != 0;
+		snapshot->noisyPixels += (bits & PIXEL_NOISY) != 0;
+		snapshot->stuckPixels += (bits & PIXEL_STUCK) != 0;
+	}
+	return DRV_SUCCESS;
+}
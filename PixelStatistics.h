@@ -0,0 +1,79 @@
+// PixelStatistics.h : Per-pixel running mean and variance for sensor characterisation.
+//
+// Dark-frame series are reduced while the camera runs instead of being saved and
+// post-processed. Each pixel keeps a Welford mean and M2 in two float arrays
+// (structure of arrays), so a frame update is a handful of vector FMAs per 8 or
+// 16 pixels. A snapshot of the mean, variance and hot/dead pixel masks can be
+// taken at any time without stopping the updates, and written straight to a
+// calibration file.
+
+#pragma once
+
+#include <stdio.h>
+#include <mutex>
+#include <vector>
+
+extern "C" {
+	#include "atmcd32d.h"
+}
+
+class WorkerPool;
+
+// Mask bits in PixelStatsSnapshot::mask
+#define PIXEL_HOT		0x01		// mean far above the frame population
+#define PIXEL_DEAD		0x02		// mean far below the frame population
+#define PIXEL_NOISY		0x04		// variance far above the frame population
+#define PIXEL_STUCK		0x08		// no variance at all over the series
+
+struct PixelStatistics {
+	int					width;
+	int					height;
+	int					frames;
+	std::vector<float>	mean;
+	std::vector<float>	m2;				// sum of squared deviations from the mean
+	WorkerPool			*pool;			// NULL runs on the calling thread
+	std::mutex			lock;			// held while a frame is added or a snapshot taken
+};
+
+struct PixelStatsThresholds {
+	float				hotSigma;		// robust deviations above the median mean
+	float				deadSigma;		// robust deviations below the median mean
+	float				noisyFactor;	// multiples of the median variance
+};
+
+struct PixelStatsSnapshot {
+	int					width;
+	int					height;
+	int					frames;
+	std::vector<float>	mean;
+	std::vector<float>	variance;		// sample variance, M2 / (frames - 1)
+	std::vector<BYTE>	mask;			// PIXEL_* bits
+	float				medianMean;
+	float				sigmaMean;		// 1.4826 * MAD of the mean map
+	float				medianVariance;
+	int					hotPixels;
+	int					deadPixels;
+	int					noisyPixels;
+	int					stuckPixels;
+};
+
+unsigned int PsInitialise(PixelStatistics *ps, int width, int height, WorkerPool *pool);
+unsigned int PsAddFrame(PixelStatistics *ps, const WORD *frame);
+void PsReset(PixelStatistics *ps);
+
+// Defaults of 5 sigma for hot/dead and 10x the median variance for noisy
+void PsDefaultThresholds(PixelStatsThresholds *thresholds);
+
+// Needs at least two frames. thresholds may be NULL for the defaults.
+unsigned int PsSnapshot(PixelStatistics *ps, const PixelStatsThresholds *thresholds, PixelStatsSnapshot *snapshot);
+
+// Calibration file, little endian:
+//   char     magic[8]        "ANDORCAL"
+//   uint32   version         1
+//   uint32   width, height, frames
+//   float    medianMean, sigmaMean, medianVariance
+//   float    mean[width*height]
+//   float    variance[width*height]
+//   uint8    mask[width*height]
+unsigned int PsWriteCalibrationFile(const PixelStatsSnapshot *snapshot, const char *filename);
+unsigned int PsReadCalibrationFile(PixelStatsSnapshot *snapshot, const char *filename);
@@ -0,0 +1,223 @@
+// ReadoutTuner.cpp : Readout configuration planner maximising frame rate for an ROI.
+//
+
+#include "stdafx.h"
+#include "ReadoutTuner.h"
+
+#include <math.h>
+
+// Picks the pre-amp gain for a combination: the available one closest to the
+// wanted gain, or the lowest when none is wanted
+static bool RoChoosePreAmp(const TuneConstraints *constraints, ReadoutConfig *config)
+{
+	int gains = 0;
+	if (GetNumberPreAmpGains(&gains) != DRV_SUCCESS || gains <= 0) {
+		config->preAmpIndex = 0;
+		config->preAmpGain = 1.0f;
+		return true;
+	}
+	bool found = false;
+	for (int index = 0; index < gains; index++) {
+		int status = 0;
+		if (IsPreAmpGainAvailable(config->adChannel, config->amplifier, config->hsIndex, index, &status) != DRV_SUCCESS
+			|| status != 1)
+			continue;
+		float gain;
+		if (GetPreAmpGain(index, &gain) != DRV_SUCCESS)
+			continue;
+		bool better;
+		if (!found)
+			better = true;
+		else if (constraints->preAmpGain > 0.0f)
+			better = fabsf(gain - constraints->preAmpGain) < fabsf(config->preAmpGain - constraints->preAmpGain);
+		else
+			better = gain < config->preAmpGain;
+		if (better) {
+			config->preAmpIndex = index;
+			config->preAmpGain = gain;
+			found = true;
+		}
+	}
+	return found;
+}
+
+static unsigned int RoMeasure(const TuneConstraints *constraints, ReadoutConfig *config)
+{
+	unsigned int error = RoApply(config, constraints);
+	if (error != DRV_SUCCESS)
+		return error;
+	float accumulate;
+	error = GetAcquisitionTimings(&config->exposure, &accumulate, &config->cycleTime);
+	if (error != DRV_SUCCESS)
+		return error;
+	error = GetReadOutTime(&config->readoutTime);
+	if (error != DRV_SUCCESS)
+		return error;
+	if (GetKeepCleanTime(&config->keepCleanTime) != DRV_SUCCESS)
+		config->keepCleanTime = 0.0f;	// not every camera reports it
+	config->frameRate = config->cycleTime > 0.0f ? 1.0f / config->cycleTime : 0.0f;
+	return DRV_SUCCESS;
+}
+
+// Faster wins; within 0.1% the quieter (slower pixel clock), deeper readout does
+static bool RoBetter(const ReadoutConfig &a, const ReadoutConfig &b)
+{
+	if (a.frameRate > b.frameRate * 1.001f)
+		return true;
+	if (a.frameRate * 1.001f < b.frameRate)
+		return false;
+	if (a.hsSpeed != b.hsSpeed)
+		return a.hsSpeed < b.hsSpeed;
+	return a.bitDepth > b.bitDepth;
+}
+
+//------------------------------------------------------------------------------
+// Public interface
+//------------------------------------------------------------------------------
+
+void RoDefaultConstraints(TuneConstraints *constraints, int xPixels, int yPixels)
+{
+	constraints->hbin = 1;
+	constraints->vbin = 1;
+	constraints->hstart = 1;
+	constraints->hend = xPixels;
+	constraints->vstart = 1;
+	constraints->vend = yPixels;
+	constraints->exposure = 0.01f;
+	constraints->amplifier = -1;
+	constraints->minBitDepth = 0;
+	constraints->maxHSSpeed = 0.0f;
+	constraints->preAmpGain = 0.0f;
+	constraints->maxVSAmplitude = 0;
+	constraints->allowFrameTransfer = true;
+}
+
+unsigned int RoApply(const ReadoutConfig *config, const TuneConstraints *constraints)
+{
+	if (config == NULL)
+		return DRV_P1INVALID;
+	if (constraints == NULL)
+		return DRV_P2INVALID;
+
+	unsigned int error = SetOutputAmplifier(config->amplifier);
+	if (error == DRV_SUCCESS)
+		error = SetADChannel(config->adChannel);
+	if (error == DRV_SUCCESS)
+		error = SetHSSpeed(config->amplifier, config->hsIndex);
+	if (error == DRV_SUCCESS)
+		error = SetPreAmpGain(config->preAmpIndex);
+	if (error == DRV_SUCCESS)
+		error = SetVSSpeed(config->vsIndex);
+	// Cameras without amplitude control or frame transfer may refuse even the
+	// defaults, which is fine
+	if (error == DRV_SUCCESS) {
+		unsigned int result = SetVSAmplitude(config->vsAmplitude);
+		if (config->vsAmplitude != 0)
+			error = result;
+	}
+	if (error == DRV_SUCCESS) {
+		unsigned int result = SetFrameTransferMode(config->frameTransfer);
+		if (config->frameTransfer != 0)
+			error = result;
+	}
+	if (error == DRV_SUCCESS)
+		error = SetImage(constraints->hbin, constraints->vbin,
+			constraints->hstart, constraints->hend, constraints->vstart, constraints->vend);
+	if (error == DRV_SUCCESS)
+		error = SetExposureTime(constraints->exposure);
+	return error;
+}
+
+unsigned int RoTune(const TuneConstraints *constraints, ReadoutConfig *best, std::vector<ReadoutConfig> *candidates)
+{
+	if (constraints == NULL)
+		return DRV_P1INVALID;
+	if (best == NULL)
+		return DRV_P2INVALID;
+
+	AndorCapabilities caps;
+	caps.ulSize = sizeof(caps);
+	unsigned int error = GetCapabilities(&caps);
+	if (error != DRV_SUCCESS)
+		return error;
+	bool canFrameTransfer = constraints->allowFrameTransfer && (caps.ulAcqModes & AC_ACQMODE_FRAMETRANSFER);
+	bool canAmplitude = (caps.ulSetFunctions & AC_SETFUNCTION_VSAMPLITUDE) != 0;
+
+	// Run till abort with the shortest cycle, so the kinetic time is the frame period
+	error = SetAcquisitionMode(5);
+	if (error == DRV_SUCCESS)
+		error = SetKineticCycleTime(0.0f);
+	if (error != DRV_SUCCESS)
+		return error;
+
+	int amplifiers = 1, channels = 1, vsSpeeds = 1, amplitudes = 1;
+	GetNumberAmp(&amplifiers);
+	error = GetNumberADChannels(&channels);
+	if (error != DRV_SUCCESS)
+		return error;
+	error = GetNumberVSSpeeds(&vsSpeeds);
+	if (error != DRV_SUCCESS)
+		return error;
+	if (canAmplitude)
+		GetNumberVSAmplitudes(&amplitudes);
+	int recommendedVS = 0;
+	float recommendedSpeed;
+	GetFastestRecommendedVSSpeed(&recommendedVS, &recommendedSpeed);
+
+	bool found = false;
+	for (int amp = 0; amp < amplifiers; amp++) {
+		if (constraints->amplifier >= 0 && amp != constraints->amplifier)
+			continue;
+		if (IsAmplifierAvailable(amp) != DRV_SUCCESS)
+			continue;
+		for (int channel = 0; channel < channels; channel++) {
+			int depth = 0;
+			if (GetBitDepth(channel, &depth) != DRV_SUCCESS || depth < constraints->minBitDepth)
+				continue;
+			int hsSpeeds = 0;
+			if (GetNumberHSSpeeds(channel, amp, &hsSpeeds) != DRV_SUCCESS)
+				continue;
+			for (int hs = 0; hs < hsSpeeds; hs++) {
+				ReadoutConfig config = {};
+				config.amplifier = amp;
+				config.adChannel = channel;
+				config.bitDepth = depth;
+				config.hsIndex = hs;
+				if (GetHSSpeed(channel, amp, hs, &config.hsSpeed) != DRV_SUCCESS)
+					continue;
+				if (constraints->maxHSSpeed > 0.0f && config.hsSpeed > constraints->maxHSSpeed)
+					continue;
+				if (!RoChoosePreAmp(constraints, &config))
+					continue;
+				for (int vs = 0; vs < vsSpeeds; vs++) {
+					// Lower indices shift faster; those beyond the recommended
+					// speed need a raised clock amplitude to transfer cleanly
+					config.vsIndex = vs;
+					config.vsAmplitude = 0;
+					if (vs < recommendedVS) {
+						if (constraints->maxVSAmplitude <= 0 || amplitudes <= 1)
+							continue;
+						config.vsAmplitude = constraints->maxVSAmplitude < amplitudes
+							? constraints->maxVSAmplitude : amplitudes - 1;
+					}
+					if (GetVSSpeed(vs, &config.vsSpeed) != DRV_SUCCESS)
+						continue;
+					for (int ft = 0; ft <= (canFrameTransfer ? 1 : 0); ft++) {
+						config.frameTransfer = ft;
+						if (RoMeasure(constraints, &config) != DRV_SUCCESS)
+							continue;
+						if (candidates)
+							candidates->push_back(config);
+						if (!found || RoBetter(config, *best)) {
+							*best = config;
+							found = true;
+						}
+					}
+				}
+			}
+		}
+	}
+	if (!found)
+		return DRV_NOT_SUPPORTED;
+	return RoApply(best, constraints);
+}
@@ -0,0 +1,71 @@
+// ReadoutTuner.h : Readout configuration planner maximising frame rate for an ROI.
+//
+// Andor_test.cpp takes the fastest horizontal speed and the fastest
+// recommended vertical speed and ignores everything else. The tuner walks the
+// valid combinations of output amplifier, AD channel, horizontal speed,
+// vertical speed and frame transfer for a given image area and exposure,
+// lets the SDK compute each one's timing with GetAcquisitionTimings,
+// GetReadOutTime and GetKeepCleanTime, and keeps the fastest that satisfies
+// the constraints. Pre-amp gain and vertical clock amplitude do not change the
+// timing, so they are chosen per combination rather than multiplied in: the
+// pre-amp gain closest to the one asked for that IsPreAmpGainAvailable
+// accepts, and a raised amplitude only for vertical speeds faster than the
+// fastest recommended one.
+//
+// The SDK has no read noise figure, so the horizontal speed limit stands in
+// for it: slower pixel clocks read with less noise.
+
+#pragma once
+
+#include <vector>
+
+extern "C" {
+	#include "atmcd32d.h"
+}
+
+struct TuneConstraints {
+	int						hbin;			// image area, as for SetImage
+	int						vbin;
+	int						hstart;
+	int						hend;
+	int						vstart;
+	int						vend;
+	float					exposure;		// seconds
+
+	int						amplifier;		// 0 EM, 1 conventional, -1 either
+	int						minBitDepth;	// 0 for any
+	float					maxHSSpeed;		// MHz, 0 for no limit
+	float					preAmpGain;		// wanted gain, 0 for the lowest available
+	int						maxVSAmplitude;	// 0 keeps to recommended vertical speeds
+	bool					allowFrameTransfer;
+};
+
+struct ReadoutConfig {
+	int						amplifier;
+	int						adChannel;
+	int						bitDepth;
+	int						hsIndex;
+	float					hsSpeed;		// MHz
+	int						preAmpIndex;
+	float					preAmpGain;
+	int						vsIndex;
+	float					vsSpeed;		// microseconds per row
+	int						vsAmplitude;
+	int						frameTransfer;
+	float					exposure;		// as the SDK will actually use them, seconds
+	float					readoutTime;
+	float					keepCleanTime;
+	float					cycleTime;		// kinetic cycle time
+	float					frameRate;		// 1 / cycleTime
+};
+
+void RoDefaultConstraints(TuneConstraints *constraints, int xPixels, int yPixels);
+
+// Programs one configuration, with the image area and exposure of constraints
+unsigned int RoApply(const ReadoutConfig *config, const TuneConstraints *constraints);
+
+// Finds the fastest configuration and leaves the camera set to it, in run
+// till abort with the shortest kinetic cycle. Every combination evaluated is
+// appended to candidates when it is not NULL. Returns DRV_NOT_SUPPORTED when
+// nothing satisfies the constraints.
+unsigned int RoTune(const TuneConstraints *constraints, ReadoutConfig *best, std::vector<ReadoutConfig> *candidates);
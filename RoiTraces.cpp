@@ -0,0 +1,311 @@
+// RoiTraces.cpp : Multi-ROI intensity traces from a kinetic series.
+//
+
+#include "stdafx.h"
+#include "RoiTraces.h"
+#include "SimdSupport.h"
+#include "WorkerPool.h"
+
+#include <stdio.h>
+#include <algorithm>
+
+static const uint32_t kRtTableMaxArea = 65537;	// 65537 * 65535 < 2^32
+static const int kRtRoisPerTask = 32;
+
+//------------------------------------------------------------------------------
+// Run sums
+//------------------------------------------------------------------------------
+
+static uint64_t RtSumRunScalar(const WORD *p, uint32_t n)
+{
+	uint64_t sum = 0;
+	for (uint32_t i = 0; i < n; i++)
+		sum += p[i];
+	return sum;
+}
+
+#if SIMD_X86
+SIMD_TARGET_AVX2
+static uint64_t RtSumRunAVX2(const WORD *p, uint32_t n)
+{
+	// _mm256_madd_epi16 against 1 would treat the pixels as signed, so widen
+	// to 32 bits instead. Each lane gathers at most n / 8 pixels, which stays
+	// below 2^32 for any run shorter than 2^19 pixels; flush before that.
+	uint64_t total = 0;
+	uint32_t i = 0;
+	while (i + 16 <= n) {
+		uint32_t chunkEnd = std::min<uint32_t>(n, i + (1u << 18));
+		__m256i acc = _mm256_setzero_si256();
+		for (; i + 16 <= chunkEnd; i += 16) {
+			__m256i v = _mm256_loadu_si256((const __m256i *)(p + i));
+			acc = _mm256_add_epi32(acc, _mm256_cvtepu16_epi32(_mm256_castsi256_si128(v)));
+			acc = _mm256_add_epi32(acc, _mm256_cvtepu16_epi32(_mm256_extracti128_si256(v, 1)));
+		}
+		alignas(32) uint32_t lanes[8];
+		_mm256_store_si256((__m256i *)lanes, acc);
+		for (int k = 0; k < 8; k++)
+			total += lanes[k];
+	}
+	return total + RtSumRunScalar(p + i, n - i);
+}
+#endif
+
+//------------------------------------------------------------------------------
+// ROI set up
+//------------------------------------------------------------------------------
+
+static unsigned int RtAppendRoi(RoiTraces *rt, const TraceRoi &roi, int *pIndex)
+{
+	if (!rt->timestamps.empty())
+		return DRV_ACQUIRING;		// the trace matrix already has a fixed width
+	rt->rois.push_back(roi);
+	rt->planned = false;
+	if (pIndex)
+		*pIndex = (int)rt->rois.size() - 1;
+	return DRV_SUCCESS;
+}
+
+// Compile sorted pixel indices into runs of consecutive indices
+static void RtAppendRuns(RoiTraces *rt, TraceRoi &roi, std::vector<uint32_t> &indices)
+{
+	std::sort(indices.begin(), indices.end());
+	indices.erase(std::unique(indices.begin(), indices.end()), indices.end());
+	roi.firstRun = (uint32_t)rt->runs.size();
+	roi.area = (uint32_t)indices.size();
+	for (size_t i = 0; i < indices.size(); ) {
+		TraceRun run = { indices[i], 1 };
+		while (++i < indices.size() && indices[i] == run.start + run.length)
+			run.length++;
+		rt->runs.push_back(run);
+	}
+	roi.runCount = (uint32_t)rt->runs.size() - roi.firstRun;
+}
+
+// Choose per rectangle between the table and its runs. The table costs one
+// pass over the frame, so it only pays when the rectangles it would serve
+// cover more pixels than the frame has.
+static void RtPlan(RoiTraces *rt)
+{
+	size_t pixels = (size_t)rt->width * rt->height;
+	size_t tableArea = 0;
+	for (const TraceRoi &roi : rt->rois)
+		if (roi.left >= 0 && roi.area <= kRtTableMaxArea)
+			tableArea += roi.area;
+	rt->buildTable = tableArea > pixels;
+
+	for (TraceRoi &roi : rt->rois) {
+		roi.useTable = rt->buildTable && roi.left >= 0 && roi.area <= kRtTableMaxArea;
+		if (roi.left < 0 || roi.useTable || roi.runCount > 0)
+			continue;
+		// Rectangle read directly: one run per row
+		roi.firstRun = (uint32_t)rt->runs.size();
+		for (int y = roi.bottom; y <= roi.top; y++) {
+			TraceRun run = { (uint32_t)(y * rt->width + roi.left), (uint32_t)(roi.right - roi.left + 1) };
+			rt->runs.push_back(run);
+		}
+		roi.runCount = (uint32_t)rt->runs.size() - roi.firstRun;
+	}
+	if (rt->buildTable)
+		rt->table.assign((size_t)(rt->width + 1) * (rt->height + 1), 0);
+	else
+		std::vector<uint32_t>().swap(rt->table);
+	rt->planned = true;
+}
+
+static void RtBuildTable(RoiTraces *rt, const WORD *frame)
+{
+	// table[(y + 1) * stride + (x + 1)] = sum of frame[0..y][0..x], modulo 2^32.
+	// Row 0 and column 0 stay zero.
+	size_t stride = (size_t)rt->width + 1;
+	uint32_t *table = rt->table.data();
+	for (int y = 0; y < rt->height; y++) {
+		const WORD *row = frame + (size_t)y * rt->width;
+		const uint32_t *above = table + (size_t)y * stride + 1;
+		uint32_t *out = table + (size_t)(y + 1) * stride + 1;
+		uint32_t running = 0;
+		for (int x = 0; x < rt->width; x++) {
+			running += row[x];
+			out[x] = above[x] + running;
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+// Public interface
+//------------------------------------------------------------------------------
+
+unsigned int RtInitialise(RoiTraces *rt, int width, int height, WorkerPool *pool)
+{
+	if (rt == NULL)
+		return DRV_P1INVALID;
+	if (width <= 0)
+		return DRV_P2INVALID;
+	if (height <= 0 || (uint64_t)width * height > 0xFFFFFFFFull)
+		return DRV_P3INVALID;
+
+	rt->width = width;
+	rt->height = height;
+	rt->pool = pool;
+	rt->rois.clear();
+	rt->runs.clear();
+	rt->planned = false;
+	rt->buildTable = false;
+	rt->table.clear();
+	rt->traces.clear();
+	rt->timestamps.clear();
+	return DRV_SUCCESS;
+}
+
+unsigned int RtAddRectangle(RoiTraces *rt, int left, int bottom, int right, int top, int *pIndex)
+{
+	if (rt == NULL)
+		return DRV_P1INVALID;
+	if (left < 0 || left > right || right >= rt->width)
+		return DRV_P2INVALID;
+	if (bottom < 0 || bottom > top || top >= rt->height)
+		return DRV_P3INVALID;
+
+	TraceRoi roi = {};
+	roi.left = left;
+	roi.bottom = bottom;
+	roi.right = right;
+	roi.top = top;
+	roi.area = (uint32_t)(right - left + 1) * (uint32_t)(top - bottom + 1);
+	return RtAppendRoi(rt, roi, pIndex);
+}
+
+unsigned int RtAddPixels(RoiTraces *rt, const uint32_t *indices, int count, int *pIndex)
+{
+	if (rt == NULL)
+		return DRV_P1INVALID;
+	if (indices == NULL)
+		return DRV_P2INVALID;
+	if (count <= 0)
+		return DRV_P3INVALID;
+	if (!rt->timestamps.empty())
+		return DRV_ACQUIRING;
+
+	size_t pixels = (size_t)rt->width * rt->height;
+	std::vector<uint32_t> sorted(indices, indices + count);
+	for (uint32_t index : sorted)
+		if (index >= pixels)
+			return DRV_P2INVALID;
+
+	TraceRoi roi = {};
+	roi.left = -1;
+	RtAppendRuns(rt, roi, sorted);
+	return RtAppendRoi(rt, roi, pIndex);
+}
+
+unsigned int RtAddMask(RoiTraces *rt, const BYTE *mask, int *pIndex)
+{
+	if (rt == NULL)
+		return DRV_P1INVALID;
+	if (mask == NULL)
+		return DRV_P2INVALID;
+
+	std::vector<uint32_t> indices;
+	size_t pixels = (size_t)rt->width * rt->height;
+	for (size_t i = 0; i < pixels; i++)
+		if (mask[i])
+			indices.push_back((uint32_t)i);
+	if (indices.empty())
+		return DRV_P2INVALID;
+	return RtAddPixels(rt, indices.data(), (int)indices.size(), pIndex);
+}
+
+unsigned int RtAddFrame(RoiTraces *rt, const WORD *frame, double timestamp)
+{
+	if (rt == NULL || rt->rois.empty())
+		return DRV_P1INVALID;
+	if (frame == NULL)
+		return DRV_P2INVALID;
+
+	if (!rt->planned)
+		RtPlan(rt);
+	if (rt->buildTable)
+		RtBuildTable(rt, frame);
+
+	uint64_t (*sumRun)(const WORD *, uint32_t) = RtSumRunScalar;
+#if SIMD_X86
+	if (GetSimdLevel() >= SIMD_AVX2)
+		sumRun = RtSumRunAVX2;
+#endif
+
+	int count = (int)rt->rois.size();
+	size_t rowStart = rt->traces.size();
+	rt->traces.resize(rowStart + count);
+	float *row = rt->traces.data() + rowStart;
+	size_t stride = (size_t)rt->width + 1;
+	const uint32_t *table = rt->table.data();
+
+	auto task = [&](int block, int) {
+		int end = std::min(count, (block + 1) * kRtRoisPerTask);
+		for (int r = block * kRtRoisPerTask; r < end; r++) {
+			const TraceRoi &roi = rt->rois[r];
+			uint64_t sum = 0;
+			if (roi.useTable) {
+				// Wrap-around terms cancel because the true sum fits in 32 bits
+				size_t y0 = roi.bottom, y1 = (size_t)roi.top + 1;
+				size_t x0 = roi.left, x1 = (size_t)roi.right + 1;
+				uint32_t s = table[y1 * stride + x1] - table[y0 * stride + x1]
+					- table[y1 * stride + x0] + table[y0 * stride + x0];
+				sum = s;
+			}
+			else {
+				const TraceRun *run = rt->runs.data() + roi.firstRun;
+				for (uint32_t k = 0; k < roi.runCount; k++, run++)
+					sum += sumRun(frame + run->start, run->length);
+			}
+			row[r] = (float)((double)sum / (double)roi.area);
+		}
+	};
+
+	int blocks = (count + kRtRoisPerTask - 1) / kRtRoisPerTask;
+	if (rt->pool)
+		rt->pool->Run(blocks, task);
+	else
+		for (int block = 0; block < blocks; block++)
+			task(block, 0);
+
+	rt->timestamps.push_back(timestamp);
+	return DRV_SUCCESS;
+}
+
+int RtGetFrameCount(const RoiTraces *rt)
+{
+	return (int)rt->timestamps.size();
+}
+
+const float *RtGetTraceRow(const RoiTraces *rt, int frame)
+{
+	if (frame < 0 || frame >= (int)rt->timestamps.size())
+		return NULL;
+	return rt->traces.data() + (size_t)frame * rt->rois.size();
+}
+
+unsigned int RtWriteCsv(const RoiTraces *rt, const char *filename)
+{
+	if (rt == NULL)
+		return DRV_P1INVALID;
+	if (filename == NULL)
+		return DRV_P2INVALID;
+
+	FILE *file = fopen(filename, "w");
+	if (file == NULL)
+		return DRV_ERROR_FILESAVE;
+
+	size_t count = rt->rois.size();
+	fprintf(file, "time");
+	for (size_t r = 0; r < count; r++)
+		fprintf(file, ",roi%u", (unsigned int)r);
+	fprintf(file, "\n");
+	for (size_t f = 0; f < rt->timestamps.size(); f++) {
+		fprintf(file, "%.6f", rt->timestamps[f]);
+		const float *row = rt->traces.data() + f * count;
+		for (size_t r = 0; r < count; r++)
+			fprintf(file, ",%.3f", row[r]);
+		fprintf(file, "\n");
+	}
+	return fclose(file) == 0 ? DRV_SUCCESS : DRV_ERROR_FILESAVE;
+}
@@ -0,0 +1,69 @@
+// RoiTraces.h : Multi-ROI intensity traces from a kinetic series.
+//
+// Calcium imaging and kinetic fluorescence need the mean of hundreds of ROIs
+// per frame, not the frames themselves. This stage reduces each frame to one
+// row of a time x ROI matrix as it arrives, so full frames can be dropped.
+//
+// Rectangular ROIs are answered from a summed-area table when that is cheaper
+// than reading their pixels, i.e. when they overlap or cover more than the
+// frame; the table is kept in 32-bit wrap-around arithmetic, which is exact
+// for any rectangle of up to 65537 pixels. Arbitrary-shaped ROIs and larger
+// rectangles are compiled to runs of consecutive pixel indices and summed
+// with SIMD widening reductions.
+
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+extern "C" {
+	#include "atmcd32d.h"
+}
+
+class WorkerPool;
+
+struct TraceRun {
+	uint32_t				start;			// first pixel index in the frame
+	uint32_t				length;
+};
+
+struct TraceRoi {
+	int						left;			// rectangle, inclusive, 0-based;
+	int						bottom;			// left < 0 for a pixel-list ROI
+	int						right;
+	int						top;
+	uint32_t				area;
+	uint32_t				firstRun;		// runs[firstRun, firstRun + runCount)
+	uint32_t				runCount;
+	bool					useTable;		// answered from the summed-area table
+};
+
+struct RoiTraces {
+	int						width;
+	int						height;
+	std::vector<TraceRoi>	rois;
+	std::vector<TraceRun>	runs;
+	bool					planned;		// table/run choice made for the current ROI set
+	bool					buildTable;
+	std::vector<uint32_t>	table;			// (width + 1) x (height + 1) summed-area table
+	std::vector<float>		traces;			// frames x rois.size(), mean value per ROI
+	std::vector<double>		timestamps;
+	WorkerPool				*pool;			// NULL runs on the calling thread
+};
+
+unsigned int RtInitialise(RoiTraces *rt, int width, int height, WorkerPool *pool);
+
+// ROIs may only be added before the first frame; each returns its column
+// index in the trace matrix through pIndex (may be NULL)
+unsigned int RtAddRectangle(RoiTraces *rt, int left, int bottom, int right, int top, int *pIndex);
+unsigned int RtAddPixels(RoiTraces *rt, const uint32_t *indices, int count, int *pIndex);
+unsigned int RtAddMask(RoiTraces *rt, const BYTE *mask, int *pIndex);
+
+// Appends one row of ROI means for the frame
+unsigned int RtAddFrame(RoiTraces *rt, const WORD *frame, double timestamp);
+
+int RtGetFrameCount(const RoiTraces *rt);
+const float *RtGetTraceRow(const RoiTraces *rt, int frame);
+
+// Writes the matrix as CSV, one line per frame: time, roi0, roi1, ...
+unsigned int RtWriteCsv(const RoiTraces *rt, const char *filename);
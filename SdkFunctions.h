@@ -0,0 +1,371 @@
+// SdkFunctions.h : Every entry point declared in ATMCD32D.H, as an X-macro list.
+//
+// Define SDK_FUNCTION(name) before including. Generated from the SDK header;
+// regenerate it and SdkInterpose.h when the SDK is updated.
+
+SDK_FUNCTION(AbortAcquisition)
+SDK_FUNCTION(CancelWait)
+SDK_FUNCTION(CoolerOFF)
+SDK_FUNCTION(CoolerON)
+SDK_FUNCTION(DemosaicImage)
+SDK_FUNCTION(EnableKeepCleans)
+SDK_FUNCTION(FreeInternalMemory)
+SDK_FUNCTION(GetAcquiredData)
+SDK_FUNCTION(GetAcquiredData16)
+SDK_FUNCTION(GetAcquiredFloatData)
+SDK_FUNCTION(GetAcquisitionProgress)
+SDK_FUNCTION(GetAcquisitionTimings)
+SDK_FUNCTION(GetAdjustedRingExposureTimes)
+SDK_FUNCTION(GetAllDMAData)
+SDK_FUNCTION(GetAmpDesc)
+SDK_FUNCTION(GetAmpMaxSpeed)
+SDK_FUNCTION(GetAvailableCameras)
+SDK_FUNCTION(GetBackground)
+SDK_FUNCTION(GetBaselineClamp)
+SDK_FUNCTION(GetBitDepth)
+SDK_FUNCTION(GetCameraEventStatus)
+SDK_FUNCTION(GetCameraHandle)
+SDK_FUNCTION(GetCameraInformation)
+SDK_FUNCTION(GetCameraSerialNumber)
+SDK_FUNCTION(GetCapabilities)
+SDK_FUNCTION(GetControllerCardModel)
+SDK_FUNCTION(GetCountConvertWavelengthRange)
+SDK_FUNCTION(GetCurrentCamera)
+SDK_FUNCTION(GetCYMGShift)
+SDK_FUNCTION(GetDDGExternalOutputEnabled)
+SDK_FUNCTION(GetDDGExternalOutputPolarity)
+SDK_FUNCTION(GetDDGExternalOutputStepEnabled)
+SDK_FUNCTION(GetDDGExternalOutputTime)
+SDK_FUNCTION(GetDDGTTLGateWidth)
+SDK_FUNCTION(GetDDGGateTime)
+SDK_FUNCTION(GetDDGInsertionDelay)
+SDK_FUNCTION(GetDDGIntelligate)
+SDK_FUNCTION(GetDDGIOC)
+SDK_FUNCTION(GetDDGIOCFrequency)
+SDK_FUNCTION(GetDDGIOCNumber)
+SDK_FUNCTION(GetDDGIOCNumberRequested)
+SDK_FUNCTION(GetDDGIOCPeriod)
+SDK_FUNCTION(GetDDGIOCPulses)
+SDK_FUNCTION(GetDDGIOCTrigger)
+SDK_FUNCTION(GetDDGOpticalWidthEnabled)
+SDK_FUNCTION(GetDDGLiteGlobalControlByte)
+SDK_FUNCTION(GetDDGLiteControlByte)
+SDK_FUNCTION(GetDDGLiteInitialDelay)
+SDK_FUNCTION(GetDDGLitePulseWidth)
+SDK_FUNCTION(GetDDGLiteInterPulseDelay)
+SDK_FUNCTION(GetDDGLitePulsesPerExposure)
+SDK_FUNCTION(GetDDGPulse)
+SDK_FUNCTION(GetDDGStepCoefficients)
+SDK_FUNCTION(GetDDGWidthStepCoefficients)
+SDK_FUNCTION(GetDDGStepMode)
+SDK_FUNCTION(GetDDGWidthStepMode)
+SDK_FUNCTION(GetDetector)
+SDK_FUNCTION(GetDICameraInfo)
+SDK_FUNCTION(GetEMAdvanced)
+SDK_FUNCTION(GetEMCCDGain)
+SDK_FUNCTION(GetEMGainRange)
+SDK_FUNCTION(GetExternalTriggerTermination)
+SDK_FUNCTION(GetFastestRecommendedVSSpeed)
+SDK_FUNCTION(GetFIFOUsage)
+SDK_FUNCTION(GetFilterMode)
+SDK_FUNCTION(GetFKExposureTime)
+SDK_FUNCTION(GetFKVShiftSpeed)
+SDK_FUNCTION(GetFKVShiftSpeedF)
+SDK_FUNCTION(GetFrontEndStatus)
+SDK_FUNCTION(GetGateMode)
+SDK_FUNCTION(GetHardwareVersion)
+SDK_FUNCTION(GetHeadModel)
+SDK_FUNCTION(GetHorizontalSpeed)
+SDK_FUNCTION(GetHSSpeed)
+SDK_FUNCTION(GetHVflag)
+SDK_FUNCTION(GetID)
+SDK_FUNCTION(GetImageFlip)
+SDK_FUNCTION(GetImageRotate)
+SDK_FUNCTION(GetImages)
+SDK_FUNCTION(GetImages16)
+SDK_FUNCTION(GetImagesPerDMA)
+SDK_FUNCTION(GetIRQ)
+SDK_FUNCTION(GetKeepCleanTime)
+SDK_FUNCTION(GetMaximumBinning)
+SDK_FUNCTION(GetMaximumExposure)
+SDK_FUNCTION(GetMaximumNumberRingExposureTimes)
+SDK_FUNCTION(GetMCPGain)
+SDK_FUNCTION(GetMCPGainRange)
+SDK_FUNCTION(GetMCPGainTable)
+SDK_FUNCTION(GetMCPVoltage)
+SDK_FUNCTION(GetMinimumImageLength)
+SDK_FUNCTION(GetMinimumNumberInSeries)
+SDK_FUNCTION(GetMostRecentColorImage16)
+SDK_FUNCTION(GetMostRecentImage)
+SDK_FUNCTION(GetMostRecentImage16)
+SDK_FUNCTION(GetMSTimingsData)
+SDK_FUNCTION(GetMetaDataInfo)
+SDK_FUNCTION(GetMSTimingsEnabled)
+SDK_FUNCTION(GetRelativeImageTimes)
+SDK_FUNCTION(GetNewData)
+SDK_FUNCTION(GetNewData16)
+SDK_FUNCTION(GetNewData8)
+SDK_FUNCTION(GetNewFloatData)
+SDK_FUNCTION(GetNumberADChannels)
+SDK_FUNCTION(GetNumberAmp)
+SDK_FUNCTION(GetNumberAvailableImages)
+SDK_FUNCTION(GetNumberDDGExternalOutputs)
+SDK_FUNCTION(GetNumberDevices)
+SDK_FUNCTION(GetNumberFKVShiftSpeeds)
+SDK_FUNCTION(GetNumberHorizontalSpeeds)
+SDK_FUNCTION(GetNumberHSSpeeds)
+SDK_FUNCTION(GetNumberNewImages)
+SDK_FUNCTION(GetNumberPhotonCountingDivisions)
+SDK_FUNCTION(GetNumberPreAmpGains)
+SDK_FUNCTION(GetNumberRingExposureTimes)
+SDK_FUNCTION(GetNumberIO)
+SDK_FUNCTION(GetNumberVerticalSpeeds)
+SDK_FUNCTION(GetNumberVSAmplitudes)
+SDK_FUNCTION(GetNumberVSSpeeds)
+SDK_FUNCTION(GetOldestImage)
+SDK_FUNCTION(GetOldestImage16)
+SDK_FUNCTION(GetPhosphorStatus)
+SDK_FUNCTION(GetPhysicalDMAAddress)
+SDK_FUNCTION(GetPixelSize)
+SDK_FUNCTION(GetPreAmpGain)
+SDK_FUNCTION(GetPreAmpGainText)
+SDK_FUNCTION(GetDualExposureTimes)
+SDK_FUNCTION(GetQE)
+SDK_FUNCTION(GetReadOutTime)
+SDK_FUNCTION(GetRegisterDump)
+SDK_FUNCTION(GetRingExposureRange)
+SDK_FUNCTION(GetSDK3Handle)
+SDK_FUNCTION(GetSensitivity)
+SDK_FUNCTION(GetShutterMinTimes)
+SDK_FUNCTION(GetSizeOfCircularBuffer)
+SDK_FUNCTION(GetSlotBusDeviceFunction)
+SDK_FUNCTION(GetSoftwareVersion)
+SDK_FUNCTION(GetSpoolProgress)
+SDK_FUNCTION(GetStartUpTime)
+SDK_FUNCTION(GetStatus)
+SDK_FUNCTION(GetTECStatus)
+SDK_FUNCTION(GetTemperature)
+SDK_FUNCTION(GetTemperatureF)
+SDK_FUNCTION(GetTemperatureRange)
+SDK_FUNCTION(GetTemperatureStatus)
+SDK_FUNCTION(GetTotalNumberImagesAcquired)
+SDK_FUNCTION(GetIODirection)
+SDK_FUNCTION(GetIOLevel)
+SDK_FUNCTION(GetVersionInfo)
+SDK_FUNCTION(GetVerticalSpeed)
+SDK_FUNCTION(GetVirtualDMAAddress)
+SDK_FUNCTION(GetVSAmplitudeString)
+SDK_FUNCTION(GetVSAmplitudeFromString)
+SDK_FUNCTION(GetVSAmplitudeValue)
+SDK_FUNCTION(GetVSSpeed)
+SDK_FUNCTION(GPIBReceive)
+SDK_FUNCTION(GPIBSend)
+SDK_FUNCTION(I2CBurstRead)
+SDK_FUNCTION(I2CBurstWrite)
+SDK_FUNCTION(I2CRead)
+SDK_FUNCTION(I2CReset)
+SDK_FUNCTION(I2CWrite)
+SDK_FUNCTION(IdAndorDll)
+SDK_FUNCTION(InAuxPort)
+SDK_FUNCTION(Initialize)
+SDK_FUNCTION(InitializeDevice)
+SDK_FUNCTION(IsAmplifierAvailable)
+SDK_FUNCTION(IsCoolerOn)
+SDK_FUNCTION(IsCountConvertModeAvailable)
+SDK_FUNCTION(IsInternalMechanicalShutter)
+SDK_FUNCTION(IsPreAmpGainAvailable)
+SDK_FUNCTION(IsTriggerModeAvailable)
+SDK_FUNCTION(Merge)
+SDK_FUNCTION(OutAuxPort)
+SDK_FUNCTION(PrepareAcquisition)
+SDK_FUNCTION(SaveAsBmp)
+SDK_FUNCTION(SaveAsCommentedSif)
+SDK_FUNCTION(SaveAsEDF)
+SDK_FUNCTION(SaveAsFITS)
+SDK_FUNCTION(SaveAsRaw)
+SDK_FUNCTION(SaveAsSif)
+SDK_FUNCTION(SaveAsSPC)
+SDK_FUNCTION(SaveAsTiff)
+SDK_FUNCTION(SaveAsTiffEx)
+SDK_FUNCTION(SaveEEPROMToFile)
+SDK_FUNCTION(SaveToClipBoard)
+SDK_FUNCTION(SelectDevice)
+SDK_FUNCTION(SendSoftwareTrigger)
+SDK_FUNCTION(SetAccumulationCycleTime)
+SDK_FUNCTION(SetAcqStatusEvent)
+SDK_FUNCTION(SetAcquisitionMode)
+SDK_FUNCTION(SetAcquisitionType)
+SDK_FUNCTION(SetADChannel)
+SDK_FUNCTION(SetAdvancedTriggerModeState)
+SDK_FUNCTION(SetBackground)
+SDK_FUNCTION(SetBaselineClamp)
+SDK_FUNCTION(SetBaselineOffset)
+SDK_FUNCTION(SetCameraLinkMode)
+SDK_FUNCTION(SetCameraStatusEnable)
+SDK_FUNCTION(SetChargeShifting)
+SDK_FUNCTION(SetComplexImage)
+SDK_FUNCTION(SetCoolerMode)
+SDK_FUNCTION(SetCountConvertMode)
+SDK_FUNCTION(SetCountConvertWavelength)
+SDK_FUNCTION(SetCropMode)
+SDK_FUNCTION(SetCurrentCamera)
+SDK_FUNCTION(SetCustomTrackHBin)
+SDK_FUNCTION(SetDataType)
+SDK_FUNCTION(SetDACOutput)
+SDK_FUNCTION(SetDACOutputScale)
+SDK_FUNCTION(SetDDGAddress)
+SDK_FUNCTION(SetDDGExternalOutputEnabled)
+SDK_FUNCTION(SetDDGExternalOutputPolarity)
+SDK_FUNCTION(SetDDGExternalOutputStepEnabled)
+SDK_FUNCTION(SetDDGExternalOutputTime)
+SDK_FUNCTION(SetDDGGain)
+SDK_FUNCTION(SetDDGGateStep)
+SDK_FUNCTION(SetDDGGateTime)
+SDK_FUNCTION(SetDDGInsertionDelay)
+SDK_FUNCTION(SetDDGIntelligate)
+SDK_FUNCTION(SetDDGIOC)
+SDK_FUNCTION(SetDDGIOCFrequency)
+SDK_FUNCTION(SetDDGIOCNumber)
+SDK_FUNCTION(SetDDGIOCPeriod)
+SDK_FUNCTION(SetDDGIOCTrigger)
+SDK_FUNCTION(SetDDGOpticalWidthEnabled)
+SDK_FUNCTION(SetDDGLiteGlobalControlByte)
+SDK_FUNCTION(SetDDGLiteControlByte)
+SDK_FUNCTION(SetDDGLiteInitialDelay)
+SDK_FUNCTION(SetDDGLitePulseWidth)
+SDK_FUNCTION(SetDDGLiteInterPulseDelay)
+SDK_FUNCTION(SetDDGLitePulsesPerExposure)
+SDK_FUNCTION(SetDDGStepCoefficients)
+SDK_FUNCTION(SetDDGWidthStepCoefficients)
+SDK_FUNCTION(SetDDGStepMode)
+SDK_FUNCTION(SetDDGWidthStepMode)
+SDK_FUNCTION(SetDDGTimes)
+SDK_FUNCTION(SetDDGTriggerMode)
+SDK_FUNCTION(SetDDGVariableGateStep)
+SDK_FUNCTION(SetDelayGenerator)
+SDK_FUNCTION(SetDMAParameters)
+SDK_FUNCTION(SetDriverEvent)
+SDK_FUNCTION(SetEMAdvanced)
+SDK_FUNCTION(SetEMCCDGain)
+SDK_FUNCTION(SetEMClockCompensation)
+SDK_FUNCTION(SetEMGainMode)
+SDK_FUNCTION(SetExposureTime)
+SDK_FUNCTION(SetExternalTriggerTermination)
+SDK_FUNCTION(SetFanMode)
+SDK_FUNCTION(SetFastExtTrigger)
+SDK_FUNCTION(SetFastKinetics)
+SDK_FUNCTION(SetFastKineticsEx)
+SDK_FUNCTION(SetFilterMode)
+SDK_FUNCTION(SetFilterParameters)
+SDK_FUNCTION(SetFKVShiftSpeed)
+SDK_FUNCTION(SetFPDP)
+SDK_FUNCTION(SetFrameTransferMode)
+SDK_FUNCTION(SetFrontEndEvent)
+SDK_FUNCTION(SetFullImage)
+SDK_FUNCTION(SetFVBHBin)
+SDK_FUNCTION(SetGain)
+SDK_FUNCTION(SetGate)
+SDK_FUNCTION(SetGateMode)
+SDK_FUNCTION(SetHighCapacity)
+SDK_FUNCTION(SetHorizontalSpeed)
+SDK_FUNCTION(SetHSSpeed)
+SDK_FUNCTION(SetImage)
+SDK_FUNCTION(SetImageFlip)
+SDK_FUNCTION(SetImageRotate)
+SDK_FUNCTION(SetIsolatedCropMode)
+SDK_FUNCTION(SetIsolatedCropModeEx)
+SDK_FUNCTION(SetKineticCycleTime)
+SDK_FUNCTION(SetMCPGain)
+SDK_FUNCTION(SetMCPGating)
+SDK_FUNCTION(SetMessageWindow)
+SDK_FUNCTION(SetMetaData)
+SDK_FUNCTION(SetMultiTrack)
+SDK_FUNCTION(SetMultiTrackHBin)
+SDK_FUNCTION(SetMultiTrackHRange)
+SDK_FUNCTION(SetMultiTrackScan)
+SDK_FUNCTION(SetNextAddress)
+SDK_FUNCTION(SetNextAddress16)
+SDK_FUNCTION(SetNumberAccumulations)
+SDK_FUNCTION(SetNumberKinetics)
+SDK_FUNCTION(SetNumberPrescans)
+SDK_FUNCTION(SetOutputAmplifier)
+SDK_FUNCTION(SetOverlapMode)
+SDK_FUNCTION(SetPCIMode)
+SDK_FUNCTION(SetPhotonCounting)
+SDK_FUNCTION(SetPhotonCountingThreshold)
+SDK_FUNCTION(SetPhosphorEvent)
+SDK_FUNCTION(SetPhotonCountingDivisions)
+SDK_FUNCTION(SetPixelMode)
+SDK_FUNCTION(SetPreAmpGain)
+SDK_FUNCTION(SetDualExposureTimes)
+SDK_FUNCTION(SetDualExposureMode)
+SDK_FUNCTION(SetRandomTracks)
+SDK_FUNCTION(SetReadMode)
+SDK_FUNCTION(SetReadoutRegisterPacking)
+SDK_FUNCTION(SetRegisterDump)
+SDK_FUNCTION(SetRingExposureTimes)
+SDK_FUNCTION(SetSaturationEvent)
+SDK_FUNCTION(SetShutter)
+SDK_FUNCTION(SetShutterEx)
+SDK_FUNCTION(SetShutters)
+SDK_FUNCTION(SetSifComment)
+SDK_FUNCTION(SetSingleTrack)
+SDK_FUNCTION(SetSingleTrackHBin)
+SDK_FUNCTION(SetSpool)
+SDK_FUNCTION(SetSpoolThreadCount)
+SDK_FUNCTION(SetStorageMode)
+SDK_FUNCTION(SetTECEvent)
+SDK_FUNCTION(SetTemperature)
+SDK_FUNCTION(SetTemperatureEvent)
+SDK_FUNCTION(SetTriggerMode)
+SDK_FUNCTION(SetTriggerInvert)
+SDK_FUNCTION(GetTriggerLevelRange)
+SDK_FUNCTION(SetTriggerLevel)
+SDK_FUNCTION(SetIODirection)
+SDK_FUNCTION(SetIOLevel)
+SDK_FUNCTION(SetUserEvent)
+SDK_FUNCTION(SetUSGenomics)
+SDK_FUNCTION(SetVerticalRowBuffer)
+SDK_FUNCTION(SetVerticalSpeed)
+SDK_FUNCTION(SetVirtualChip)
+SDK_FUNCTION(SetVSAmplitude)
+SDK_FUNCTION(SetVSSpeed)
+SDK_FUNCTION(ShutDown)
+SDK_FUNCTION(StartAcquisition)
+SDK_FUNCTION(UnMapPhysicalAddress)
+SDK_FUNCTION(WaitForAcquisition)
+SDK_FUNCTION(WaitForAcquisitionByHandle)
+SDK_FUNCTION(WaitForAcquisitionByHandleTimeOut)
+SDK_FUNCTION(WaitForAcquisitionTimeOut)
+SDK_FUNCTION(WhiteBalance)
+SDK_FUNCTION(OA_Initialize)
+SDK_FUNCTION(OA_EnableMode)
+SDK_FUNCTION(OA_GetModeAcqParams)
+SDK_FUNCTION(OA_GetUserModeNames)
+SDK_FUNCTION(OA_GetPreSetModeNames)
+SDK_FUNCTION(OA_GetNumberOfUserModes)
+SDK_FUNCTION(OA_GetNumberOfPreSetModes)
+SDK_FUNCTION(OA_GetNumberOfAcqParams)
+SDK_FUNCTION(OA_AddMode)
+SDK_FUNCTION(OA_WriteToFile)
+SDK_FUNCTION(OA_DeleteMode)
+SDK_FUNCTION(OA_SetInt)
+SDK_FUNCTION(OA_SetFloat)
+SDK_FUNCTION(OA_SetString)
+SDK_FUNCTION(OA_GetInt)
+SDK_FUNCTION(OA_GetFloat)
+SDK_FUNCTION(OA_GetString)
+SDK_FUNCTION(Filter_SetMode)
+SDK_FUNCTION(Filter_GetMode)
+SDK_FUNCTION(Filter_SetThreshold)
+SDK_FUNCTION(Filter_GetThreshold)
+SDK_FUNCTION(Filter_SetDataAveragingMode)
+SDK_FUNCTION(Filter_GetDataAveragingMode)
+SDK_FUNCTION(Filter_SetAveragingFrameCount)
+SDK_FUNCTION(Filter_GetAveragingFrameCount)
+SDK_FUNCTION(Filter_SetAveragingFactor)
+SDK_FUNCTION(Filter_GetAveragingFactor)
+SDK_FUNCTION(PostProcessNoiseFilter)
+SDK_FUNCTION(PostProcessCountConvert)
+SDK_FUNCTION(PostProcessPhotonCounting)
+SDK_FUNCTION(PostProcessDataAveraging)
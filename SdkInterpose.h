@@ -0,0 +1,378 @@
+// SdkInterpose.h : Routes every SDK entry point through SDK_INTERPOSE(name).
+//
+// Included after the SDK header by SdkProfiler.h and StreamReplay.h, which
+// define SDK_INTERPOSE(name) to yield a callable taking the call's arguments.
+// Generated from SdkFunctions.h; regenerate the two together.
+
+#pragma once
+
+#ifndef SDK_INTERPOSE
+#error SDK_INTERPOSE must be defined before including SdkInterpose.h
+#endif
+
+#define AbortAcquisition(...) SDK_INTERPOSE(AbortAcquisition)(__VA_ARGS__)
+#define CancelWait(...) SDK_INTERPOSE(CancelWait)(__VA_ARGS__)
+#define CoolerOFF(...) SDK_INTERPOSE(CoolerOFF)(__VA_ARGS__)
+#define CoolerON(...) SDK_INTERPOSE(CoolerON)(__VA_ARGS__)
+#define DemosaicImage(...) SDK_INTERPOSE(DemosaicImage)(__VA_ARGS__)
+#define EnableKeepCleans(...) SDK_INTERPOSE(EnableKeepCleans)(__VA_ARGS__)
+#define FreeInternalMemory(...) SDK_INTERPOSE(FreeInternalMemory)(__VA_ARGS__)
+#define GetAcquiredData(...) SDK_INTERPOSE(GetAcquiredData)(__VA_ARGS__)
+#define GetAcquiredData16(...) SDK_INTERPOSE(GetAcquiredData16)(__VA_ARGS__)
+#define GetAcquiredFloatData(...) SDK_INTERPOSE(GetAcquiredFloatData)(__VA_ARGS__)
+#define GetAcquisitionProgress(...) SDK_INTERPOSE(GetAcquisitionProgress)(__VA_ARGS__)
+#define GetAcquisitionTimings(...) SDK_INTERPOSE(GetAcquisitionTimings)(__VA_ARGS__)
+#define GetAdjustedRingExposureTimes(...) SDK_INTERPOSE(GetAdjustedRingExposureTimes)(__VA_ARGS__)
+#define GetAllDMAData(...) SDK_INTERPOSE(GetAllDMAData)(__VA_ARGS__)
+#define GetAmpDesc(...) SDK_INTERPOSE(GetAmpDesc)(__VA_ARGS__)
+#define GetAmpMaxSpeed(...) SDK_INTERPOSE(GetAmpMaxSpeed)(__VA_ARGS__)
+#define GetAvailableCameras(...) SDK_INTERPOSE(GetAvailableCameras)(__VA_ARGS__)
+#define GetBackground(...) SDK_INTERPOSE(GetBackground)(__VA_ARGS__)
+#define GetBaselineClamp(...) SDK_INTERPOSE(GetBaselineClamp)(__VA_ARGS__)
+#define GetBitDepth(...) SDK_INTERPOSE(GetBitDepth)(__VA_ARGS__)
+#define GetCameraEventStatus(...) SDK_INTERPOSE(GetCameraEventStatus)(__VA_ARGS__)
+#define GetCameraHandle(...) SDK_INTERPOSE(GetCameraHandle)(__VA_ARGS__)
+#define GetCameraInformation(...) SDK_INTERPOSE(GetCameraInformation)(__VA_ARGS__)
+#define GetCameraSerialNumber(...) SDK_INTERPOSE(GetCameraSerialNumber)(__VA_ARGS__)
+#define GetCapabilities(...) SDK_INTERPOSE(GetCapabilities)(__VA_ARGS__)
+#define GetControllerCardModel(...) SDK_INTERPOSE(GetControllerCardModel)(__VA_ARGS__)
+#define GetCountConvertWavelengthRange(...) SDK_INTERPOSE(GetCountConvertWavelengthRange)(__VA_ARGS__)
+#define GetCurrentCamera(...) SDK_INTERPOSE(GetCurrentCamera)(__VA_ARGS__)
+#define GetCYMGShift(...) SDK_INTERPOSE(GetCYMGShift)(__VA_ARGS__)
+#define GetDDGExternalOutputEnabled(...) SDK_INTERPOSE(GetDDGExternalOutputEnabled)(__VA_ARGS__)
+#define GetDDGExternalOutputPolarity(...) SDK_INTERPOSE(GetDDGExternalOutputPolarity)(__VA_ARGS__)
+#define GetDDGExternalOutputStepEnabled(...) SDK_INTERPOSE(GetDDGExternalOutputStepEnabled)(__VA_ARGS__)
+#define GetDDGExternalOutputTime(...) SDK_INTERPOSE(GetDDGExternalOutputTime)(__VA_ARGS__)
+#define GetDDGTTLGateWidth(...) SDK_INTERPOSE(GetDDGTTLGateWidth)(__VA_ARGS__)
+#define GetDDGGateTime(...) SDK_INTERPOSE(GetDDGGateTime)(__VA_ARGS__)
+#define GetDDGInsertionDelay(...) SDK_INTERPOSE(GetDDGInsertionDelay)(__VA_ARGS__)
+#define GetDDGIntelligate(...) SDK_INTERPOSE(GetDDGIntelligate)(__VA_ARGS__)
+#define GetDDGIOC(...) SDK_INTERPOSE(GetDDGIOC)(__VA_ARGS__)
+#define GetDDGIOCFrequency(...) SDK_INTERPOSE(GetDDGIOCFrequency)(__VA_ARGS__)
+#define GetDDGIOCNumber(...) SDK_INTERPOSE(GetDDGIOCNumber)(__VA_ARGS__)
+#define GetDDGIOCNumberRequested(...) SDK_INTERPOSE(GetDDGIOCNumberRequested)(__VA_ARGS__)
+#define GetDDGIOCPeriod(...) SDK_INTERPOSE(GetDDGIOCPeriod)(__VA_ARGS__)
+#define GetDDGIOCPulses(...) SDK_INTERPOSE(GetDDGIOCPulses)(__VA_ARGS__)
+#define GetDDGIOCTrigger(...) SDK_INTERPOSE(GetDDGIOCTrigger)(__VA_ARGS__)
+#define GetDDGOpticalWidthEnabled(...) SDK_INTERPOSE(GetDDGOpticalWidthEnabled)(__VA_ARGS__)
+#define GetDDGLiteGlobalControlByte(...) SDK_INTERPOSE(GetDDGLiteGlobalControlByte)(__VA_ARGS__)
+#define GetDDGLiteControlByte(...) SDK_INTERPOSE(GetDDGLiteControlByte)(__VA_ARGS__)
+#define GetDDGLiteInitialDelay(...) SDK_INTERPOSE(GetDDGLiteInitialDelay)(__VA_ARGS__)
+#define GetDDGLitePulseWidth(...) SDK_INTERPOSE(GetDDGLitePulseWidth)(__VA_ARGS__)
+#define GetDDGLiteInterPulseDelay(...) SDK_INTERPOSE(GetDDGLiteInterPulseDelay)(__VA_ARGS__)
+#define GetDDGLitePulsesPerExposure(...) SDK_INTERPOSE(GetDDGLitePulsesPerExposure)(__VA_ARGS__)
+#define GetDDGPulse(...) SDK_INTERPOSE(GetDDGPulse)(__VA_ARGS__)
+#define GetDDGStepCoefficients(...) SDK_INTERPOSE(GetDDGStepCoefficients)(__VA_ARGS__)
+#define GetDDGWidthStepCoefficients(...) SDK_INTERPOSE(GetDDGWidthStepCoefficients)(__VA_ARGS__)
+#define GetDDGStepMode(...) SDK_INTERPOSE(GetDDGStepMode)(__VA_ARGS__)
+#define GetDDGWidthStepMode(...) SDK_INTERPOSE(GetDDGWidthStepMode)(__VA_ARGS__)
+#define GetDetector(...) SDK_INTERPOSE(GetDetector)(__VA_ARGS__)
+#define GetDICameraInfo(...) SDK_INTERPOSE(GetDICameraInfo)(__VA_ARGS__)
+#define GetEMAdvanced(...) SDK_INTERPOSE(GetEMAdvanced)(__VA_ARGS__)
+#define GetEMCCDGain(...) SDK_INTERPOSE(GetEMCCDGain)(__VA_ARGS__)
+#define GetEMGainRange(...) SDK_INTERPOSE(GetEMGainRange)(__VA_ARGS__)
+#define GetExternalTriggerTermination(...) SDK_INTERPOSE(GetExternalTriggerTermination)(__VA_ARGS__)
+#define GetFastestRecommendedVSSpeed(...) SDK_INTERPOSE(GetFastestRecommendedVSSpeed)(__VA_ARGS__)
+#define GetFIFOUsage(...) SDK_INTERPOSE(GetFIFOUsage)(__VA_ARGS__)
+#define GetFilterMode(...) SDK_INTERPOSE(GetFilterMode)(__VA_ARGS__)
+#define GetFKExposureTime(...) SDK_INTERPOSE(GetFKExposureTime)(__VA_ARGS__)
+#define GetFKVShiftSpeed(...) SDK_INTERPOSE(GetFKVShiftSpeed)(__VA_ARGS__)
+#define GetFKVShiftSpeedF(...) SDK_INTERPOSE(GetFKVShiftSpeedF)(__VA_ARGS__)
+#define GetFrontEndStatus(...) SDK_INTERPOSE(GetFrontEndStatus)(__VA_ARGS__)
+#define GetGateMode(...) SDK_INTERPOSE(GetGateMode)(__VA_ARGS__)
+#define GetHardwareVersion(...) SDK_INTERPOSE(GetHardwareVersion)(__VA_ARGS__)
+#define GetHeadModel(...) SDK_INTERPOSE(GetHeadModel)(__VA_ARGS__)
+#define GetHorizontalSpeed(...) SDK_INTERPOSE(GetHorizontalSpeed)(__VA_ARGS__)
+#define GetHSSpeed(...) SDK_INTERPOSE(GetHSSpeed)(__VA_ARGS__)
+#define GetHVflag(...) SDK_INTERPOSE(GetHVflag)(__VA_ARGS__)
+#define GetID(...) SDK_INTERPOSE(GetID)(__VA_ARGS__)
+#define GetImageFlip(...) SDK_INTERPOSE(GetImageFlip)(__VA_ARGS__)
+#define GetImageRotate(...) SDK_INTERPOSE(GetImageRotate)(__VA_ARGS__)
+#define GetImages(...) SDK_INTERPOSE(GetImages)(__VA_ARGS__)
+#define GetImages16(...) SDK_INTERPOSE(GetImages16)(__VA_ARGS__)
+#define GetImagesPerDMA(...) SDK_INTERPOSE(GetImagesPerDMA)(__VA_ARGS__)
+#define GetIRQ(...) SDK_INTERPOSE(GetIRQ)(__VA_ARGS__)
+#define GetKeepCleanTime(...) SDK_INTERPOSE(GetKeepCleanTime)(__VA_ARGS__)
+#define GetMaximumBinning(...) SDK_INTERPOSE(GetMaximumBinning)(__VA_ARGS__)
+#define GetMaximumExposure(...) SDK_INTERPOSE(GetMaximumExposure)(__VA_ARGS__)
+#define GetMaximumNumberRingExposureTimes(...) SDK_INTERPOSE(GetMaximumNumberRingExposureTimes)(__VA_ARGS__)
+#define GetMCPGain(...) SDK_INTERPOSE(GetMCPGain)(__VA_ARGS__)
+#define GetMCPGainRange(...) SDK_INTERPOSE(GetMCPGainRange)(__VA_ARGS__)
+#define GetMCPGainTable(...) SDK_INTERPOSE(GetMCPGainTable)(__VA_ARGS__)
+#define GetMCPVoltage(...) SDK_INTERPOSE(GetMCPVoltage)(__VA_ARGS__)
+#define GetMinimumImageLength(...) SDK_INTERPOSE(GetMinimumImageLength)(__VA_ARGS__)
+#define GetMinimumNumberInSeries(...) SDK_INTERPOSE(GetMinimumNumberInSeries)(__VA_ARGS__)
+#define GetMostRecentColorImage16(...) SDK_INTERPOSE(GetMostRecentColorImage16)(__VA_ARGS__)
+#define GetMostRecentImage(...) SDK_INTERPOSE(GetMostRecentImage)(__VA_ARGS__)
+#define GetMostRecentImage16(...) SDK_INTERPOSE(GetMostRecentImage16)(__VA_ARGS__)
+#define GetMSTimingsData(...) SDK_INTERPOSE(GetMSTimingsData)(__VA_ARGS__)
+#define GetMetaDataInfo(...) SDK_INTERPOSE(GetMetaDataInfo)(__VA_ARGS__)
+#define GetMSTimingsEnabled(...) SDK_INTERPOSE(GetMSTimingsEnabled)(__VA_ARGS__)
+#define GetRelativeImageTimes(...) SDK_INTERPOSE(GetRelativeImageTimes)(__VA_ARGS__)
+#define GetNewData(...) SDK_INTERPOSE(GetNewData)(__VA_ARGS__)
+#define GetNewData16(...) SDK_INTERPOSE(GetNewData16)(__VA_ARGS__)
+#define GetNewData8(...) SDK_INTERPOSE(GetNewData8)(__VA_ARGS__)
+#define GetNewFloatData(...) SDK_INTERPOSE(GetNewFloatData)(__VA_ARGS__)
+#define GetNumberADChannels(...) SDK_INTERPOSE(GetNumberADChannels)(__VA_ARGS__)
+#define GetNumberAmp(...) SDK_INTERPOSE(GetNumberAmp)(__VA_ARGS__)
+#define GetNumberAvailableImages(...) SDK_INTERPOSE(GetNumberAvailableImages)(__VA_ARGS__)
+#define GetNumberDDGExternalOutputs(...) SDK_INTERPOSE(GetNumberDDGExternalOutputs)(__VA_ARGS__)
+#define GetNumberDevices(...) SDK_INTERPOSE(GetNumberDevices)(__VA_ARGS__)
+#define GetNumberFKVShiftSpeeds(...) SDK_INTERPOSE(GetNumberFKVShiftSpeeds)(__VA_ARGS__)
+#define GetNumberHorizontalSpeeds(...) SDK_INTERPOSE(GetNumberHorizontalSpeeds)(__VA_ARGS__)
+#define GetNumberHSSpeeds(...) SDK_INTERPOSE(GetNumberHSSpeeds)(__VA_ARGS__)
+#define GetNumberNewImages(...) SDK_INTERPOSE(GetNumberNewImages)(__VA_ARGS__)
+#define GetNumberPhotonCountingDivisions(...) SDK_INTERPOSE(GetNumberPhotonCountingDivisions)(__VA_ARGS__)
+#define GetNumberPreAmpGains(...) SDK_INTERPOSE(GetNumberPreAmpGains)(__VA_ARGS__)
+#define GetNumberRingExposureTimes(...) SDK_INTERPOSE(GetNumberRingExposureTimes)(__VA_ARGS__)
+#define GetNumberIO(...) SDK_INTERPOSE(GetNumberIO)(__VA_ARGS__)
+#define GetNumberVerticalSpeeds(...) SDK_INTERPOSE(GetNumberVerticalSpeeds)(__VA_ARGS__)
+#define GetNumberVSAmplitudes(...) SDK_INTERPOSE(GetNumberVSAmplitudes)(__VA_ARGS__)
+#define GetNumberVSSpeeds(...) SDK_INTERPOSE(GetNumberVSSpeeds)(__VA_ARGS__)
+#define GetOldestImage(...) SDK_INTERPOSE(GetOldestImage)(__VA_ARGS__)
+#define GetOldestImage16(...) SDK_INTERPOSE(GetOldestImage16)(__VA_ARGS__)
+#define GetPhosphorStatus(...) SDK_INTERPOSE(GetPhosphorStatus)(__VA_ARGS__)
+#define GetPhysicalDMAAddress(...) SDK_INTERPOSE(GetPhysicalDMAAddress)(__VA_ARGS__)
+#define GetPixelSize(...) SDK_INTERPOSE(GetPixelSize)(__VA_ARGS__)
+#define GetPreAmpGain(...) SDK_INTERPOSE(GetPreAmpGain)(__VA_ARGS__)
+#define GetPreAmpGainText(...) SDK_INTERPOSE(GetPreAmpGainText)(__VA_ARGS__)
+#define GetDualExposureTimes(...) SDK_INTERPOSE(GetDualExposureTimes)(__VA_ARGS__)
+#define GetQE(...) SDK_INTERPOSE(GetQE)(__VA_ARGS__)
+#define GetReadOutTime(...) SDK_INTERPOSE(GetReadOutTime)(__VA_ARGS__)
+#define GetRegisterDump(...) SDK_INTERPOSE(GetRegisterDump)(__VA_ARGS__)
+#define GetRingExposureRange(...) SDK_INTERPOSE(GetRingExposureRange)(__VA_ARGS__)
+#define GetSDK3Handle(...) SDK_INTERPOSE(GetSDK3Handle)(__VA_ARGS__)
+#define GetSensitivity(...) SDK_INTERPOSE(GetSensitivity)(__VA_ARGS__)
+#define GetShutterMinTimes(...) SDK_INTERPOSE(GetShutterMinTimes)(__VA_ARGS__)
+#define GetSizeOfCircularBuffer(...) SDK_INTERPOSE(GetSizeOfCircularBuffer)(__VA_ARGS__)
+#define GetSlotBusDeviceFunction(...) SDK_INTERPOSE(GetSlotBusDeviceFunction)(__VA_ARGS__)
+#define GetSoftwareVersion(...) SDK_INTERPOSE(GetSoftwareVersion)(__VA_ARGS__)
+#define GetSpoolProgress(...) SDK_INTERPOSE(GetSpoolProgress)(__VA_ARGS__)
+#define GetStartUpTime(...) SDK_INTERPOSE(GetStartUpTime)(__VA_ARGS__)
+#define GetStatus(...) SDK_INTERPOSE(GetStatus)(__VA_ARGS__)
+#define GetTECStatus(...) SDK_INTERPOSE(GetTECStatus)(__VA_ARGS__)
+#define GetTemperature(...) SDK_INTERPOSE(GetTemperature)(__VA_ARGS__)
+#define GetTemperatureF(...) SDK_INTERPOSE(GetTemperatureF)(__VA_ARGS__)
+#define GetTemperatureRange(...) SDK_INTERPOSE(GetTemperatureRange)(__VA_ARGS__)
+#define GetTemperatureStatus(...) SDK_INTERPOSE(GetTemperatureStatus)(__VA_ARGS__)
+#define GetTotalNumberImagesAcquired(...) SDK_INTERPOSE(GetTotalNumberImagesAcquired)(__VA_ARGS__)
+#define GetIODirection(...) SDK_INTERPOSE(GetIODirection)(__VA_ARGS__)
+#define GetIOLevel(...) SDK_INTERPOSE(GetIOLevel)(__VA_ARGS__)
+#define GetVersionInfo(...) SDK_INTERPOSE(GetVersionInfo)(__VA_ARGS__)
+#define GetVerticalSpeed(...) SDK_INTERPOSE(GetVerticalSpeed)(__VA_ARGS__)
+#define GetVirtualDMAAddress(...) SDK_INTERPOSE(GetVirtualDMAAddress)(__VA_ARGS__)
+#define GetVSAmplitudeString(...) SDK_INTERPOSE(GetVSAmplitudeString)(__VA_ARGS__)
+#define GetVSAmplitudeFromString(...) SDK_INTERPOSE(GetVSAmplitudeFromString)(__VA_ARGS__)
+#define GetVSAmplitudeValue(...) SDK_INTERPOSE(GetVSAmplitudeValue)(__VA_ARGS__)
+#define GetVSSpeed(...) SDK_INTERPOSE(GetVSSpeed)(__VA_ARGS__)
+#define GPIBReceive(...) SDK_INTERPOSE(GPIBReceive)(__VA_ARGS__)
+#define GPIBSend(...) SDK_INTERPOSE(GPIBSend)(__VA_ARGS__)
+#define I2CBurstRead(...) SDK_INTERPOSE(I2CBurstRead)(__VA_ARGS__)
+#define I2CBurstWrite(...) SDK_INTERPOSE(I2CBurstWrite)(__VA_ARGS__)
+#define I2CRead(...) SDK_INTERPOSE(I2CRead)(__VA_ARGS__)
+#define I2CReset(...) SDK_INTERPOSE(I2CReset)(__VA_ARGS__)
+#define I2CWrite(...) SDK_INTERPOSE(I2CWrite)(__VA_ARGS__)
+#define IdAndorDll(...) SDK_INTERPOSE(IdAndorDll)(__VA_ARGS__)
+#define InAuxPort(...) SDK_INTERPOSE(InAuxPort)(__VA_ARGS__)
+#define Initialize(...) SDK_INTERPOSE(Initialize)(__VA_ARGS__)
+#define InitializeDevice(...) SDK_INTERPOSE(InitializeDevice)(__VA_ARGS__)
+#define IsAmplifierAvailable(...) SDK_INTERPOSE(IsAmplifierAvailable)(__VA_ARGS__)
+#define IsCoolerOn(...) SDK_INTERPOSE(IsCoolerOn)(__VA_ARGS__)
+#define IsCountConvertModeAvailable(...) SDK_INTERPOSE(IsCountConvertModeAvailable)(__VA_ARGS__)
+#define IsInternalMechanicalShutter(...) SDK_INTERPOSE(IsInternalMechanicalShutter)(__VA_ARGS__)
+#define IsPreAmpGainAvailable(...) SDK_INTERPOSE(IsPreAmpGainAvailable)(__VA_ARGS__)
+#define IsTriggerModeAvailable(...) SDK_INTERPOSE(IsTriggerModeAvailable)(__VA_ARGS__)
+#define Merge(...) SDK_INTERPOSE(Merge)(__VA_ARGS__)
+#define OutAuxPort(...) SDK_INTERPOSE(OutAuxPort)(__VA_ARGS__)
+#define PrepareAcquisition(...) SDK_INTERPOSE(PrepareAcquisition)(__VA_ARGS__)
+#define SaveAsBmp(...) SDK_INTERPOSE(SaveAsBmp)(__VA_ARGS__)
+#define SaveAsCommentedSif(...) SDK_INTERPOSE(SaveAsCommentedSif)(__VA_ARGS__)
+#define SaveAsEDF(...) SDK_INTERPOSE(SaveAsEDF)(__VA_ARGS__)
+#define SaveAsFITS(...) SDK_INTERPOSE(SaveAsFITS)(__VA_ARGS__)
+#define SaveAsRaw(...) SDK_INTERPOSE(SaveAsRaw)(__VA_ARGS__)
+#define SaveAsSif(...) SDK_INTERPOSE(SaveAsSif)(__VA_ARGS__)
+#define SaveAsSPC(...) SDK_INTERPOSE(SaveAsSPC)(__VA_ARGS__)
+#define SaveAsTiff(...) SDK_INTERPOSE(SaveAsTiff)(__VA_ARGS__)
+#define SaveAsTiffEx(...) SDK_INTERPOSE(SaveAsTiffEx)(__VA_ARGS__)
+#define SaveEEPROMToFile(...) SDK_INTERPOSE(SaveEEPROMToFile)(__VA_ARGS__)
+#define SaveToClipBoard(...) SDK_INTERPOSE(SaveToClipBoard)(__VA_ARGS__)
+#define SelectDevice(...) SDK_INTERPOSE(SelectDevice)(__VA_ARGS__)
+#define SendSoftwareTrigger(...) SDK_INTERPOSE(SendSoftwareTrigger)(__VA_ARGS__)
+#define SetAccumulationCycleTime(...) SDK_INTERPOSE(SetAccumulationCycleTime)(__VA_ARGS__)
+#define SetAcqStatusEvent(...) SDK_INTERPOSE(SetAcqStatusEvent)(__VA_ARGS__)
+#define SetAcquisitionMode(...) SDK_INTERPOSE(SetAcquisitionMode)(__VA_ARGS__)
+#define SetAcquisitionType(...) SDK_INTERPOSE(SetAcquisitionType)(__VA_ARGS__)
+#define SetADChannel(...) SDK_INTERPOSE(SetADChannel)(__VA_ARGS__)
+#define SetAdvancedTriggerModeState(...) SDK_INTERPOSE(SetAdvancedTriggerModeState)(__VA_ARGS__)
+#define SetBackground(...) SDK_INTERPOSE(SetBackground)(__VA_ARGS__)
+#define SetBaselineClamp(...) SDK_INTERPOSE(SetBaselineClamp)(__VA_ARGS__)
+#define SetBaselineOffset(...) SDK_INTERPOSE(SetBaselineOffset)(__VA_ARGS__)
+#define SetCameraLinkMode(...) SDK_INTERPOSE(SetCameraLinkMode)(__VA_ARGS__)
+#define SetCameraStatusEnable(...) SDK_INTERPOSE(SetCameraStatusEnable)(__VA_ARGS__)
+#define SetChargeShifting(...) SDK_INTERPOSE(SetChargeShifting)(__VA_ARGS__)
+#define SetComplexImage(...) SDK_INTERPOSE(SetComplexImage)(__VA_ARGS__)
+#define SetCoolerMode(...) SDK_INTERPOSE(SetCoolerMode)(__VA_ARGS__)
+#define SetCountConvertMode(...) SDK_INTERPOSE(SetCountConvertMode)(__VA_ARGS__)
+#define SetCountConvertWavelength(...) SDK_INTERPOSE(SetCountConvertWavelength)(__VA_ARGS__)
+#define SetCropMode(...) SDK_INTERPOSE(SetCropMode)(__VA_ARGS__)
+#define SetCurrentCamera(...) SDK_INTERPOSE(SetCurrentCamera)(__VA_ARGS__)
+#define SetCustomTrackHBin(...) SDK_INTERPOSE(SetCustomTrackHBin)(__VA_ARGS__)
+#define SetDataType(...) SDK_INTERPOSE(SetDataType)(__VA_ARGS__)
+#define SetDACOutput(...) SDK_INTERPOSE(SetDACOutput)(__VA_ARGS__)
+#define SetDACOutputScale(...) SDK_INTERPOSE(SetDACOutputScale)(__VA_ARGS__)
+#define SetDDGAddress(...) SDK_INTERPOSE(SetDDGAddress)(__VA_ARGS__)
+#define SetDDGExternalOutputEnabled(...) SDK_INTERPOSE(SetDDGExternalOutputEnabled)(__VA_ARGS__)
+#define SetDDGExternalOutputPolarity(...) SDK_INTERPOSE(SetDDGExternalOutputPolarity)(__VA_ARGS__)
+#define SetDDGExternalOutputStepEnabled(...) SDK_INTERPOSE(SetDDGExternalOutputStepEnabled)(__VA_ARGS__)
+#define SetDDGExternalOutputTime(...) SDK_INTERPOSE(SetDDGExternalOutputTime)(__VA_ARGS__)
+#define SetDDGGain(...) SDK_INTERPOSE(SetDDGGain)(__VA_ARGS__)
+#define SetDDGGateStep(...) SDK_INTERPOSE(SetDDGGateStep)(__VA_ARGS__)
+#define SetDDGGateTime(...) SDK_INTERPOSE(SetDDGGateTime)(__VA_ARGS__)
+#define SetDDGInsertionDelay(...) SDK_INTERPOSE(SetDDGInsertionDelay)(__VA_ARGS__)
+#define SetDDGIntelligate(...) SDK_INTERPOSE(SetDDGIntelligate)(__VA_ARGS__)
+#define SetDDGIOC(...) SDK_INTERPOSE(SetDDGIOC)(__VA_ARGS__)
+#define SetDDGIOCFrequency(...) SDK_INTERPOSE(SetDDGIOCFrequency)(__VA_ARGS__)
+#define SetDDGIOCNumber(...) SDK_INTERPOSE(SetDDGIOCNumber)(__VA_ARGS__)
+#define SetDDGIOCPeriod(...) SDK_INTERPOSE(SetDDGIOCPeriod)(__VA_ARGS__)
+#define SetDDGIOCTrigger(...) SDK_INTERPOSE(SetDDGIOCTrigger)(__VA_ARGS__)
+#define SetDDGOpticalWidthEnabled(...) SDK_INTERPOSE(SetDDGOpticalWidthEnabled)(__VA_ARGS__)
+#define SetDDGLiteGlobalControlByte(...) SDK_INTERPOSE(SetDDGLiteGlobalControlByte)(__VA_ARGS__)
+#define SetDDGLiteControlByte(...) SDK_INTERPOSE(SetDDGLiteControlByte)(__VA_ARGS__)
+#define SetDDGLiteInitialDelay(...) SDK_INTERPOSE(SetDDGLiteInitialDelay)(__VA_ARGS__)
+#define SetDDGLitePulseWidth(...) SDK_INTERPOSE(SetDDGLitePulseWidth)(__VA_ARGS__)
+#define SetDDGLiteInterPulseDelay(...) SDK_INTERPOSE(SetDDGLiteInterPulseDelay)(__VA_ARGS__)
+#define SetDDGLitePulsesPerExposure(...) SDK_INTERPOSE(SetDDGLitePulsesPerExposure)(__VA_ARGS__)
+#define SetDDGStepCoefficients(...) SDK_INTERPOSE(SetDDGStepCoefficients)(__VA_ARGS__)
+#define SetDDGWidthStepCoefficients(...) SDK_INTERPOSE(SetDDGWidthStepCoefficients)(__VA_ARGS__)
+#define SetDDGStepMode(...) SDK_INTERPOSE(SetDDGStepMode)(__VA_ARGS__)
+#define SetDDGWidthStepMode(...) SDK_INTERPOSE(SetDDGWidthStepMode)(__VA_ARGS__)
+#define SetDDGTimes(...) SDK_INTERPOSE(SetDDGTimes)(__VA_ARGS__)
+#define SetDDGTriggerMode(...) SDK_INTERPOSE(SetDDGTriggerMode)(__VA_ARGS__)
+#define SetDDGVariableGateStep(...) SDK_INTERPOSE(SetDDGVariableGateStep)(__VA_ARGS__)
+#define SetDelayGenerator(...) SDK_INTERPOSE(SetDelayGenerator)(__VA_ARGS__)
+#define SetDMAParameters(...) SDK_INTERPOSE(SetDMAParameters)(__VA_ARGS__)
+#define SetDriverEvent(...) SDK_INTERPOSE(SetDriverEvent)(__VA_ARGS__)
+#define SetEMAdvanced(...) SDK_INTERPOSE(SetEMAdvanced)(__VA_ARGS__)
+#define SetEMCCDGain(...) SDK_INTERPOSE(SetEMCCDGain)(__VA_ARGS__)
+#define SetEMClockCompensation(...) SDK_INTERPOSE(SetEMClockCompensation)(__VA_ARGS__)
+#define SetEMGainMode(...) SDK_INTERPOSE(SetEMGainMode)(__VA_ARGS__)
+#define SetExposureTime(...) SDK_INTERPOSE(SetExposureTime)(__VA_ARGS__)
+#define SetExternalTriggerTermination(...) SDK_INTERPOSE(SetExternalTriggerTermination)(__VA_ARGS__)
+#define SetFanMode(...) SDK_INTERPOSE(SetFanMode)(__VA_ARGS__)
+#define SetFastExtTrigger(...) SDK_INTERPOSE(SetFastExtTrigger)(__VA_ARGS__)
+#define SetFastKinetics(...) SDK_INTERPOSE(SetFastKinetics)(__VA_ARGS__)
+#define SetFastKineticsEx(...) SDK_INTERPOSE(SetFastKineticsEx)(__VA_ARGS__)
+#define SetFilterMode(...) SDK_INTERPOSE(SetFilterMode)(__VA_ARGS__)
+#define SetFilterParameters(...) SDK_INTERPOSE(SetFilterParameters)(__VA_ARGS__)
+#define SetFKVShiftSpeed(...) SDK_INTERPOSE(SetFKVShiftSpeed)(__VA_ARGS__)
+#define SetFPDP(...) SDK_INTERPOSE(SetFPDP)(__VA_ARGS__)
+#define SetFrameTransferMode(...) SDK_INTERPOSE(SetFrameTransferMode)(__VA_ARGS__)
+#define SetFrontEndEvent(...) SDK_INTERPOSE(SetFrontEndEvent)(__VA_ARGS__)
+#define SetFullImage(...) SDK_INTERPOSE(SetFullImage)(__VA_ARGS__)
+#define SetFVBHBin(...) SDK_INTERPOSE(SetFVBHBin)(__VA_ARGS__)
+#define SetGain(...) SDK_INTERPOSE(SetGain)(__VA_ARGS__)
+#define SetGate(...) SDK_INTERPOSE(SetGate)(__VA_ARGS__)
+#define SetGateMode(...) SDK_INTERPOSE(SetGateMode)(__VA_ARGS__)
+#define SetHighCapacity(...) SDK_INTERPOSE(SetHighCapacity)(__VA_ARGS__)
+#define SetHorizontalSpeed(...) SDK_INTERPOSE(SetHorizontalSpeed)(__VA_ARGS__)
+#define SetHSSpeed(...) SDK_INTERPOSE(SetHSSpeed)(__VA_ARGS__)
+#define SetImage(...) SDK_INTERPOSE(SetImage)(__VA_ARGS__)
+#define SetImageFlip(...) SDK_INTERPOSE(SetImageFlip)(__VA_ARGS__)
+#define SetImageRotate(...) SDK_INTERPOSE(SetImageRotate)(__VA_ARGS__)
+#define SetIsolatedCropMode(...) SDK_INTERPOSE(SetIsolatedCropMode)(__VA_ARGS__)
+#define SetIsolatedCropModeEx(...) SDK_INTERPOSE(SetIsolatedCropModeEx)(__VA_ARGS__)
+#define SetKineticCycleTime(...) SDK_INTERPOSE(SetKineticCycleTime)(__VA_ARGS__)
+#define SetMCPGain(...) SDK_INTERPOSE(SetMCPGain)(__VA_ARGS__)
+#define SetMCPGating(...) SDK_INTERPOSE(SetMCPGating)(__VA_ARGS__)
+#define SetMessageWindow(...) SDK_INTERPOSE(SetMessageWindow)(__VA_ARGS__)
+#define SetMetaData(...) SDK_INTERPOSE(SetMetaData)(__VA_ARGS__)
+#define SetMultiTrack(...) SDK_INTERPOSE(SetMultiTrack)(__VA_ARGS__)
+#define SetMultiTrackHBin(...) SDK_INTERPOSE(SetMultiTrackHBin)(__VA_ARGS__)
+#define SetMultiTrackHRange(...) SDK_INTERPOSE(SetMultiTrackHRange)(__VA_ARGS__)
+#define SetMultiTrackScan(...) SDK_INTERPOSE(SetMultiTrackScan)(__VA_ARGS__)
+#define SetNextAddress(...) SDK_INTERPOSE(SetNextAddress)(__VA_ARGS__)
+#define SetNextAddress16(...) SDK_INTERPOSE(SetNextAddress16)(__VA_ARGS__)
+#define SetNumberAccumulations(...) SDK_INTERPOSE(SetNumberAccumulations)(__VA_ARGS__)
+#define SetNumberKinetics(...) SDK_INTERPOSE(SetNumberKinetics)(__VA_ARGS__)
+#define SetNumberPrescans(...) SDK_INTERPOSE(SetNumberPrescans)(__VA_ARGS__)
+#define SetOutputAmplifier(...) SDK_INTERPOSE(SetOutputAmplifier)(__VA_ARGS__)
+#define SetOverlapMode(...) SDK_INTERPOSE(SetOverlapMode)(__VA_ARGS__)
+#define SetPCIMode(...) SDK_INTERPOSE(SetPCIMode)(__VA_ARGS__)
+#define SetPhotonCounting(...) SDK_INTERPOSE(SetPhotonCounting)(__VA_ARGS__)
+#define SetPhotonCountingThreshold(...) SDK_INTERPOSE(SetPhotonCountingThreshold)(__VA_ARGS__)
+#define SetPhosphorEvent(...) SDK_INTERPOSE(SetPhosphorEvent)(__VA_ARGS__)
+#define SetPhotonCountingDivisions(...) SDK_INTERPOSE(SetPhotonCountingDivisions)(__VA_ARGS__)
+#define SetPixelMode(...) SDK_INTERPOSE(SetPixelMode)(__VA_ARGS__)
+#define SetPreAmpGain(...) SDK_INTERPOSE(SetPreAmpGain)(__VA_ARGS__)
+#define SetDualExposureTimes(...) SDK_INTERPOSE(SetDualExposureTimes)(__VA_ARGS__)
+#define SetDualExposureMode(...) SDK_INTERPOSE(SetDualExposureMode)(__VA_ARGS__)
+#define SetRandomTracks(...) SDK_INTERPOSE(SetRandomTracks)(__VA_ARGS__)
+#define SetReadMode(...) SDK_INTERPOSE(SetReadMode)(__VA_ARGS__)
+#define SetReadoutRegisterPacking(...) SDK_INTERPOSE(SetReadoutRegisterPacking)(__VA_ARGS__)
+#define SetRegisterDump(...) SDK_INTERPOSE(SetRegisterDump)(__VA_ARGS__)
+#define SetRingExposureTimes(...) SDK_INTERPOSE(SetRingExposureTimes)(__VA_ARGS__)
+#define SetSaturationEvent(...) SDK_INTERPOSE(SetSaturationEvent)(__VA_ARGS__)
+#define SetShutter(...) SDK_INTERPOSE(SetShutter)(__VA_ARGS__)
+#define SetShutterEx(...) SDK_INTERPOSE(SetShutterEx)(__VA_ARGS__)
+#define SetShutters(...) SDK_INTERPOSE(SetShutters)(__VA_ARGS__)
+#define SetSifComment(...) SDK_INTERPOSE(SetSifComment)(__VA_ARGS__)
+#define SetSingleTrack(...) SDK_INTERPOSE(SetSingleTrack)(__VA_ARGS__)
+#define SetSingleTrackHBin(...) SDK_INTERPOSE(SetSingleTrackHBin)(__VA_ARGS__)
+#define SetSpool(...) SDK_INTERPOSE(SetSpool)(__VA_ARGS__)
+#define SetSpoolThreadCount(...) SDK_INTERPOSE(SetSpoolThreadCount)(__VA_ARGS__)
+#define SetStorageMode(...) SDK_INTERPOSE(SetStorageMode)(__VA_ARGS__)
+#define SetTECEvent(...) SDK_INTERPOSE(SetTECEvent)(__VA_ARGS__)
+#define SetTemperature(...) SDK_INTERPOSE(SetTemperature)(__VA_ARGS__)
+#define SetTemperatureEvent(...) SDK_INTERPOSE(SetTemperatureEvent)(__VA_ARGS__)
+#define SetTriggerMode(...) SDK_INTERPOSE(SetTriggerMode)(__VA_ARGS__)
+#define SetTriggerInvert(...) SDK_INTERPOSE(SetTriggerInvert)(__VA_ARGS__)
+#define GetTriggerLevelRange(...) SDK_INTERPOSE(GetTriggerLevelRange)(__VA_ARGS__)
+#define SetTriggerLevel(...) SDK_INTERPOSE(SetTriggerLevel)(__VA_ARGS__)
+#define SetIODirection(...) SDK_INTERPOSE(SetIODirection)(__VA_ARGS__)
+#define SetIOLevel(...) SDK_INTERPOSE(SetIOLevel)(__VA_ARGS__)
+#define SetUserEvent(...) SDK_INTERPOSE(SetUserEvent)(__VA_ARGS__)
+#define SetUSGenomics(...) SDK_INTERPOSE(SetUSGenomics)(__VA_ARGS__)
+#define SetVerticalRowBuffer(...) SDK_INTERPOSE(SetVerticalRowBuffer)(__VA_ARGS__)
+#define SetVerticalSpeed(...) SDK_INTERPOSE(SetVerticalSpeed)(__VA_ARGS__)
+#define SetVirtualChip(...) SDK_INTERPOSE(SetVirtualChip)(__VA_ARGS__)
+#define SetVSAmplitude(...) SDK_INTERPOSE(SetVSAmplitude)(__VA_ARGS__)
+#define SetVSSpeed(...) SDK_INTERPOSE(SetVSSpeed)(__VA_ARGS__)
+#define ShutDown(...) SDK_INTERPOSE(ShutDown)(__VA_ARGS__)
+#define StartAcquisition(...) SDK_INTERPOSE(StartAcquisition)(__VA_ARGS__)
+#define UnMapPhysicalAddress(...) SDK_INTERPOSE(UnMapPhysicalAddress)(__VA_ARGS__)
+#define WaitForAcquisition(...) SDK_INTERPOSE(WaitForAcquisition)(__VA_ARGS__)
+#define WaitForAcquisitionByHandle(...) SDK_INTERPOSE(WaitForAcquisitionByHandle)(__VA_ARGS__)
+#define WaitForAcquisitionByHandleTimeOut(...) SDK_INTERPOSE(WaitForAcquisitionByHandleTimeOut)(__VA_ARGS__)
+#define WaitForAcquisitionTimeOut(...) SDK_INTERPOSE(WaitForAcquisitionTimeOut)(__VA_ARGS__)
+#define WhiteBalance(...) SDK_INTERPOSE(WhiteBalance)(__VA_ARGS__)
+#define OA_Initialize(...) SDK_INTERPOSE(OA_Initialize)(__VA_ARGS__)
+#define OA_EnableMode(...) SDK_INTERPOSE(OA_EnableMode)(__VA_ARGS__)
+#define OA_GetModeAcqParams(...) SDK_INTERPOSE(OA_GetModeAcqParams)(__VA_ARGS__)
+#define OA_GetUserModeNames(...) SDK_INTERPOSE(OA_GetUserModeNames)(__VA_ARGS__)
+#define OA_GetPreSetModeNames(...) SDK_INTERPOSE(OA_GetPreSetModeNames)(__VA_ARGS__)
+#define OA_GetNumberOfUserModes(...) SDK_INTERPOSE(OA_GetNumberOfUserModes)(__VA_ARGS__)
+#define OA_GetNumberOfPreSetModes(...) SDK_INTERPOSE(OA_GetNumberOfPreSetModes)(__VA_ARGS__)
+#define OA_GetNumberOfAcqParams(...) SDK_INTERPOSE(OA_GetNumberOfAcqParams)(__VA_ARGS__)
+#define OA_AddMode(...) SDK_INTERPOSE(OA_AddMode)(__VA_ARGS__)
+#define OA_WriteToFile(...) SDK_INTERPOSE(OA_WriteToFile)(__VA_ARGS__)
+#define OA_DeleteMode(...) SDK_INTERPOSE(OA_DeleteMode)(__VA_ARGS__)
+#define OA_SetInt(...) SDK_INTERPOSE(OA_SetInt)(__VA_ARGS__)
+#define OA_SetFloat(...) SDK_INTERPOSE(OA_SetFloat)(__VA_ARGS__)
+#define OA_SetString(...) SDK_INTERPOSE(OA_SetString)(__VA_ARGS__)
+#define OA_GetInt(...) SDK_INTERPOSE(OA_GetInt)(__VA_ARGS__)
+#define OA_GetFloat(...) SDK_INTERPOSE(OA_GetFloat)(__VA_ARGS__)
+#define OA_GetString(...) SDK_INTERPOSE(OA_GetString)(__VA_ARGS__)
+#define Filter_SetMode(...) SDK_INTERPOSE(Filter_SetMode)(__VA_ARGS__)
+#define Filter_GetMode(...) SDK_INTERPOSE(Filter_GetMode)(__VA_ARGS__)
+#define Filter_SetThreshold(...) SDK_INTERPOSE(Filter_SetThreshold)(__VA_ARGS__)
+#define Filter_GetThreshold(...) SDK_INTERPOSE(Filter_GetThreshold)(__VA_ARGS__)
+#define Filter_SetDataAveragingMode(...) SDK_INTERPOSE(Filter_SetDataAveragingMode)(__VA_ARGS__)
+#define Filter_GetDataAveragingMode(...) SDK_INTERPOSE(Filter_GetDataAveragingMode)(__VA_ARGS__)
+#define Filter_SetAveragingFrameCount(...) SDK_INTERPOSE(Filter_SetAveragingFrameCount)(__VA_ARGS__)
+#define Filter_GetAveragingFrameCount(...) SDK_INTERPOSE(Filter_GetAveragingFrameCount)(__VA_ARGS__)
+#define Filter_SetAveragingFactor(...) SDK_INTERPOSE(Filter_SetAveragingFactor)(__VA_ARGS__)
+#define Filter_GetAveragingFactor(...) SDK_INTERPOSE(Filter_GetAveragingFactor)(__VA_ARGS__)
+#define PostProcessNoiseFilter(...) SDK_INTERPOSE(PostProcessNoiseFilter)(__VA_ARGS__)
+#define PostProcessCountConvert(...) SDK_INTERPOSE(PostProcessCountConvert)(__VA_ARGS__)
+#define PostProcessPhotonCounting(...) SDK_INTERPOSE(PostProcessPhotonCounting)(__VA_ARGS__)
+#define PostProcessDataAveraging(...) SDK_INTERPOSE(PostProcessDataAveraging)(__VA_ARGS__)
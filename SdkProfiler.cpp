@@ -0,0 +1,225 @@
+// SdkProfiler.cpp : Opt-in profiling and tracing of every SDK call.
+//
+
+#include "stdafx.h"
+#include "SdkProfiler.h"
+
+#include <algorithm>
+#include <stdio.h>
+#include <vector>
+
+static const int kSdkBuckets = 48;		// power-of-two tick ranges
+static const int kSdkCodes = 8;			// distinct return codes kept per entry point
+
+// The histogram doubles as the call count, saving an increment per call
+struct SdkStats {
+	std::atomic<uint64_t>	ticks;
+	std::atomic<uint64_t>	maxTicks;
+	std::atomic<uint64_t>	buckets[kSdkBuckets];
+	std::atomic<uint32_t>	codes[kSdkCodes];		// 0 marks a free slot
+	std::atomic<uint64_t>	codeCounts[kSdkCodes];
+	std::atomic<uint64_t>	otherCodes;
+};
+
+struct SdkTraceEvent {
+	uint64_t				start;
+	uint32_t				ticks;
+	uint16_t				id;
+	uint16_t				thread;
+	uint32_t				result;
+};
+
+std::atomic<bool> gSdkProfiling(false);
+
+static SdkStats gSdkStats[SDK_FUNCTION_COUNT];
+static std::vector<SdkTraceEvent> gSdkTrace;
+static std::atomic<size_t> gSdkTraceNext(0);
+static size_t gSdkTraceCapacity = 0;
+static std::atomic<int> gSdkThreads(0);
+static thread_local int tSdkThread = -1;
+
+// Pairs of counter and clock readings to convert ticks to time
+static uint64_t gSdkStartTicks, gSdkStopTicks;
+static std::chrono::steady_clock::time_point gSdkStartTime, gSdkStopTime;
+
+static const char *const kSdkNames[] = {
+#define SDK_FUNCTION(name) #name,
+#include "SdkFunctions.h"
+#undef SDK_FUNCTION
+};
+
+// Number of significant bits, so bucket b holds [2^(b-1), 2^b) ticks
+static int SdkBucket(uint64_t ticks)
+{
+	if (ticks == 0)
+		return 0;
+#ifdef _MSC_VER
+	unsigned long bit;
+	_BitScanReverse64(&bit, ticks);
+	int bucket = (int)bit + 1;
+#else
+	int bucket = 64 - __builtin_clzll(ticks);
+#endif
+	return bucket < kSdkBuckets ? bucket : kSdkBuckets - 1;
+}
+
+static void SdkCountCode(SdkStats &stats, unsigned int result)
+{
+	for (int slot = 0; slot < kSdkCodes; slot++) {
+		uint32_t code = stats.codes[slot].load(std::memory_order_relaxed);
+		if (code == 0) {
+			stats.codes[slot].compare_exchange_strong(code, result, std::memory_order_relaxed);
+			code = stats.codes[slot].load(std::memory_order_relaxed);
+		}
+		if (code == result) {
+			stats.codeCounts[slot].fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+	}
+	stats.otherCodes.fetch_add(1, std::memory_order_relaxed);
+}
+
+static double SdkTicksPerSecond()
+{
+	uint64_t ticks = gSdkStopTicks;
+	std::chrono::steady_clock::time_point time = gSdkStopTime;
+	if (gSdkProfiling.load()) {
+		ticks = SdkProfileTicks();
+		time = std::chrono::steady_clock::now();
+	}
+	double seconds = std::chrono::duration<double>(time - gSdkStartTime).count();
+	return seconds > 0.0 && ticks > gSdkStartTicks ? (ticks - gSdkStartTicks) / seconds : 1e9;
+}
+
+void SdkProfileRecord(int id, uint64_t start, uint64_t end, unsigned int result)
+{
+	SdkStats &stats = gSdkStats[id];
+	uint64_t ticks = end - start;
+	stats.ticks.fetch_add(ticks, std::memory_order_relaxed);
+	uint64_t worst = stats.maxTicks.load(std::memory_order_relaxed);
+	while (ticks > worst && !stats.maxTicks.compare_exchange_weak(worst, ticks, std::memory_order_relaxed))
+		;
+	stats.buckets[SdkBucket(ticks)].fetch_add(1, std::memory_order_relaxed);
+	SdkCountCode(stats, result);
+
+	if (gSdkTraceNext.load(std::memory_order_relaxed) < gSdkTraceCapacity) {
+		size_t n = gSdkTraceNext.fetch_add(1, std::memory_order_relaxed);
+		if (n < gSdkTraceCapacity) {
+			if (tSdkThread < 0)
+				tSdkThread = gSdkThreads.fetch_add(1);
+			SdkTraceEvent &event = gSdkTrace[n];
+			event.start = start;
+			event.ticks = ticks > UINT32_MAX ? UINT32_MAX : (uint32_t)ticks;
+			event.id = (uint16_t)id;
+			event.thread = (uint16_t)tSdkThread;
+			event.result = result;
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+// Public interface
+//------------------------------------------------------------------------------
+
+void SdkProfileStart(size_t traceEvents)
+{
+	gSdkProfiling = false;
+	for (SdkStats &stats : gSdkStats) {
+		stats.ticks = 0;
+		stats.maxTicks = 0;
+		for (std::atomic<uint64_t> &bucket : stats.buckets)
+			bucket = 0;
+		for (int slot = 0; slot < kSdkCodes; slot++) {
+			stats.codes[slot] = 0;
+			stats.codeCounts[slot] = 0;
+		}
+		stats.otherCodes = 0;
+	}
+	gSdkTrace.assign(traceEvents, SdkTraceEvent());
+	gSdkTraceCapacity = traceEvents;
+	gSdkTraceNext = 0;
+	gSdkStartTime = std::chrono::steady_clock::now();
+	gSdkStartTicks = SdkProfileTicks();
+	gSdkProfiling = true;
+}
+
+void SdkProfileStop()
+{
+	gSdkProfiling = false;
+	gSdkStopTicks = SdkProfileTicks();
+	gSdkStopTime = std::chrono::steady_clock::now();
+}
+
+const char *SdkFunctionName(int id)
+{
+	return id >= 0 && id < SDK_FUNCTION_COUNT ? kSdkNames[id] : "?";
+}
+
+unsigned int SdkWriteProfileCsv(const char *filename)
+{
+	if (filename == NULL)
+		return DRV_P1INVALID;
+
+	FILE *file = fopen(filename, "w");
+	if (file == NULL)
+		return DRV_ERROR_FILESAVE;
+	double nsPerTick = 1e9 / SdkTicksPerSecond();
+	fprintf(file, "function,calls,total_ms,mean_ns,p50_ns,p99_ns,max_ns,codes\n");
+	for (int id = 0; id < SDK_FUNCTION_COUNT; id++) {
+		const SdkStats &stats = gSdkStats[id];
+		uint64_t calls = 0;
+		for (const std::atomic<uint64_t> &bucket : stats.buckets)
+			calls += bucket.load();
+		if (calls == 0)
+			continue;
+		// Percentiles are reported as the upper edge of their bucket
+		double percentile[2] = { 0.0, 0.0 };
+		const double fractions[2] = { 0.5, 0.99 };
+		for (int p = 0; p < 2; p++) {
+			uint64_t wanted = (uint64_t)(calls * fractions[p]), seen = 0;
+			for (int bucket = 0; bucket < kSdkBuckets; bucket++) {
+				seen += stats.buckets[bucket].load();
+				if (seen > wanted) {
+					percentile[p] = (double)std::min((uint64_t)1 << bucket, stats.maxTicks.load()) * nsPerTick;
+					break;
+				}
+			}
+		}
+		double total = stats.ticks.load() * nsPerTick;
+		fprintf(file, "%s,%llu,%.3f,%.1f,%.1f,%.1f,%.1f,", kSdkNames[id], (unsigned long long)calls,
+			total * 1e-6, total / calls, percentile[0], percentile[1], stats.maxTicks.load() * nsPerTick);
+		for (int slot = 0; slot < kSdkCodes; slot++) {
+			uint32_t code = stats.codes[slot].load();
+			if (code)
+				fprintf(file, "%s%u:%llu", slot ? " " : "", code, (unsigned long long)stats.codeCounts[slot].load());
+		}
+		if (stats.otherCodes.load())
+			fprintf(file, " other:%llu", (unsigned long long)stats.otherCodes.load());
+		fprintf(file, "\n");
+	}
+	return fclose(file) == 0 ? DRV_SUCCESS : DRV_ERROR_FILESAVE;
+}
+
+unsigned int SdkWriteChromeTrace(const char *filename)
+{
+	if (filename == NULL)
+		return DRV_P1INVALID;
+
+	FILE *file = fopen(filename, "w");
+	if (file == NULL)
+		return DRV_ERROR_FILESAVE;
+	double usPerTick = 1e6 / SdkTicksPerSecond();
+	size_t count = gSdkTraceNext.load();
+	if (count > gSdkTraceCapacity)
+		count = gSdkTraceCapacity;
+	fprintf(file, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+	for (size_t n = 0; n < count; n++) {
+		const SdkTraceEvent &event = gSdkTrace[n];
+		fprintf(file, "%s{\"name\":\"%s\",\"cat\":\"sdk\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,"
+			"\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"result\":%u}}\n", n ? "," : "",
+			kSdkNames[event.id], event.thread, (double)(int64_t)(event.start - gSdkStartTicks) * usPerTick,
+			event.ticks * usPerTick, event.result);
+	}
+	fprintf(file, "]}\n");
+	return fclose(file) == 0 ? DRV_SUCCESS : DRV_ERROR_FILESAVE;
+}
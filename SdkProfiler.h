@@ -0,0 +1,93 @@
+// SdkProfiler.h : Opt-in profiling and tracing of every SDK call.
+//
+// With SDK_PROFILE defined, every entry point of ATMCD32D.H called after this
+// header is routed through SdkProfiled(), which times the call with the time
+// stamp counter and records it against that entry point: call count, total
+// and worst time, a power-of-two latency histogram and the return codes seen.
+// SdkProfileStart() can also keep every call as an event for a Chrome
+// trace-event timeline (chrome://tracing or Perfetto).
+//
+// To interpose on a whole build without touching the sources, add SDK_PROFILE
+// to the preprocessor definitions and SdkProfiler.h to Forced Include Files
+// (/FI); the header includes the SDK header itself, so the macros never reach
+// its declarations. Without SDK_PROFILE nothing is redirected and calls cost
+// exactly what they did. Enabled but stopped, a call costs one relaxed load;
+// recording costs two counter reads and a handful of uncontended atomic
+// increments, well under 100 ns.
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include <chrono>
+#include <utility>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+#include "SimdSupport.h"
+
+extern "C" {
+	#include "atmcd32d.h"
+}
+
+enum SdkFunctionId {
+#define SDK_FUNCTION(name) SDK_ID_##name,
+#include "SdkFunctions.h"
+#undef SDK_FUNCTION
+	SDK_FUNCTION_COUNT
+};
+
+// Clears all counts and starts recording; traceEvents > 0 also keeps up to
+// that many calls for SdkWriteChromeTrace
+void SdkProfileStart(size_t traceEvents);
+void SdkProfileStop();
+
+const char *SdkFunctionName(int id);
+// One line per entry point called: counts, latency percentiles, return codes
+unsigned int SdkWriteProfileCsv(const char *filename);
+unsigned int SdkWriteChromeTrace(const char *filename);
+
+extern std::atomic<bool> gSdkProfiling;
+void SdkProfileRecord(int id, uint64_t start, uint64_t end, unsigned int result);
+
+SIMD_INLINE uint64_t SdkProfileTicks()
+{
+#if SIMD_X86
+	return __rdtsc();
+#else
+	return (uint64_t)std::chrono::steady_clock::now().time_since_epoch().count();
+#endif
+}
+
+template <int Id, typename Fn>
+struct SdkProfiledCall {
+	Fn						fn;
+
+	template <typename... Args>
+	SIMD_INLINE unsigned int operator()(Args &&... args) const
+	{
+		if (!gSdkProfiling.load(std::memory_order_relaxed))
+			return fn(std::forward<Args>(args)...);
+		uint64_t start = SdkProfileTicks();
+		unsigned int result = fn(std::forward<Args>(args)...);
+		SdkProfileRecord(Id, start, SdkProfileTicks(), result);
+		return result;
+	}
+};
+
+template <int Id, typename Fn>
+SIMD_INLINE SdkProfiledCall<Id, Fn> SdkProfiled(Fn fn)
+{
+	return { fn };
+}
+
+#ifdef SDK_PROFILE
+#if defined(SDK_RECORD) || defined(SDK_REPLAY)
+#error SDK_PROFILE cannot be combined with SDK_RECORD or SDK_REPLAY
+#endif
+#define SDK_INTERPOSE(name) SdkProfiled<SDK_ID_##name>(::name)
+#include "SdkInterpose.h"
+#endif
@@ -0,0 +1,123 @@
+// SettingsShadow.cpp : Skips SDK setter calls whose value has not changed.
+//
+
+#include "stdafx.h"
+#include "SettingsShadow.h"
+#if defined(SDK_RECORD) || defined(SDK_REPLAY)
+#include "StreamReplay.h"
+#endif
+
+#include <chrono>
+#include <string.h>
+
+void SsDefaultSettings(AcquisitionSettings *settings, int xPixels, int yPixels)
+{
+	settings->readMode = 4;
+	settings->acquisitionMode = 1;
+	settings->exposure = 0.1f;
+	settings->triggerMode = 0;
+	settings->shutterType = 0;
+	settings->shutterMode = -1;
+	settings->shutterClosing = 0;
+	settings->shutterOpening = 0;
+	settings->hbin = 1;
+	settings->vbin = 1;
+	settings->hstart = 1;
+	settings->hend = xPixels;
+	settings->vstart = 1;
+	settings->vend = yPixels;
+	settings->numberKinetics = 1;
+	settings->numberAccumulations = 1;
+	settings->kineticCycle = 0.0f;
+	settings->accumulationCycle = 0.0f;
+}
+
+void SsInitialise(SettingsShadow *shadow)
+{
+	memset(shadow, 0, sizeof(*shadow));
+}
+
+void SsInvalidate(SettingsShadow *shadow)
+{
+	shadow->valid = false;
+	shadow->prepared = false;
+}
+
+unsigned int SsApply(SettingsShadow *shadow, const AcquisitionSettings *settings)
+{
+	if (shadow == NULL)
+		return DRV_P1INVALID;
+	if (settings == NULL)
+		return DRV_P2INVALID;
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	const AcquisitionSettings &was = shadow->applied;
+	const AcquisitionSettings &now = *settings;
+	bool all = !shadow->valid;
+	bool reshaped = false;
+	unsigned int error = DRV_SUCCESS;
+
+	// Calls setter when changed is true, counting the calls made and saved.
+	// Acquisition mode goes first: the SDK checks the others against it.
+	auto set = [&](bool changed, bool shapesBuffers, auto setter) {
+		if (error != DRV_SUCCESS)
+			return;
+		if (!all && !changed) {
+			shadow->settersSkipped++;
+			return;
+		}
+		shadow->setterCalls++;
+		error = setter();
+		reshaped = reshaped || shapesBuffers;
+	};
+	set(now.acquisitionMode != was.acquisitionMode, true, [&] { return SetAcquisitionMode(now.acquisitionMode); });
+	set(now.readMode != was.readMode, true, [&] { return SetReadMode(now.readMode); });
+	set(now.hbin != was.hbin || now.vbin != was.vbin || now.hstart != was.hstart || now.hend != was.hend
+		|| now.vstart != was.vstart || now.vend != was.vend, true,
+		[&] { return SetImage(now.hbin, now.vbin, now.hstart, now.hend, now.vstart, now.vend); });
+	set(now.exposure != was.exposure, false, [&] { return SetExposureTime(now.exposure); });
+	set(now.triggerMode != was.triggerMode, false, [&] { return SetTriggerMode(now.triggerMode); });
+	if (now.shutterMode >= 0)
+		set(now.shutterType != was.shutterType || now.shutterMode != was.shutterMode
+			|| now.shutterClosing != was.shutterClosing || now.shutterOpening != was.shutterOpening, false,
+			[&] { return SetShutter(now.shutterType, now.shutterMode, now.shutterClosing, now.shutterOpening); });
+
+	// The rest only apply in some modes, so were not necessarily set before
+	bool modeChanged = now.acquisitionMode != was.acquisitionMode;
+	if (now.acquisitionMode == 2 || now.acquisitionMode == 3) {
+		set(modeChanged || now.numberAccumulations != was.numberAccumulations, true,
+			[&] { return SetNumberAccumulations(now.numberAccumulations); });
+		set(modeChanged || now.accumulationCycle != was.accumulationCycle, false,
+			[&] { return SetAccumulationCycleTime(now.accumulationCycle); });
+	}
+	if (now.acquisitionMode == 3)
+		set(modeChanged || now.numberKinetics != was.numberKinetics, true,
+			[&] { return SetNumberKinetics(now.numberKinetics); });
+	if (now.acquisitionMode == 3 || now.acquisitionMode == 5)
+		set(modeChanged || now.kineticCycle != was.kineticCycle, false,
+			[&] { return SetKineticCycleTime(now.kineticCycle); });
+
+	if (error == DRV_SUCCESS) {
+		if (reshaped || !shadow->prepared) {
+			shadow->prepares++;
+			error = PrepareAcquisition();
+		}
+		else
+			shadow->preparesSkipped++;
+	}
+	if (error == DRV_SUCCESS) {
+		shadow->applied = now;
+		shadow->valid = true;
+		shadow->prepared = true;
+	}
+	else
+		SsInvalidate(shadow);
+
+	double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	shadow->applies++;
+	shadow->lastMs = ms;
+	shadow->totalMs += ms;
+	if (ms > shadow->maxMs)
+		shadow->maxMs = ms;
+	return error;
+}
@@ -0,0 +1,65 @@
+// SettingsShadow.h : Skips SDK setter calls whose value has not changed.
+//
+// Every acquisition re-issues SetReadMode, SetAcquisitionMode, SetImage and
+// the rest, and then PrepareAcquisition, which allocates and sizes the
+// driver's buffers, even when the next job uses the same settings. The shadow
+// remembers what was last applied successfully and only calls the setters
+// whose values differ. PrepareAcquisition is skipped unless a setting that
+// shapes the buffers changed: read mode, acquisition mode, image area, or the
+// kinetic and accumulation counts. A failed setter, or anything that changes
+// settings behind the shadow's back, must be followed by SsInvalidate() so the
+// next apply starts from scratch.
+
+#pragma once
+
+#include <stdint.h>
+
+extern "C" {
+	#include "atmcd32d.h"
+}
+
+struct AcquisitionSettings {
+	int						readMode;
+	int						acquisitionMode;
+	float					exposure;			// seconds
+	int						triggerMode;
+	int						shutterType;		// as for SetShutter
+	int						shutterMode;		// -1 leaves the shutter alone
+	int						shutterClosing;		// milliseconds
+	int						shutterOpening;
+	int						hbin;				// image area, as for SetImage
+	int						vbin;
+	int						hstart;
+	int						hend;
+	int						vstart;
+	int						vend;
+	int						numberKinetics;
+	int						numberAccumulations;
+	float					kineticCycle;		// seconds
+	float					accumulationCycle;
+};
+
+struct SettingsShadow {
+	AcquisitionSettings		applied;
+	bool					valid;				// applied matches the camera
+	bool					prepared;			// PrepareAcquisition done for applied
+
+	uint64_t				applies;
+	uint64_t				setterCalls;
+	uint64_t				settersSkipped;
+	uint64_t				prepares;
+	uint64_t				preparesSkipped;
+	double					lastMs;				// reconfiguration latency of the last apply
+	double					totalMs;
+	double					maxMs;
+};
+
+// Image mode, single scan, full frame
+void SsDefaultSettings(AcquisitionSettings *settings, int xPixels, int yPixels);
+
+void SsInitialise(SettingsShadow *shadow);
+void SsInvalidate(SettingsShadow *shadow);
+
+// Brings the camera to settings with as few SDK calls as possible. On error
+// the shadow is invalidated and the error of the failing call returned.
+unsigned int SsApply(SettingsShadow *shadow, const AcquisitionSettings *settings);
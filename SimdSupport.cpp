@@ -0,0 +1,104 @@
+// SimdSupport.cpp : Instruction set detection for the frame processing kernels.
+//
+
+#include "stdafx.h"
+#include "SimdSupport.h"
+
+#if SIMD_X86
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+static int gSimdDetected = -1;
+static int gSimdLimit = SIMD_AVX512;
+
+#if SIMD_X86
+static void SimdCpuid(int leaf, int subleaf, unsigned int regs[4])
+{
+#if defined(_MSC_VER)
+	int info[4];
+	__cpuidex(info, leaf, subleaf);
+	for (int i = 0; i < 4; i++)
+		regs[i] = (unsigned int)info[i];
+#else
+	__cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+static unsigned long long SimdXgetbv(void)
+{
+#if defined(_MSC_VER)
+	return _xgetbv(0);
+#else
+	unsigned int lo, hi;
+	__asm__ volatile ("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+	return ((unsigned long long)hi << 32) | lo;
+#endif
+}
+
+static SimdLevel SimdDetect(void)
+{
+	unsigned int regs[4];
+	SimdCpuid(0, 0, regs);
+	int maxLeaf = (int)regs[0];
+
+	SimdCpuid(1, 0, regs);
+	unsigned int ecx1 = regs[2];
+	unsigned int edx1 = regs[3];
+	if (!(edx1 & (1u << 26)))
+		return SIMD_NONE;
+	if (!(ecx1 & (1u << 20)))
+		return SIMD_SSE2;
+
+	// AVX state must also be enabled by the OS (OSXSAVE + XCR0 bits)
+	bool osAvx = (ecx1 & (1u << 27)) && (ecx1 & (1u << 28)) && (SimdXgetbv() & 0x6) == 0x6;
+	if (!osAvx || maxLeaf < 7)
+		return SIMD_SSE42;
+
+	SimdCpuid(7, 0, regs);
+	unsigned int ebx7 = regs[1];
+	bool avx2 = (ebx7 & (1u << 5)) && (ecx1 & (1u << 12)) && (ebx7 & (1u << 8));
+	if (!avx2)
+		return SIMD_SSE42;
+
+	bool avx512 = (ebx7 & (1u << 16)) && (ebx7 & (1u << 30)) && (ebx7 & (1u << 31))
+		&& (SimdXgetbv() & 0xe6) == 0xe6;
+	return avx512 ? SIMD_AVX512 : SIMD_AVX2;
+}
+#else
+static SimdLevel SimdDetect(void)
+{
+	return SIMD_NONE;
+}
+#endif
+
+SimdLevel GetSimdLevel(void)
+{
+	if (gSimdDetected < 0)
+		gSimdDetected = (int)SimdDetect();
+	return (SimdLevel)(gSimdDetected < gSimdLimit ? gSimdDetected : gSimdLimit);
+}
+
+void SetSimdLevelLimit(SimdLevel limit)
+{
+	gSimdLimit = (int)limit;
+}
+
+const char *GetSimdLevelName(SimdLevel level)
+{
+	switch (level) {
+	case SIMD_SSE2:
+		return "SSE2";
+	case SIMD_SSE42:
+		return "SSE4.2";
+	case SIMD_AVX2:
+		return "AVX2";
+	case SIMD_AVX512:
+		return "AVX-512";
+	default:
+		return "scalar";
+	}
+}
@@ -0,0 +1,69 @@
+// SimdSupport.h : Instruction set detection for the frame processing kernels.
+//
+// Kernels are built for every level in one binary and chosen at runtime with
+// GetSimdLevel(). MSVC accepts any intrinsic without /arch, GCC and Clang need
+// the per-function target attribute supplied by the SIMD_TARGET_* macros.
+
+#pragma once
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define SIMD_X86 1
+#include <immintrin.h>
+#else
+#define SIMD_X86 0
+#endif
+
+#if SIMD_X86 && (defined(__GNUC__) || defined(__clang__))
+#define SIMD_TARGET_SSE42	__attribute__((target("sse4.2")))
+#define SIMD_TARGET_AVX2	__attribute__((target("avx2,fma,bmi2")))
+#define SIMD_TARGET_AVX512	__attribute__((target("avx512f,avx512bw,avx512vl")))
+#else
+#define SIMD_TARGET_SSE42
+#define SIMD_TARGET_AVX2
+#define SIMD_TARGET_AVX512
+#endif
+
+// Kernels shared between instruction sets are written once as templates over
+// an Ops type holding the intrinsics, then instantiated inside a SIMD_TARGET_*
+// function marked SIMD_FLATTEN. Flattening pulls the template and its Ops
+// calls into the target function, which is what lets GCC inline intrinsics
+// across the target boundary; MSVC gets the same effect from SIMD_INLINE.
+//
+// Ops functions take and return vectors by value. GCC and Clang warn that the
+// ABI of such a call changes with the target, which cannot matter once the
+// calls are flattened; SIMD_BEGIN_KERNELS and SIMD_END_KERNELS silence that
+// warning for the Ops types, kernel bodies and instantiations between them
+// and leave it on for the rest of the translation unit.
+#if defined(_MSC_VER)
+#define SIMD_INLINE		__forceinline
+#define SIMD_FLATTEN
+#define SIMD_BEGIN_KERNELS
+#define SIMD_END_KERNELS
+#elif defined(__GNUC__) || defined(__clang__)
+#define SIMD_INLINE		inline
+#define SIMD_FLATTEN	__attribute__((flatten))
+#define SIMD_BEGIN_KERNELS	_Pragma("GCC diagnostic push") _Pragma("GCC diagnostic ignored \"-Wpsabi\"")
+#define SIMD_END_KERNELS	_Pragma("GCC diagnostic pop")
+#else
+#define SIMD_INLINE		inline
+#define SIMD_FLATTEN
+#define SIMD_BEGIN_KERNELS
+#define SIMD_END_KERNELS
+#endif
+
+enum SimdLevel {
+	SIMD_NONE = 0,		// portable C++ only
+	SIMD_SSE2 = 1,		// baseline for every x64 build
+	SIMD_SSE42 = 2,
+	SIMD_AVX2 = 3,		// AVX2 + FMA
+	SIMD_AVX512 = 4		// AVX-512 F/BW/VL
+};
+
+// Highest level supported by both the CPU and the OS, detected once
+SimdLevel GetSimdLevel(void);
+
+// Lower the level reported by GetSimdLevel(), e.g. to benchmark older paths.
+// Requests above what the machine supports are clamped.
+void SetSimdLevelLimit(SimdLevel limit);
+
+const char *GetSimdLevelName(SimdLevel level);
@@ -0,0 +1,273 @@
+// SpotDetector.cpp : Real-time spot detection and centroiding for beam and star tracking.
+//
+
+#include "stdafx.h"
+#include "SpotDetector.h"
+#include "SimdSupport.h"
+
+#include <algorithm>
+
+//------------------------------------------------------------------------------
+// Run extraction
+//------------------------------------------------------------------------------
+
+static void SdEmitRun(SpotDetector *sd, const WORD *row, int y, int x0, int x1)
+{
+	SpotRun run;
+	run.y = y;
+	run.x0 = x0;
+	run.x1 = x1;
+	run.peak = 0;
+	double sumW = 0.0, sumXW = 0.0, sumXXW = 0.0;
+	double baseline = (double)sd->params.baseline;
+	for (int x = x0; x <= x1; x++) {
+		double w = (double)row[x] - baseline;
+		sumW += w;
+		sumXW += w * x;
+		sumXXW += w * x * x;
+		if (row[x] > run.peak)
+			run.peak = row[x];
+	}
+	run.sumW = sumW;
+	run.sumXW = sumXW;
+	run.sumXXW = sumXXW;
+	sd->runs.push_back(run);
+}
+
+static void SdRowRunsScalar(SpotDetector *sd, const WORD *row, int y, WORD threshold)
+{
+	int width = sd->width;
+	int x = 0;
+	while (x < width) {
+		while (x < width && row[x] <= threshold)
+			x++;
+		if (x == width)
+			break;
+		int start = x;
+		while (x < width && row[x] > threshold)
+			x++;
+		SdEmitRun(sd, row, y, start, x - 1);
+	}
+}
+
+#if SIMD_X86
+SIMD_TARGET_AVX2
+static void SdRowRunsAVX2(SpotDetector *sd, const WORD *row, int y, WORD threshold)
+{
+	// Most of a tracking frame is background, so 16 pixels at a time are
+	// tested for "nothing above threshold" and skipped whole
+	const __m256i bias = _mm256_set1_epi16((short)0x8000);
+	const __m256i limit = _mm256_xor_si256(_mm256_set1_epi16((short)threshold), bias);
+	int width = sd->width;
+	int x = 0;
+	int start = -1;
+	for (; x + 16 <= width; x += 16) {
+		__m256i v = _mm256_xor_si256(_mm256_loadu_si256((const __m256i *)(row + x)), bias);
+		unsigned int mask = (unsigned int)_mm256_movemask_epi8(_mm256_cmpgt_epi16(v, limit));
+		if (mask == 0 && start < 0)
+			continue;
+		if (mask == 0xFFFFFFFFu && start >= 0)
+			continue;
+		for (int k = 0; k < 16; k++) {
+			bool on = (mask >> (2 * k)) & 1;
+			if (on && start < 0)
+				start = x + k;
+			else if (!on && start >= 0) {
+				SdEmitRun(sd, row, y, start, x + k - 1);
+				start = -1;
+			}
+		}
+	}
+	for (; x < width; x++) {
+		bool on = row[x] > threshold;
+		if (on && start < 0)
+			start = x;
+		else if (!on && start >= 0) {
+			SdEmitRun(sd, row, y, start, x - 1);
+			start = -1;
+		}
+	}
+	if (start >= 0)
+		SdEmitRun(sd, row, y, start, width - 1);
+}
+#endif
+
+//------------------------------------------------------------------------------
+// Union-find over runs
+//------------------------------------------------------------------------------
+
+static int SdFind(std::vector<int> &parent, int i)
+{
+	while (parent[i] != i) {
+		parent[i] = parent[parent[i]];		// path halving
+		i = parent[i];
+	}
+	return i;
+}
+
+static void SdUnion(std::vector<int> &parent, int a, int b)
+{
+	a = SdFind(parent, a);
+	b = SdFind(parent, b);
+	// Keep the earlier run as root so labels come out in raster order
+	if (a < b)
+		parent[b] = a;
+	else if (b < a)
+		parent[a] = b;
+}
+
+//------------------------------------------------------------------------------
+// Public interface
+//------------------------------------------------------------------------------
+
+void SdDefaultParams(SpotParams *params)
+{
+	params->thresholdMin = 1000;
+	params->thresholdMax = 0;
+	params->baseline = 0;
+	params->minPixels = 3;
+	params->maxPixels = 0;
+	params->connectivity = 8;
+	params->maxSpots = 0;
+}
+
+unsigned int SdInitialise(SpotDetector *sd, int width, int height, const SpotParams *params)
+{
+	if (sd == NULL)
+		return DRV_P1INVALID;
+	if (width <= 0 || width > 32767)
+		return DRV_P2INVALID;
+	if (height <= 0 || height > 32767)
+		return DRV_P3INVALID;
+	if (params == NULL || params->thresholdMin < params->baseline
+		|| params->thresholdMin < 0 || params->thresholdMin > 65535
+		|| (params->connectivity != 4 && params->connectivity != 8))
+		return DRV_P4INVALID;
+
+	sd->width = width;
+	sd->height = height;
+	sd->params = *params;
+	sd->runs.clear();
+	sd->parent.clear();
+	sd->label.clear();
+	sd->moments.clear();
+	return DRV_SUCCESS;
+}
+
+unsigned int SdDetect(SpotDetector *sd, const WORD *frame, std::vector<Spot> *spots)
+{
+	if (sd == NULL || sd->width <= 0)
+		return DRV_P1INVALID;
+	if (frame == NULL)
+		return DRV_P2INVALID;
+	if (spots == NULL)
+		return DRV_P3INVALID;
+
+	const SpotParams &params = sd->params;
+	WORD threshold = (WORD)params.thresholdMin;
+	int reach = params.connectivity == 8 ? 1 : 0;
+
+	void (*rowRuns)(SpotDetector *, const WORD *, int, WORD) = SdRowRunsScalar;
+#if SIMD_X86
+	if (GetSimdLevel() >= SIMD_AVX2)
+		rowRuns = SdRowRunsAVX2;
+#endif
+
+	// Runs for each row, joined to overlapping runs of the row below as soon
+	// as the row is complete, so the previous row's runs are still in cache
+	sd->runs.clear();
+	sd->parent.clear();
+	size_t prevBegin = 0, prevEnd = 0;
+	for (int y = 0; y < sd->height; y++) {
+		size_t rowBegin = sd->runs.size();
+		rowRuns(sd, frame + (size_t)y * sd->width, y, threshold);
+		size_t rowEnd = sd->runs.size();
+		for (size_t r = rowBegin; r < rowEnd; r++)
+			sd->parent.push_back((int)r);
+
+		size_t j = prevBegin;
+		for (size_t i = rowBegin; i < rowEnd && j < prevEnd; ) {
+			const SpotRun &cur = sd->runs[i];
+			const SpotRun &below = sd->runs[j];
+			if (below.x1 + reach < cur.x0)
+				j++;
+			else if (cur.x1 + reach < below.x0)
+				i++;
+			else {
+				SdUnion(sd->parent, (int)i, (int)j);
+				// Advance whichever run ends first, the other may touch more
+				if (below.x1 < cur.x1)
+					j++;
+				else
+					i++;
+			}
+		}
+		prevBegin = rowBegin;
+		prevEnd = rowEnd;
+	}
+
+	// Fold run moments into their roots
+	size_t runCount = sd->runs.size();
+	sd->label.assign(runCount, -1);
+	spots->clear();
+	sd->moments.clear();
+	std::vector<SpotRun> &runs = sd->runs;
+	std::vector<SpotMoments> &moments = sd->moments;
+	for (size_t r = 0; r < runCount; r++) {
+		int root = SdFind(sd->parent, (int)r);
+		int index = sd->label[root];
+		if (index < 0) {
+			index = (int)spots->size();
+			sd->label[root] = index;
+			Spot spot = {};
+			spot.left = spot.right = (short)runs[r].x0;
+			spot.bottom = spot.top = (short)runs[r].y;
+			spots->push_back(spot);
+			moments.push_back(SpotMoments());
+		}
+		Spot &spot = (*spots)[index];
+		SpotMoments &m = moments[index];
+		const SpotRun &run = runs[r];
+		m.w += run.sumW;
+		m.xw += run.sumXW;
+		m.yw += run.y * run.sumW;
+		m.xxw += run.sumXXW;
+		m.yyw += (double)run.y * run.y * run.sumW;
+		m.xyw += run.y * run.sumXW;
+		spot.pixels += (uint32_t)(run.x1 - run.x0 + 1);
+		spot.peak = std::max(spot.peak, run.peak);
+		spot.left = std::min(spot.left, (short)run.x0);
+		spot.right = std::max(spot.right, (short)run.x1);
+		spot.top = std::max(spot.top, (short)run.y);
+	}
+
+	// Finish the moments and drop spots outside the size and peak limits
+	size_t kept = 0;
+	for (size_t s = 0; s < spots->size(); s++) {
+		Spot spot = (*spots)[s];
+		const SpotMoments &m = moments[s];
+		if ((int)spot.pixels < params.minPixels)
+			continue;
+		if (params.maxPixels > 0 && (int)spot.pixels > params.maxPixels)
+			continue;
+		if (params.thresholdMax > 0 && spot.peak > params.thresholdMax)
+			continue;
+		if (m.w <= 0.0)
+			continue;
+		double cx = m.xw / m.w;
+		double cy = m.yw / m.w;
+		spot.x = (float)cx;
+		spot.y = (float)cy;
+		spot.flux = (float)m.w;
+		spot.mxx = (float)(m.xxw / m.w - cx * cx);
+		spot.myy = (float)(m.yyw / m.w - cy * cy);
+		spot.mxy = (float)(m.xyw / m.w - cx * cy);
+		(*spots)[kept++] = spot;
+	}
+	spots->resize(kept);
+
+	std::sort(spots->begin(), spots->end(), [](const Spot &a, const Spot &b) { return a.flux > b.flux; });
+	if (params.maxSpots > 0 && (int)spots->size() > params.maxSpots)
+		spots->resize(params.maxSpots);
+	return DRV_SUCCESS;
+}
@@ -0,0 +1,85 @@
+// SpotDetector.h : Real-time spot detection and centroiding for beam and star tracking.
+//
+// Each frame is thresholded into runs of bright pixels, the runs are joined
+// into blobs with a union-find over runs (rows only ever look at the row
+// below), and each blob's flux, sub-pixel centroid and second moments are
+// summed from per-run moments. The pixel data is touched once per frame and
+// all working storage is reused, so with a cropped ROI the detector keeps up
+// with kHz frame rates on one thread.
+//
+// Thresholds follow SetPhotonCountingThreshold(min, max): pixels above min
+// belong to spots, and a spot whose peak exceeds max (when max > 0) is
+// dropped as saturated or a cosmic ray.
+
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+extern "C" {
+	#include "atmcd32d.h"
+}
+
+struct SpotParams {
+	long				thresholdMin;	// pixel values above this are spot pixels
+	long				thresholdMax;	// reject spots peaking above this, 0 for no limit
+	long				baseline;		// subtracted from pixel values for flux and weights
+	int					minPixels;		// smallest spot kept
+	int					maxPixels;		// largest spot kept, 0 for no limit
+	int					connectivity;	// 4 or 8
+	int					maxSpots;		// keep only the brightest, 0 for all
+};
+
+// Compact per-spot record. Coordinates are pixel indices within the frame
+// buffer; the centre of the first pixel is (0, 0).
+struct Spot {
+	float				x;				// flux-weighted centroid
+	float				y;
+	float				flux;			// sum of (value - baseline)
+	float				mxx;			// central second moments
+	float				myy;
+	float				mxy;
+	uint32_t			pixels;
+	WORD				peak;
+	short				left;			// bounding box, inclusive
+	short				bottom;
+	short				right;
+	short				top;
+};
+
+struct SpotRun {
+	int					y;
+	int					x0;				// inclusive
+	int					x1;				// inclusive
+	WORD				peak;
+	double				sumW;
+	double				sumXW;
+	double				sumXXW;
+};
+
+struct SpotMoments {
+	double				w;
+	double				xw;
+	double				yw;
+	double				xxw;
+	double				yyw;
+	double				xyw;
+};
+
+struct SpotDetector {
+	int					width;
+	int					height;
+	SpotParams			params;
+	std::vector<SpotRun>	runs;		// scratch, reused between frames
+	std::vector<int>	parent;
+	std::vector<int>	label;
+	std::vector<SpotMoments>	moments;
+};
+
+void SdDefaultParams(SpotParams *params);
+
+unsigned int SdInitialise(SpotDetector *sd, int width, int height, const SpotParams *params);
+
+// Replaces the contents of spots with the spots found in frame, brightest
+// first. The vector keeps its capacity, so steady state allocates nothing.
+unsigned int SdDetect(SpotDetector *sd, const WORD *frame, std::vector<Spot> *spots);
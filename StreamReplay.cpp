@@ -0,0 +1,757 @@
+// StreamReplay.cpp : Recording of acquisition streams and their replay without a camera.
+//
+
+#include "stdafx.h"
+#include "StreamReplay.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+typedef std::chrono::steady_clock SrClock;
+
+static const char kSrMagic[8] = { 'A', 'N', 'D', 'O', 'R', 'S', 'T', 'R' };
+static const uint32_t kSrVersion = 2;
+
+enum SrRecordType {
+	SR_START = 1,			// StartAcquisition returned
+	SR_WAIT = 2,			// a WaitForAcquisition call returned
+	SR_FRAME = 3			// a frame was fetched; the pixels follow the record
+};
+
+struct SrRecord {
+	uint32_t				type;
+	uint32_t				result;
+	double					time;			// seconds since recording started
+	int64_t					index;			// frame number within the acquisition
+	uint32_t				pixels;
+	uint32_t				bytesPerPixel;
+};
+
+struct SrFrame {
+	long					index;
+	int						bytesPerPixel;
+	std::vector<uint8_t>	data;
+};
+
+struct SrRecorder {
+	std::mutex				lock;
+	FILE					*file;
+	SrClock::time_point		start;
+	long					lastIndex;
+	bool					ok;
+};
+
+// The recording is read one record ahead; records of the current acquisition
+// become frames on the available queue as the replay clock reaches them
+struct SrReplay {
+	std::mutex				lock;
+	std::condition_variable	cancelled;
+	FILE					*file;
+	SrMetadata				metadata;
+	double					speed;
+	bool					havePending;
+	SrRecord				pending;
+	std::vector<uint8_t>	pendingData;
+	std::deque<SrFrame>		available;
+	SrClock::time_point		t0;
+	double					recordStart;
+	bool					acquiring;
+	bool					cancel;
+	long					total;			// frames made available this acquisition
+};
+
+static SrRecorder gSrRecorder;
+static SrReplay gSrReplay;
+
+// What the start-up enumeration (CsQueryCapabilities, CsScanSpeeds,
+// SfQueryCamera) asks, kept so a replay can answer it
+static void SrQueryEnumeration(SrMetadata *metadata)
+{
+	metadata->caps.ulSize = sizeof(AndorCapabilities);
+	metadata->capsResult = GetCapabilities(&metadata->caps);
+	int minTemp = 0, maxTemp = 0, coolerOn = 0;
+	metadata->temperatureRangeResult = GetTemperatureRange(&minTemp, &maxTemp);
+	metadata->minTemp = minTemp;
+	metadata->maxTemp = maxTemp;
+	metadata->coolerResult = IsCoolerOn(&coolerOn);
+	metadata->coolerOn = coolerOn;
+
+	int channels = 0;
+	if (GetNumberADChannels(&channels) == DRV_SUCCESS)
+		metadata->adChannels = std::min(channels, SR_MAX_AD_CHANNELS);
+	for (int channel = 0; channel < metadata->adChannels; channel++) {
+		int depth = 0;
+		GetBitDepth(channel, &depth);
+		metadata->bitDepth[channel] = depth;
+		for (int typ = 0; typ < 2; typ++) {
+			int speeds = 0;
+			if (GetNumberHSSpeeds(channel, typ, &speeds) != DRV_SUCCESS)
+				continue;
+			speeds = std::min(speeds, SR_MAX_SPEEDS);
+			for (int index = 0; index < speeds; index++)
+				GetHSSpeed(channel, typ, index, &metadata->hsSpeed[channel][typ][index]);
+			metadata->hsSpeeds[channel][typ] = speeds;
+		}
+	}
+
+	int speeds = 0;
+	if (GetNumberVSSpeeds(&speeds) == DRV_SUCCESS)
+		metadata->vsSpeeds = std::min(speeds, SR_MAX_SPEEDS);
+	for (int index = 0; index < metadata->vsSpeeds; index++)
+		GetVSSpeed(index, &metadata->vsSpeed[index]);
+	int fastest = -1;
+	if (GetFastestRecommendedVSSpeed(&fastest, &metadata->fastestVSSpeed) != DRV_SUCCESS)
+		fastest = -1;
+	metadata->fastestVSSpeedIndex = fastest;
+}
+
+//------------------------------------------------------------------------------
+// Recorder
+//------------------------------------------------------------------------------
+
+static void SrWrite(uint32_t type, unsigned int result, long index, const void *data, uint32_t pixels, int bytesPerPixel)
+{
+	std::lock_guard<std::mutex> guard(gSrRecorder.lock);
+	if (gSrRecorder.file == NULL)
+		return;
+	SrRecord record;
+	record.type = type;
+	record.result = result;
+	record.time = std::chrono::duration<double>(SrClock::now() - gSrRecorder.start).count();
+	record.index = index;
+	record.pixels = pixels;
+	record.bytesPerPixel = (uint32_t)bytesPerPixel;
+	size_t bytes = (size_t)pixels * bytesPerPixel;
+	if (fwrite(&record, sizeof(record), 1, gSrRecorder.file) != 1
+		|| (bytes && fwrite(data, 1, bytes, gSrRecorder.file) != bytes))
+		gSrRecorder.ok = false;
+}
+
+unsigned int SrStartRecording(const char *filename)
+{
+	if (filename == NULL)
+		return DRV_P1INVALID;
+	SrStopRecording();
+
+	SrMetadata metadata;
+	memset(&metadata, 0, sizeof(metadata));
+	int xPixels = 0, yPixels = 0, serial = 0;
+	GetDetector(&xPixels, &yPixels);
+	GetAcquisitionTimings(&metadata.exposure, &metadata.accumulate, &metadata.kinetic);
+	GetTemperatureF(&metadata.temperature);
+	GetCameraSerialNumber(&serial);
+	GetHeadModel(metadata.headModel);
+	metadata.headModel[sizeof(metadata.headModel) - 1] = 0;
+	metadata.xPixels = xPixels;
+	metadata.yPixels = yPixels;
+	metadata.serial = serial;
+	SrQueryEnumeration(&metadata);
+
+	FILE *file = fopen(filename, "wb");
+	if (file == NULL)
+		return DRV_ERROR_FILESAVE;
+	uint32_t header[3] = { kSrVersion, (uint32_t)sizeof(SrMetadata), (uint32_t)sizeof(SrRecord) };
+	if (fwrite(kSrMagic, sizeof(kSrMagic), 1, file) != 1
+		|| fwrite(header, sizeof(header), 1, file) != 1
+		|| fwrite(&metadata, sizeof(metadata), 1, file) != 1) {
+		fclose(file);
+		return DRV_ERROR_FILESAVE;
+	}
+
+	std::lock_guard<std::mutex> guard(gSrRecorder.lock);
+	gSrRecorder.file = file;
+	gSrRecorder.start = SrClock::now();
+	gSrRecorder.lastIndex = 0;
+	gSrRecorder.ok = true;
+	return DRV_SUCCESS;
+}
+
+unsigned int SrStopRecording()
+{
+	std::lock_guard<std::mutex> guard(gSrRecorder.lock);
+	if (gSrRecorder.file == NULL)
+		return DRV_SUCCESS;
+	bool ok = fclose(gSrRecorder.file) == 0 && gSrRecorder.ok;
+	gSrRecorder.file = NULL;
+	return ok ? DRV_SUCCESS : DRV_ERROR_FILESAVE;
+}
+
+void SrRecordStart(unsigned int result)
+{
+	{
+		std::lock_guard<std::mutex> guard(gSrRecorder.lock);
+		gSrRecorder.lastIndex = 0;
+	}
+	SrWrite(SR_START, result, 0, NULL, 0, 0);
+}
+
+void SrRecordWait(unsigned int result)
+{
+	SrWrite(SR_WAIT, result, 0, NULL, 0, 0);
+}
+
+void SrRecordFrames(long first, long last, const void *data, unsigned long pixels, int bytesPerPixel)
+{
+	long count = last - first + 1;
+	if (first < 0) {
+		std::lock_guard<std::mutex> guard(gSrRecorder.lock);
+		first = last = gSrRecorder.lastIndex + 1;
+		count = 1;
+	}
+	if (count <= 0 || pixels < (unsigned long)count)
+		return;
+	uint32_t framePixels = (uint32_t)(pixels / count);
+	const uint8_t *frame = (const uint8_t *)data;
+	for (long index = first; index <= last; index++) {
+		SrWrite(SR_FRAME, DRV_SUCCESS, index, frame, framePixels, bytesPerPixel);
+		frame += (size_t)framePixels * bytesPerPixel;
+	}
+	std::lock_guard<std::mutex> guard(gSrRecorder.lock);
+	gSrRecorder.lastIndex = std::max(gSrRecorder.lastIndex, last);
+}
+
+//------------------------------------------------------------------------------
+// Replay. Every helper below expects gSrReplay.lock to be held.
+//------------------------------------------------------------------------------
+
+static bool SrPeek()
+{
+	SrReplay &replay = gSrReplay;
+	if (replay.havePending)
+		return true;
+	if (replay.file == NULL || fread(&replay.pending, sizeof(replay.pending), 1, replay.file) != 1)
+		return false;
+	size_t bytes = (size_t)replay.pending.pixels * replay.pending.bytesPerPixel;
+	replay.pendingData.resize(bytes);
+	if (bytes && fread(replay.pendingData.data(), 1, bytes, replay.file) != bytes)
+		return false;
+	replay.havePending = true;
+	return true;
+}
+
+// True while the next record still belongs to the running acquisition
+static bool SrPeekInAcquisition()
+{
+	return gSrReplay.acquiring && SrPeek() && gSrReplay.pending.type != SR_START;
+}
+
+static SrClock::time_point SrDue(const SrRecord &record)
+{
+	const SrReplay &replay = gSrReplay;
+	if (replay.speed <= 0.0)
+		return replay.t0;		// always due
+	return replay.t0 + std::chrono::duration_cast<SrClock::duration>(
+		std::chrono::duration<double>((record.time - replay.recordStart) / replay.speed));
+}
+
+static void SrConsume()
+{
+	SrReplay &replay = gSrReplay;
+	if (replay.pending.type == SR_FRAME) {
+		SrFrame frame;
+		frame.index = (long)replay.pending.index;
+		frame.bytesPerPixel = (int)replay.pending.bytesPerPixel;
+		frame.data.swap(replay.pendingData);
+		replay.available.push_back(std::move(frame));
+		replay.total = std::max(replay.total, (long)replay.pending.index);
+	}
+	replay.havePending = false;
+}
+
+// The frames fetched after a wait returned were there when it returned
+static void SrConsumeFrames()
+{
+	while (SrPeekInAcquisition() && gSrReplay.pending.type == SR_FRAME)
+		SrConsume();
+}
+
+// Catches up with every record the replay clock has passed. At full speed
+// the next step is taken whenever the caller runs out of frames instead.
+static void SrCatchUp()
+{
+	if (gSrReplay.speed <= 0.0) {
+		if (gSrReplay.available.empty() && SrPeekInAcquisition()) {
+			bool wait = gSrReplay.pending.type == SR_WAIT;
+			SrConsume();
+			if (wait)
+				SrConsumeFrames();
+		}
+		return;
+	}
+	while (SrPeekInAcquisition() && SrDue(gSrReplay.pending) <= SrClock::now()) {
+		bool wait = gSrReplay.pending.type == SR_WAIT;
+		SrConsume();
+		if (wait)
+			SrConsumeFrames();
+	}
+}
+
+// Sleeps until the time given unless CancelWait is called first
+static bool SrSleepUntil(std::unique_lock<std::mutex> &lock, SrClock::time_point until)
+{
+	return !gSrReplay.cancelled.wait_until(lock, until, [] { return gSrReplay.cancel; });
+}
+
+static void SrEndAcquisition()
+{
+	while (SrPeekInAcquisition())
+		SrConsume();
+	gSrReplay.acquiring = false;
+}
+
+template <typename T>
+static void SrCopyFrame(const SrFrame &frame, T *arr, unsigned long pixels)
+{
+	unsigned long n = std::min(pixels, (unsigned long)(frame.data.size() / frame.bytesPerPixel));
+	if (frame.bytesPerPixel == sizeof(WORD)) {
+		const WORD *source = (const WORD *)frame.data.data();
+		for (unsigned long i = 0; i < n; i++)
+			arr[i] = (T)source[i];
+	}
+	else {
+		const at_32 *source = (const at_32 *)frame.data.data();
+		for (unsigned long i = 0; i < n; i++)
+			arr[i] = (T)source[i];
+	}
+}
+
+template <typename T>
+static unsigned int SrGetImagesT(long first, long last, T *arr, unsigned long size, long *validFirst, long *validLast)
+{
+	if (last < first)
+		return DRV_P2INVALID;
+	if (arr == NULL)
+		return DRV_P3INVALID;
+
+	std::lock_guard<std::mutex> guard(gSrReplay.lock);
+	SrCatchUp();
+	std::deque<SrFrame> &available = gSrReplay.available;
+	unsigned long framePixels = size / (unsigned long)(last - first + 1);
+	long copied = 0, firstCopied = 0;
+	while (!available.empty() && available.front().index <= last) {
+		const SrFrame &frame = available.front();
+		if (frame.index >= first) {
+			if (copied == 0)
+				firstCopied = frame.index;
+			SrCopyFrame(frame, arr + (size_t)copied * framePixels, framePixels);
+			copied++;
+		}
+		available.pop_front();
+	}
+	if (copied == 0)
+		return DRV_NO_NEW_DATA;
+	if (validFirst)
+		*validFirst = firstCopied;
+	if (validLast)
+		*validLast = firstCopied + copied - 1;
+	return DRV_SUCCESS;
+}
+
+template <typename T>
+static unsigned int SrGetFrameT(T *arr, unsigned long size, bool oldest, bool block)
+{
+	if (arr == NULL)
+		return DRV_P1INVALID;
+
+	std::unique_lock<std::mutex> lock(gSrReplay.lock);
+	SrCatchUp();
+	// GetAcquiredData follows the acquisition finishing, so waits for the next frame
+	if (block && gSrReplay.available.empty()) {
+		gSrReplay.cancel = false;
+		while (SrPeekInAcquisition() && gSrReplay.available.empty()) {
+			if (!SrSleepUntil(lock, SrDue(gSrReplay.pending)))
+				break;
+			SrCatchUp();
+		}
+	}
+	std::deque<SrFrame> &available = gSrReplay.available;
+	if (available.empty())
+		return DRV_NO_NEW_DATA;
+	if (oldest) {
+		SrCopyFrame(available.front(), arr, size);
+		available.pop_front();
+	}
+	else {
+		SrCopyFrame(available.back(), arr, size);
+		available.clear();
+	}
+	return DRV_SUCCESS;
+}
+
+unsigned int SrOpenReplay(const char *filename, double speed)
+{
+	if (filename == NULL)
+		return DRV_P1INVALID;
+	if (speed < 0.0)
+		return DRV_P2INVALID;
+	SrCloseReplay();
+
+	FILE *file = fopen(filename, "rb");
+	if (file == NULL)
+		return DRV_ERROR_FILELOAD;
+	char magic[8];
+	uint32_t header[3];
+	SrMetadata metadata;
+	bool ok = fread(magic, sizeof(magic), 1, file) == 1
+		&& memcmp(magic, kSrMagic, sizeof(magic)) == 0
+		&& fread(header, sizeof(header), 1, file) == 1
+		&& header[0] == kSrVersion
+		&& header[1] == sizeof(SrMetadata)
+		&& header[2] == sizeof(SrRecord)
+		&& fread(&metadata, sizeof(metadata), 1, file) == 1;
+	if (!ok) {
+		fclose(file);
+		return DRV_ERROR_FILELOAD;
+	}
+
+	std::lock_guard<std::mutex> guard(gSrReplay.lock);
+	gSrReplay.file = file;
+	gSrReplay.metadata = metadata;
+	gSrReplay.speed = speed;
+	gSrReplay.havePending = false;
+	gSrReplay.available.clear();
+	gSrReplay.acquiring = false;
+	gSrReplay.cancel = false;
+	gSrReplay.total = 0;
+	return DRV_SUCCESS;
+}
+
+void SrCloseReplay()
+{
+	std::lock_guard<std::mutex> guard(gSrReplay.lock);
+	if (gSrReplay.file)
+		fclose(gSrReplay.file);
+	gSrReplay.file = NULL;
+	gSrReplay.havePending = false;
+	gSrReplay.available.clear();
+	gSrReplay.acquiring = false;
+}
+
+const SrMetadata *SrGetReplayMetadata()
+{
+	return gSrReplay.file ? &gSrReplay.metadata : NULL;
+}
+
+//------------------------------------------------------------------------------
+// SDK entry points answered by the replay
+//------------------------------------------------------------------------------
+
+unsigned int SrStartAcquisition()
+{
+	std::lock_guard<std::mutex> guard(gSrReplay.lock);
+	SrEndAcquisition();
+	gSrReplay.available.clear();
+	if (!SrPeek())
+		return DRV_NOT_AVAILABLE;	// the recording has no more acquisitions
+	const SrRecord &record = gSrReplay.pending;
+	gSrReplay.t0 = SrClock::now();
+	gSrReplay.recordStart = record.time;
+	gSrReplay.acquiring = record.result == DRV_SUCCESS;
+	gSrReplay.total = 0;
+	unsigned int result = record.result;
+	SrConsume();
+	return result;
+}
+
+unsigned int SrAbortAcquisition()
+{
+	std::lock_guard<std::mutex> guard(gSrReplay.lock);
+	if (!gSrReplay.acquiring)
+		return DRV_IDLE;
+	SrEndAcquisition();
+	return DRV_SUCCESS;
+}
+
+unsigned int SrCancelWait()
+{
+	std::lock_guard<std::mutex> guard(gSrReplay.lock);
+	gSrReplay.cancel = true;
+	gSrReplay.cancelled.notify_all();
+	return DRV_SUCCESS;
+}
+
+unsigned int SrWaitForAcquisition()
+{
+	return SrWaitForAcquisitionTimeOut(-1);
+}
+
+// A negative timeout waits for as long as the recording did
+unsigned int SrWaitForAcquisitionTimeOut(int timeoutMs)
+{
+	std::unique_lock<std::mutex> lock(gSrReplay.lock);
+	gSrReplay.cancel = false;
+	SrClock::time_point deadline = SrClock::now() + std::chrono::milliseconds(timeoutMs);
+	while (SrPeekInAcquisition()) {
+		SrClock::time_point due = SrDue(gSrReplay.pending);
+		if (timeoutMs >= 0 && due > deadline) {
+			SrSleepUntil(lock, deadline);
+			return DRV_NO_NEW_DATA;
+		}
+		if (!SrSleepUntil(lock, due))
+			return DRV_NO_NEW_DATA;
+		// The other thread may have moved the replay on while this one slept
+		if (!SrPeekInAcquisition() || SrDue(gSrReplay.pending) > SrClock::now())
+			continue;
+		if (gSrReplay.pending.type == SR_WAIT) {
+			unsigned int result = gSrReplay.pending.result;
+			SrConsume();
+			SrConsumeFrames();
+			return result;
+		}
+		SrConsume();
+	}
+	return DRV_NO_NEW_DATA;
+}
+
+unsigned int SrGetStatus(int *status)
+{
+	if (status == NULL)
+		return DRV_P1INVALID;
+
+	std::lock_guard<std::mutex> guard(gSrReplay.lock);
+	SrCatchUp();
+	*status = SrPeekInAcquisition() ? DRV_ACQUIRING : DRV_IDLE;
+	return DRV_SUCCESS;
+}
+
+unsigned int SrGetNumberNewImages(long *first, long *last)
+{
+	if (first == NULL)
+		return DRV_P1INVALID;
+	if (last == NULL)
+		return DRV_P2INVALID;
+
+	std::lock_guard<std::mutex> guard(gSrReplay.lock);
+	SrCatchUp();
+	if (gSrReplay.available.empty())
+		return DRV_NO_NEW_DATA;
+	*first = gSrReplay.available.front().index;
+	*last = gSrReplay.available.back().index;
+	return DRV_SUCCESS;
+}
+
+unsigned int SrGetTotalNumberImagesAcquired(long *index)
+{
+	if (index == NULL)
+		return DRV_P1INVALID;
+
+	std::lock_guard<std::mutex> guard(gSrReplay.lock);
+	SrCatchUp();
+	*index = gSrReplay.total;
+	return DRV_SUCCESS;
+}
+
+unsigned int SrGetImages16(long first, long last, WORD *arr, unsigned long size, long *validFirst, long *validLast)
+{
+	return SrGetImagesT(first, last, arr, size, validFirst, validLast);
+}
+
+unsigned int SrGetImages(long first, long last, at_32 *arr, unsigned long size, long *validFirst, long *validLast)
+{
+	return SrGetImagesT(first, last, arr, size, validFirst, validLast);
+}
+
+unsigned int SrGetMostRecentImage16(WORD *arr, unsigned long size)
+{
+	return SrGetFrameT(arr, size, false, false);
+}
+
+unsigned int SrGetMostRecentImage(at_32 *arr, unsigned long size)
+{
+	return SrGetFrameT(arr, size, false, false);
+}
+
+unsigned int SrGetOldestImage16(WORD *arr, unsigned long size)
+{
+	return SrGetFrameT(arr, size, true, false);
+}
+
+unsigned int SrGetOldestImage(at_32 *arr, unsigned long size)
+{
+	return SrGetFrameT(arr, size, true, false);
+}
+
+unsigned int SrGetAcquiredData16(WORD *arr, unsigned long size)
+{
+	return SrGetFrameT(arr, size, false, true);
+}
+
+unsigned int SrGetAcquiredData(at_32 *arr, unsigned long size)
+{
+	return SrGetFrameT(arr, size, false, true);
+}
+
+unsigned int SrGetAcquisitionTimings(float *exposure, float *accumulate, float *kinetic)
+{
+	if (exposure)
+		*exposure = gSrReplay.metadata.exposure;
+	if (accumulate)
+		*accumulate = gSrReplay.metadata.accumulate;
+	if (kinetic)
+		*kinetic = gSrReplay.metadata.kinetic;
+	return DRV_SUCCESS;
+}
+
+unsigned int SrGetDetector(int *xPixels, int *yPixels)
+{
+	if (xPixels == NULL)
+		return DRV_P1INVALID;
+	if (yPixels == NULL)
+		return DRV_P2INVALID;
+	*xPixels = gSrReplay.metadata.xPixels;
+	*yPixels = gSrReplay.metadata.yPixels;
+	return DRV_SUCCESS;
+}
+
+unsigned int SrGetTemperatureF(float *temperature)
+{
+	if (temperature == NULL)
+		return DRV_P1INVALID;
+	*temperature = gSrReplay.metadata.temperature;
+	return DRV_TEMP_STABILIZED;
+}
+
+unsigned int SrGetTemperature(int *temperature)
+{
+	if (temperature == NULL)
+		return DRV_P1INVALID;
+	*temperature = (int)gSrReplay.metadata.temperature;
+	return DRV_TEMP_STABILIZED;
+}
+
+unsigned int SrGetCameraSerialNumber(int *serial)
+{
+	if (serial == NULL)
+		return DRV_P1INVALID;
+	*serial = gSrReplay.metadata.serial;
+	return DRV_SUCCESS;
+}
+
+unsigned int SrGetHeadModel(char *name)
+{
+	if (name == NULL)
+		return DRV_P1INVALID;
+	strcpy(name, gSrReplay.metadata.headModel);
+	return DRV_SUCCESS;
+}
+
+unsigned int SrGetCapabilities(AndorCapabilities *caps)
+{
+	if (caps == NULL)
+		return DRV_P1INVALID;
+	const SrMetadata &metadata = gSrReplay.metadata;
+	if (metadata.capsResult != DRV_SUCCESS)
+		return metadata.capsResult;
+	*caps = metadata.caps;
+	return DRV_SUCCESS;
+}
+
+unsigned int SrGetTemperatureRange(int *minTemp, int *maxTemp)
+{
+	if (minTemp == NULL)
+		return DRV_P1INVALID;
+	if (maxTemp == NULL)
+		return DRV_P2INVALID;
+	const SrMetadata &metadata = gSrReplay.metadata;
+	if (metadata.temperatureRangeResult != DRV_SUCCESS)
+		return metadata.temperatureRangeResult;
+	*minTemp = metadata.minTemp;
+	*maxTemp = metadata.maxTemp;
+	return DRV_SUCCESS;
+}
+
+unsigned int SrIsCoolerOn(int *coolerOn)
+{
+	if (coolerOn == NULL)
+		return DRV_P1INVALID;
+	const SrMetadata &metadata = gSrReplay.metadata;
+	if (metadata.coolerResult != DRV_SUCCESS)
+		return metadata.coolerResult;
+	*coolerOn = metadata.coolerOn;
+	return DRV_SUCCESS;
+}
+
+unsigned int SrGetNumberADChannels(int *channels)
+{
+	if (channels == NULL)
+		return DRV_P1INVALID;
+	if (gSrReplay.metadata.adChannels == 0)
+		return DRV_NOT_SUPPORTED;
+	*channels = gSrReplay.metadata.adChannels;
+	return DRV_SUCCESS;
+}
+
+unsigned int SrGetBitDepth(int channel, int *depth)
+{
+	if (channel < 0 || channel >= gSrReplay.metadata.adChannels)
+		return DRV_P1INVALID;
+	if (depth == NULL)
+		return DRV_P2INVALID;
+	*depth = gSrReplay.metadata.bitDepth[channel];
+	return DRV_SUCCESS;
+}
+
+unsigned int SrGetNumberHSSpeeds(int channel, int typ, int *speeds)
+{
+	if (channel < 0 || channel >= gSrReplay.metadata.adChannels)
+		return DRV_P1INVALID;
+	if (typ < 0 || typ > 1)
+		return DRV_P2INVALID;
+	if (speeds == NULL)
+		return DRV_P3INVALID;
+	*speeds = gSrReplay.metadata.hsSpeeds[channel][typ];
+	return DRV_SUCCESS;
+}
+
+unsigned int SrGetHSSpeed(int channel, int typ, int index, float *speed)
+{
+	if (channel < 0 || channel >= gSrReplay.metadata.adChannels)
+		return DRV_P1INVALID;
+	if (typ < 0 || typ > 1)
+		return DRV_P2INVALID;
+	if (index < 0 || index >= gSrReplay.metadata.hsSpeeds[channel][typ])
+		return DRV_P3INVALID;
+	if (speed == NULL)
+		return DRV_P4INVALID;
+	*speed = gSrReplay.metadata.hsSpeed[channel][typ][index];
+	return DRV_SUCCESS;
+}
+
+unsigned int SrGetNumberVSSpeeds(int *speeds)
+{
+	if (speeds == NULL)
+		return DRV_P1INVALID;
+	if (gSrReplay.metadata.vsSpeeds == 0)
+		return DRV_NOT_SUPPORTED;
+	*speeds = gSrReplay.metadata.vsSpeeds;
+	return DRV_SUCCESS;
+}
+
+unsigned int SrGetVSSpeed(int index, float *speed)
+{
+	if (index < 0 || index >= gSrReplay.metadata.vsSpeeds)
+		return DRV_P1INVALID;
+	if (speed == NULL)
+		return DRV_P2INVALID;
+	*speed = gSrReplay.metadata.vsSpeed[index];
+	return DRV_SUCCESS;
+}
+
+unsigned int SrGetFastestRecommendedVSSpeed(int *index, float *speed)
+{
+	if (index == NULL)
+		return DRV_P1INVALID;
+	if (speed == NULL)
+		return DRV_P2INVALID;
+	if (gSrReplay.metadata.fastestVSSpeedIndex < 0)
+		return DRV_NOT_SUPPORTED;
+	*index = gSrReplay.metadata.fastestVSSpeedIndex;
+	*speed = gSrReplay.metadata.fastestVSSpeed;
+	return DRV_SUCCESS;
+}
@@ -0,0 +1,301 @@
+// StreamReplay.h : Recording of acquisition streams and their replay without a camera.
+//
+// A field performance problem can only be reproduced with the camera that saw
+// it and the frames it produced. Built with SDK_RECORD, every
+// StartAcquisition, every WaitForAcquisition return and every frame fetched
+// (GetImages, GetMostRecentImage, GetOldestImage and GetAcquiredData, 16 and
+// 32 bit) is appended to the file opened with SrStartRecording(), along with
+// its result and the time it happened. The file also keeps the detector size,
+// timings, temperature and head of the camera that recorded it, and what the
+// start-up enumeration asks: capabilities, temperature range, cooler state,
+// AD channels with their bit depths and horizontal speeds, and the vertical
+// speeds.
+//
+// Built with SDK_REPLAY instead, the same calls are answered from a recording
+// opened with SrOpenReplay(): waits return the recorded result when the
+// recorded time comes round, scaled by the replay speed, and frames become
+// available as they did in the recording. Any other query (Get*, Is* and the
+// like) returns DRV_NOT_SUPPORTED, since the recording cannot fill its
+// outputs, and every other command returns DRV_SUCCESS without touching the
+// camera. No SDK symbol is referenced, so unchanged acquisition and
+// processing code runs without a camera or the SDK at the original speed,
+// N times faster or as fast as it can.
+//
+// Either way the interposition works like SdkProfiler.h: define the mode and
+// include this header after the SDK header, or force-include it (/FI). It
+// has to reach every file that calls the SDK, or that file's calls go to the
+// real camera: the modules Andor_test runs (CameraManager, CameraStartup,
+// CapabilityCache, SettingsShadow, ThermalTelemetry, AcquisitionDaemon)
+// include it themselves, anything else needs it added or forced in.
+
+#pragma once
+
+#include <stdint.h>
+#include <utility>
+
+#include "SdkProfiler.h"
+
+#define SR_MAX_AD_CHANNELS		4
+#define SR_MAX_SPEEDS			16
+
+struct SrMetadata {
+	int32_t					xPixels;
+	int32_t					yPixels;
+	float					exposure;		// GetAcquisitionTimings when recording started
+	float					accumulate;
+	float					kinetic;
+	float					temperature;
+	int32_t					serial;
+	char					headModel[32];
+
+	// Start-up enumeration. A query that failed while recording fails the
+	// same way on replay; counts of zero mean the query failed.
+	uint32_t				capsResult;
+	AndorCapabilities		caps;
+	uint32_t				temperatureRangeResult;
+	int32_t					minTemp;
+	int32_t					maxTemp;
+	uint32_t				coolerResult;
+	int32_t					coolerOn;
+	int32_t					adChannels;
+	int32_t					bitDepth[SR_MAX_AD_CHANNELS];
+	int32_t					hsSpeeds[SR_MAX_AD_CHANNELS][2];		// per channel and output amplifier
+	float					hsSpeed[SR_MAX_AD_CHANNELS][2][SR_MAX_SPEEDS];	// MHz
+	int32_t					vsSpeeds;
+	float					vsSpeed[SR_MAX_SPEEDS];		// microseconds per row
+	int32_t					fastestVSSpeedIndex;		// -1 when the query failed
+	float					fastestVSSpeed;
+};
+
+// Recorder
+unsigned int SrStartRecording(const char *filename);
+unsigned int SrStopRecording();
+void SrRecordStart(unsigned int result);
+void SrRecordWait(unsigned int result);
+void SrRecordFrames(long first, long last, const void *data, unsigned long pixels, int bytesPerPixel);
+
+// Replay. speed 1 keeps the recorded timing, N runs N times faster and 0 as
+// fast as the caller asks for frames.
+unsigned int SrOpenReplay(const char *filename, double speed);
+void SrCloseReplay();
+const SrMetadata *SrGetReplayMetadata();
+
+// The SDK entry points as answered by the replay
+unsigned int SrStartAcquisition();
+unsigned int SrAbortAcquisition();
+unsigned int SrCancelWait();
+unsigned int SrWaitForAcquisition();
+unsigned int SrWaitForAcquisitionTimeOut(int timeoutMs);
+unsigned int SrGetStatus(int *status);
+unsigned int SrGetNumberNewImages(long *first, long *last);
+unsigned int SrGetTotalNumberImagesAcquired(long *index);
+unsigned int SrGetImages16(long first, long last, WORD *arr, unsigned long size, long *validFirst, long *validLast);
+unsigned int SrGetImages(long first, long last, at_32 *arr, unsigned long size, long *validFirst, long *validLast);
+unsigned int SrGetMostRecentImage16(WORD *arr, unsigned long size);
+unsigned int SrGetMostRecentImage(at_32 *arr, unsigned long size);
+unsigned int SrGetOldestImage16(WORD *arr, unsigned long size);
+unsigned int SrGetOldestImage(at_32 *arr, unsigned long size);
+unsigned int SrGetAcquiredData16(WORD *arr, unsigned long size);
+unsigned int SrGetAcquiredData(at_32 *arr, unsigned long size);
+unsigned int SrGetAcquisitionTimings(float *exposure, float *accumulate, float *kinetic);
+unsigned int SrGetDetector(int *xPixels, int *yPixels);
+unsigned int SrGetTemperatureF(float *temperature);
+unsigned int SrGetTemperature(int *temperature);
+unsigned int SrGetCameraSerialNumber(int *serial);
+unsigned int SrGetHeadModel(char *name);
+unsigned int SrGetCapabilities(AndorCapabilities *caps);
+unsigned int SrGetTemperatureRange(int *minTemp, int *maxTemp);
+unsigned int SrIsCoolerOn(int *coolerOn);
+unsigned int SrGetNumberADChannels(int *channels);
+unsigned int SrGetBitDepth(int channel, int *depth);
+unsigned int SrGetNumberHSSpeeds(int channel, int typ, int *speeds);
+unsigned int SrGetHSSpeed(int channel, int typ, int index, float *speed);
+unsigned int SrGetNumberVSSpeeds(int *speeds);
+unsigned int SrGetVSSpeed(int index, float *speed);
+unsigned int SrGetFastestRecommendedVSSpeed(int *index, float *speed);
+
+//------------------------------------------------------------------------------
+// Recording interposition: pass every call through, noting the interesting ones
+//------------------------------------------------------------------------------
+
+template <int Id, typename Fn>
+struct SdkRecorded {
+	Fn						fn;
+
+	template <typename... Args>
+	unsigned int operator()(Args &&... args) const
+	{
+		return fn(std::forward<Args>(args)...);
+	}
+};
+
+#define SR_RECORD_WAIT(name) \
+	template <typename Fn> \
+	struct SdkRecorded<SDK_ID_##name, Fn> { \
+		Fn fn; \
+		template <typename... Args> \
+		unsigned int operator()(Args &&... args) const \
+		{ \
+			unsigned int result = fn(std::forward<Args>(args)...); \
+			SrRecordWait(result); \
+			return result; \
+		} \
+	};
+
+#define SR_RECORD_IMAGES(name, T) \
+	template <typename Fn> \
+	struct SdkRecorded<SDK_ID_##name, Fn> { \
+		Fn fn; \
+		unsigned int operator()(long first, long last, T *arr, unsigned long size, long *validFirst, long *validLast) const \
+		{ \
+			unsigned int result = fn(first, last, arr, size, validFirst, validLast); \
+			if (result == DRV_SUCCESS) \
+				SrRecordFrames(*validFirst, *validLast, arr, size, sizeof(T)); \
+			return result; \
+		} \
+	};
+
+// Fetches without an index are numbered on from the last one recorded
+#define SR_RECORD_FRAME(name, T) \
+	template <typename Fn> \
+	struct SdkRecorded<SDK_ID_##name, Fn> { \
+		Fn fn; \
+		unsigned int operator()(T *arr, unsigned long size) const \
+		{ \
+			unsigned int result = fn(arr, size); \
+			if (result == DRV_SUCCESS) \
+				SrRecordFrames(-1, -1, arr, size, sizeof(T)); \
+			return result; \
+		} \
+	};
+
+template <typename Fn>
+struct SdkRecorded<SDK_ID_StartAcquisition, Fn> {
+	Fn						fn;
+
+	unsigned int operator()() const
+	{
+		unsigned int result = fn();
+		SrRecordStart(result);
+		return result;
+	}
+};
+
+SR_RECORD_WAIT(WaitForAcquisition)
+SR_RECORD_WAIT(WaitForAcquisitionTimeOut)
+SR_RECORD_WAIT(WaitForAcquisitionByHandle)
+SR_RECORD_WAIT(WaitForAcquisitionByHandleTimeOut)
+SR_RECORD_IMAGES(GetImages16, WORD)
+SR_RECORD_IMAGES(GetImages, at_32)
+SR_RECORD_FRAME(GetMostRecentImage16, WORD)
+SR_RECORD_FRAME(GetMostRecentImage, at_32)
+SR_RECORD_FRAME(GetOldestImage16, WORD)
+SR_RECORD_FRAME(GetOldestImage, at_32)
+SR_RECORD_FRAME(GetAcquiredData16, WORD)
+SR_RECORD_FRAME(GetAcquiredData, at_32)
+
+template <int Id, typename Fn>
+SdkRecorded<Id, Fn> SdkRecord(Fn fn)
+{
+	return { fn };
+}
+
+//------------------------------------------------------------------------------
+// Replay interposition: answer from the recording, fail the queries it cannot
+// answer and succeed at every command
+//------------------------------------------------------------------------------
+
+constexpr bool SrStartsWith(const char *name, const char *prefix)
+{
+	return *prefix == '\0' || (*name == *prefix && SrStartsWith(name + 1, prefix + 1));
+}
+
+// Entry points that answer through their arguments or their result rather
+// than change the camera
+constexpr bool SrIsQuery(const char *name)
+{
+	return SrStartsWith(name, "Get") || SrStartsWith(name, "Is")
+		|| SrStartsWith(name, "Filter_Get") || SrStartsWith(name, "OA_Get")
+		|| SrStartsWith(name, "InAuxPort") || SrStartsWith(name, "I2CRead")
+		|| SrStartsWith(name, "I2CBurstRead") || SrStartsWith(name, "GPIBReceive");
+}
+
+static constexpr bool kSrQuery[SDK_FUNCTION_COUNT] = {
+#define SDK_FUNCTION(name) SrIsQuery(#name),
+#include "SdkFunctions.h"
+#undef SDK_FUNCTION
+};
+
+template <int Id>
+struct SdkReplayed {
+	template <typename... Args>
+	unsigned int operator()(Args &&...) const
+	{
+		return kSrQuery[Id] ? DRV_NOT_SUPPORTED : DRV_SUCCESS;
+	}
+};
+
+#define SR_REPLAY(name, call) \
+	template <> \
+	struct SdkReplayed<SDK_ID_##name> { \
+		template <typename... Args> \
+		unsigned int operator()(Args &&... args) const \
+		{ \
+			return call(std::forward<Args>(args)...); \
+		} \
+	};
+
+// Camera handles mean nothing to a replay
+template <>
+struct SdkReplayed<SDK_ID_WaitForAcquisitionByHandle> {
+	unsigned int operator()(long) const { return SrWaitForAcquisition(); }
+};
+
+template <>
+struct SdkReplayed<SDK_ID_WaitForAcquisitionByHandleTimeOut> {
+	unsigned int operator()(long, int timeoutMs) const { return SrWaitForAcquisitionTimeOut(timeoutMs); }
+};
+
+SR_REPLAY(StartAcquisition, SrStartAcquisition)
+SR_REPLAY(AbortAcquisition, SrAbortAcquisition)
+SR_REPLAY(CancelWait, SrCancelWait)
+SR_REPLAY(WaitForAcquisition, SrWaitForAcquisition)
+SR_REPLAY(WaitForAcquisitionTimeOut, SrWaitForAcquisitionTimeOut)
+SR_REPLAY(GetStatus, SrGetStatus)
+SR_REPLAY(GetNumberNewImages, SrGetNumberNewImages)
+SR_REPLAY(GetNumberAvailableImages, SrGetNumberNewImages)
+SR_REPLAY(GetTotalNumberImagesAcquired, SrGetTotalNumberImagesAcquired)
+SR_REPLAY(GetImages16, SrGetImages16)
+SR_REPLAY(GetImages, SrGetImages)
+SR_REPLAY(GetMostRecentImage16, SrGetMostRecentImage16)
+SR_REPLAY(GetMostRecentImage, SrGetMostRecentImage)
+SR_REPLAY(GetOldestImage16, SrGetOldestImage16)
+SR_REPLAY(GetOldestImage, SrGetOldestImage)
+SR_REPLAY(GetAcquiredData16, SrGetAcquiredData16)
+SR_REPLAY(GetAcquiredData, SrGetAcquiredData)
+SR_REPLAY(GetAcquisitionTimings, SrGetAcquisitionTimings)
+SR_REPLAY(GetDetector, SrGetDetector)
+SR_REPLAY(GetTemperatureF, SrGetTemperatureF)
+SR_REPLAY(GetTemperature, SrGetTemperature)
+SR_REPLAY(GetCameraSerialNumber, SrGetCameraSerialNumber)
+SR_REPLAY(GetHeadModel, SrGetHeadModel)
+SR_REPLAY(GetCapabilities, SrGetCapabilities)
+SR_REPLAY(GetTemperatureRange, SrGetTemperatureRange)
+SR_REPLAY(IsCoolerOn, SrIsCoolerOn)
+SR_REPLAY(GetNumberADChannels, SrGetNumberADChannels)
+SR_REPLAY(GetBitDepth, SrGetBitDepth)
+SR_REPLAY(GetNumberHSSpeeds, SrGetNumberHSSpeeds)
+SR_REPLAY(GetHSSpeed, SrGetHSSpeed)
+SR_REPLAY(GetNumberVSSpeeds, SrGetNumberVSSpeeds)
+SR_REPLAY(GetVSSpeed, SrGetVSSpeed)
+SR_REPLAY(GetFastestRecommendedVSSpeed, SrGetFastestRecommendedVSSpeed)
+
+#if defined(SDK_RECORD) && defined(SDK_REPLAY)
+#error SDK_RECORD and SDK_REPLAY cannot be combined
+#elif defined(SDK_RECORD)
+#define SDK_INTERPOSE(name) SdkRecord<SDK_ID_##name>(::name)
+#include "SdkInterpose.h"
+#elif defined(SDK_REPLAY)
+#define SDK_INTERPOSE(name) SdkReplayed<SDK_ID_##name>()
+#include "SdkInterpose.h"
+#endif
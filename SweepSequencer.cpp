@@ -0,0 +1,252 @@
+// SweepSequencer.cpp : Pipelined acquisition of a list of settings points.
+//
+
+#include "stdafx.h"
+#include "SweepSequencer.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <stdio.h>
+#include <thread>
+
+typedef std::chrono::steady_clock SqClock;
+
+// One buffer being filled, one being processed and one queued between them
+static const int kSqBuffers = 3;
+
+struct SqBatch {
+	int						point;
+	int						buffer;
+	int						width;
+	int						height;
+	int						count;
+};
+
+// Hands filled buffers to the processing thread and takes them back once done
+struct SqPipeline {
+	std::vector<WORD>		buffers[kSqBuffers];
+	std::deque<int>			free;
+	std::deque<SqBatch>		queued;
+	std::mutex				lock;
+	std::condition_variable	changed;
+	bool					finished;
+};
+
+static double SqMilliseconds(SqClock::time_point start, SqClock::time_point end)
+{
+	return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+static int SqFrameCount(const AcquisitionSettings *settings)
+{
+	// Kinetic series and run till abort keep numberKinetics frames; the rest give one
+	if (settings->acquisitionMode == 3 || settings->acquisitionMode == 5)
+		return settings->numberKinetics > 0 ? settings->numberKinetics : 1;
+	return 1;
+}
+
+static void SqProcessLoop(SqPipeline *pipeline, const SqProcessFn *process)
+{
+	for (;;) {
+		SqBatch batch;
+		{
+			std::unique_lock<std::mutex> lock(pipeline->lock);
+			pipeline->changed.wait(lock, [&] { return !pipeline->queued.empty() || pipeline->finished; });
+			if (pipeline->queued.empty())
+				return;
+			batch = pipeline->queued.front();
+			pipeline->queued.pop_front();
+		}
+		if (*process)
+			(*process)(batch.point, pipeline->buffers[batch.buffer].data(), batch.width, batch.height, batch.count);
+		std::lock_guard<std::mutex> guard(pipeline->lock);
+		pipeline->free.push_back(batch.buffer);
+		pipeline->changed.notify_all();
+	}
+}
+
+// Claims a free buffer; returns the time spent waiting for one
+static double SqClaimBuffer(SqPipeline *pipeline, int *buffer)
+{
+	SqClock::time_point start = SqClock::now();
+	std::unique_lock<std::mutex> lock(pipeline->lock);
+	pipeline->changed.wait(lock, [&] { return !pipeline->free.empty(); });
+	*buffer = pipeline->free.front();
+	pipeline->free.pop_front();
+	return SqMilliseconds(start, SqClock::now());
+}
+
+static void SqSizeBuffer(SqPipeline *pipeline, int buffer, const AcquisitionSettings *settings)
+{
+	size_t width = (settings->hend - settings->hstart + 1) / settings->hbin;
+	size_t height = (settings->vend - settings->vstart + 1) / settings->vbin;
+	size_t size = width * height * SqFrameCount(settings);
+	if (pipeline->buffers[buffer].size() < size)
+		pipeline->buffers[buffer].resize(size);
+}
+
+static unsigned int SqConfigure(const SqPoint &point, SettingsShadow *shadow, SqPointReport *report)
+{
+	unsigned int error = SsApply(shadow, &point.settings);
+	if (error == DRV_SUCCESS && point.emGain >= 0)
+		error = SetEMCCDGain(point.emGain);
+	if (error == DRV_SUCCESS && point.configure)
+		error = point.configure();
+	float accumulate;
+	if (error == DRV_SUCCESS)
+		error = GetAcquisitionTimings(&report->exposure, &accumulate, &report->cycleTime);
+	if (error != DRV_SUCCESS)
+		SsInvalidate(shadow);	// configure() may have left anything behind
+	return error;
+}
+
+static unsigned int SqFetch(const SqPoint &point, const SqPointReport *report, WORD *frames, int width, int height, int count)
+{
+	int timeoutMs = point.timeoutMs;
+	if (timeoutMs <= 0)
+		timeoutMs = (int)(report->cycleTime * 2000.0f) + 1000;
+	unsigned long pixels = (unsigned long)width * height;
+	unsigned int error = DRV_SUCCESS;
+	int fetched = 0;
+	while (error == DRV_SUCCESS && fetched < count) {
+		unsigned int waited = WaitForAcquisitionTimeOut(timeoutMs);
+		long first, last;
+		if (GetNumberNewImages(&first, &last) != DRV_SUCCESS) {
+			if (waited != DRV_SUCCESS)
+				error = waited;
+			continue;
+		}
+		if (last - first + 1 > count - fetched)
+			last = first + (count - fetched) - 1;
+		long validFirst, validLast;
+		error = GetImages16(first, last, frames + (size_t)fetched * pixels,
+			pixels * (last - first + 1), &validFirst, &validLast);
+		if (error == DRV_SUCCESS)
+			fetched += (int)(last - first + 1);
+	}
+	int status;
+	if (GetStatus(&status) == DRV_SUCCESS && status == DRV_ACQUIRING)
+		AbortAcquisition();
+	return error;
+}
+
+//------------------------------------------------------------------------------
+// Public interface
+//------------------------------------------------------------------------------
+
+SqPoint SqMakePoint(const AcquisitionSettings *settings)
+{
+	SqPoint point;
+	point.settings = *settings;
+	point.emGain = -1;
+	point.timeoutMs = 0;
+	return point;
+}
+
+unsigned int SqRunSweep(const std::vector<SqPoint> &points, SettingsShadow *shadow, const SqProcessFn &process,
+	std::vector<SqPointReport> *reports, SqSummary *summary)
+{
+	if (shadow == NULL)
+		return DRV_P2INVALID;
+
+	SqPipeline pipeline;
+	for (int b = 0; b < kSqBuffers; b++)
+		pipeline.free.push_back(b);
+	pipeline.finished = false;
+	std::thread processor(SqProcessLoop, &pipeline, &process);
+
+	SqClock::time_point sweepStart = SqClock::now();
+	SqClock::time_point previousEnd = sweepStart;
+	unsigned int firstError = DRV_SUCCESS;
+	double exposureMs = 0.0;
+	int buffer = -1;
+	for (size_t p = 0; p < points.size(); p++) {
+		const SqPoint &point = points[p];
+		const AcquisitionSettings &settings = point.settings;
+		SqPointReport report = {};
+		report.point = (int)p;
+		if (buffer < 0)
+			report.stallMs += SqClaimBuffer(&pipeline, &buffer);
+		SqSizeBuffer(&pipeline, buffer, &settings);
+
+		SqClock::time_point setupStart = SqClock::now();
+		unsigned int error = SqConfigure(point, shadow, &report);
+		SqClock::time_point acquireStart = SqClock::now();
+		report.setupMs = SqMilliseconds(setupStart, acquireStart);
+		if (error == DRV_SUCCESS)
+			error = StartAcquisition();
+
+		int width = (settings.hend - settings.hstart + 1) / settings.hbin;
+		int height = (settings.vend - settings.vstart + 1) / settings.vbin;
+		int count = SqFrameCount(&settings);
+		if (error == DRV_SUCCESS) {
+			// The camera is exposing: get the next point's buffer ready meanwhile
+			int next = -1;
+			if (p + 1 < points.size()) {
+				report.stallMs += SqClaimBuffer(&pipeline, &next);
+				SqSizeBuffer(&pipeline, next, &points[p + 1].settings);
+			}
+			error = SqFetch(point, &report, pipeline.buffers[buffer].data(), width, height, count);
+			report.acquireMs = SqMilliseconds(acquireStart, SqClock::now());
+			if (error == DRV_SUCCESS) {
+				std::lock_guard<std::mutex> guard(pipeline.lock);
+				pipeline.queued.push_back({ (int)p, buffer, width, height, count });
+				pipeline.changed.notify_all();
+			}
+			else {
+				std::lock_guard<std::mutex> guard(pipeline.lock);
+				pipeline.free.push_back(buffer);
+			}
+			buffer = next;
+		}
+
+		SqClock::time_point end = SqClock::now();
+		report.result = error;
+		report.frames = error == DRV_SUCCESS ? count : 0;
+		double exposed = report.frames * report.exposure * 1000.0;
+		report.deadMs = SqMilliseconds(previousEnd, end) - exposed;
+		exposureMs += exposed;
+		previousEnd = end;
+		if (error != DRV_SUCCESS && firstError == DRV_SUCCESS)
+			firstError = error;
+		if (reports)
+			reports->push_back(report);
+	}
+
+	{
+		std::lock_guard<std::mutex> guard(pipeline.lock);
+		pipeline.finished = true;
+		pipeline.changed.notify_all();
+	}
+	processor.join();
+
+	if (summary) {
+		summary->points = (int)points.size();
+		summary->totalMs = SqMilliseconds(sweepStart, SqClock::now());
+		summary->exposureMs = exposureMs;
+		summary->deadMs = summary->totalMs - exposureMs;
+		summary->efficiency = summary->totalMs > 0.0 ? exposureMs / summary->totalMs : 0.0;
+	}
+	return firstError;
+}
+
+unsigned int SqWriteCsv(const std::vector<SqPointReport> &reports, const SqSummary *summary, const char *filename)
+{
+	if (filename == NULL)
+		return DRV_P3INVALID;
+
+	FILE *file = fopen(filename, "w");
+	if (file == NULL)
+		return DRV_ERROR_FILESAVE;
+	fprintf(file, "point,result,frames,exposure_ms,cycle_ms,setup_ms,acquire_ms,stall_ms,dead_ms\n");
+	for (const SqPointReport &report : reports)
+		fprintf(file, "%d,%u,%d,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f\n", report.point, report.result, report.frames,
+			report.exposure * 1000.0, report.cycleTime * 1000.0, report.setupMs, report.acquireMs,
+			report.stallMs, report.deadMs);
+	if (summary)
+		fprintf(file, "# points %d, total %.3f ms, exposure %.3f ms, dead %.3f ms, efficiency %.3f\n",
+			summary->points, summary->totalMs, summary->exposureMs, summary->deadMs, summary->efficiency);
+	return fclose(file) == 0 ? DRV_SUCCESS : DRV_ERROR_FILESAVE;
+}
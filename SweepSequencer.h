@@ -0,0 +1,66 @@
+// SweepSequencer.h : Pipelined acquisition of a list of settings points.
+//
+// Exposure, gain and gate sweeps used to run one process per point, paying
+// for start-up and a full reconfiguration every time. The sequencer runs the
+// whole list against one initialised camera and keeps the camera busy:
+//
+//   - each point is programmed through a SettingsShadow, so only the setters
+//     that differ from the previous point are called and PrepareAcquisition
+//     only runs when the buffers change shape;
+//   - the host buffer for the next point is claimed and sized while the
+//     current point exposes and reads out;
+//   - the frames of a finished point are processed on a separate thread while
+//     the camera is already acquiring the next one.
+//
+// The SDK refuses setters during an acquisition, so programming a point can
+// not itself overlap the previous readout; what remains between points is
+// reported per point as dead time, against the sum of the exposures.
+
+#pragma once
+
+#include <functional>
+#include <vector>
+
+#include "SettingsShadow.h"
+
+extern "C" {
+	#include "atmcd32d.h"
+}
+
+struct SqPoint {
+	AcquisitionSettings		settings;
+	int						emGain;			// -1 leaves the gain alone
+	std::function<unsigned int()> configure;	// further setters, e.g. gating; may be empty
+	int						timeoutMs;		// per frame, 0 derives it from the cycle time
+};
+
+struct SqPointReport {
+	int						point;
+	unsigned int			result;
+	int						frames;
+	float					exposure;		// seconds, as the SDK will use it
+	float					cycleTime;
+	double					setupMs;		// setters and PrepareAcquisition
+	double					acquireMs;		// StartAcquisition to the last frame fetched
+	double					stallMs;		// waiting for processing to free a buffer
+	double					deadMs;			// wall time since the previous point less exposure
+};
+
+struct SqSummary {
+	int						points;
+	double					totalMs;		// whole sweep, including the last processing
+	double					exposureMs;		// sum of exposures over all frames
+	double					deadMs;
+	double					efficiency;		// exposureMs / totalMs
+};
+
+// Called on the processing thread with a point's frames, one after another
+typedef std::function<void(int point, const WORD *frames, int width, int height, int count)> SqProcessFn;
+
+SqPoint SqMakePoint(const AcquisitionSettings *settings);
+
+// Runs every point, carrying on past failed ones. Returns the first error.
+unsigned int SqRunSweep(const std::vector<SqPoint> &points, SettingsShadow *shadow, const SqProcessFn &process,
+	std::vector<SqPointReport> *reports, SqSummary *summary);
+
+unsigned int SqWriteCsv(const std::vector<SqPointReport> &reports, const SqSummary *summary, const char *filename);
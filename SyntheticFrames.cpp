@@ -0,0 +1,403 @@
+// SyntheticFrames.cpp : Physically modelled synthetic frames for benchmarks and tests.
+//
+// Every pixel takes three random words: one for the Poisson draw, one for the
+// EM register and one for read noise. A row's words are generated in one go
+// by the vector generator into per-thread scratch, then consumed by a scalar
+// loop whose table lookups and short Poisson inversions would not vectorise.
+
+#include "stdafx.h"
+#include "SyntheticFrames.h"
+#include "SimdSupport.h"
+#include "WorkerPool.h"
+
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+
+static const int kSfLanes = 8;
+static const int kSfWordsPerPixel = 3;
+static const float kSfPoissonSwitch = 24.0f;	// above this mean the Poisson draw is Gaussian
+static const int kSfGammaSwitch = 8;			// above this many electrons the EM output is Gaussian
+static const int kSfPoissonMax = 64;			// highest count the inversion reaches
+static const int kSfGuideBits = 10;				// entries in the background search guide, log2
+
+//------------------------------------------------------------------------------
+// Random numbers
+//------------------------------------------------------------------------------
+
+static uint64_t SfSplitMix(uint64_t *state)
+{
+	uint64_t z = (*state += 0x9e3779b97f4a7c15ull);
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+	return z ^ (z >> 31);
+}
+
+static float SfUniform(uint64_t *state)
+{
+	return (float)((SfSplitMix(state) >> 40) + 0.5) * (1.0f / 16777216.0f);
+}
+
+// Inverse normal CDF at the centres of 65536 equal-probability bins
+static const float *SfNormalTable()
+{
+	static const std::vector<float> table = [] {
+		std::vector<float> t(65536);
+		for (int i = 0; i < 65536; i++) {
+			double p = (i + 0.5) / 65536.0, lo = -8.0, hi = 8.0;
+			for (int k = 0; k < 48; k++) {
+				double mid = 0.5 * (lo + hi);
+				if (0.5 * erfc(-mid / sqrt(2.0)) < p)
+					lo = mid;
+				else
+					hi = mid;
+			}
+			t[i] = (float)(0.5 * (lo + hi));
+		}
+		return t;
+	}();
+	return table.data();
+}
+
+SIMD_BEGIN_KERNELS
+
+// xoshiro128+ in kSfLanes independent lanes
+struct SfScalarOps {
+	struct V { uint32_t lane[kSfLanes]; };
+	static SIMD_INLINE V Load(const uint32_t *p) { V v; memcpy(v.lane, p, sizeof(v.lane)); return v; }
+	static SIMD_INLINE void Store(uint32_t *p, const V &v) { memcpy(p, v.lane, sizeof(v.lane)); }
+	static SIMD_INLINE V Add(const V &a, const V &b) { V r; for (int k = 0; k < kSfLanes; k++) r.lane[k] = a.lane[k] + b.lane[k]; return r; }
+	static SIMD_INLINE V Xor(const V &a, const V &b) { V r; for (int k = 0; k < kSfLanes; k++) r.lane[k] = a.lane[k] ^ b.lane[k]; return r; }
+	static SIMD_INLINE V Shl9(const V &a) { V r; for (int k = 0; k < kSfLanes; k++) r.lane[k] = a.lane[k] << 9; return r; }
+	static SIMD_INLINE V Rotl11(const V &a) { V r; for (int k = 0; k < kSfLanes; k++) r.lane[k] = (a.lane[k] << 11) | (a.lane[k] >> 21); return r; }
+};
+
+#if SIMD_X86
+struct SfAvx2Ops {
+	typedef __m256i V;
+	static SIMD_TARGET_AVX2 SIMD_INLINE V Load(const uint32_t *p) { return _mm256_loadu_si256((const __m256i *)p); }
+	static SIMD_TARGET_AVX2 SIMD_INLINE void Store(uint32_t *p, V v) { _mm256_storeu_si256((__m256i *)p, v); }
+	static SIMD_TARGET_AVX2 SIMD_INLINE V Add(V a, V b) { return _mm256_add_epi32(a, b); }
+	static SIMD_TARGET_AVX2 SIMD_INLINE V Xor(V a, V b) { return _mm256_xor_si256(a, b); }
+	static SIMD_TARGET_AVX2 SIMD_INLINE V Shl9(V a) { return _mm256_slli_epi32(a, 9); }
+	static SIMD_TARGET_AVX2 SIMD_INLINE V Rotl11(V a) { return _mm256_or_si256(_mm256_slli_epi32(a, 11), _mm256_srli_epi32(a, 21)); }
+};
+#endif
+
+// Fills out with count words (a multiple of kSfLanes) from the lane state
+template <class Ops>
+SIMD_INLINE void SfFillBody(uint32_t state[4][kSfLanes], uint32_t *out, size_t count)
+{
+	typename Ops::V s0 = Ops::Load(state[0]), s1 = Ops::Load(state[1]);
+	typename Ops::V s2 = Ops::Load(state[2]), s3 = Ops::Load(state[3]);
+	for (size_t i = 0; i < count; i += kSfLanes) {
+		Ops::Store(out + i, Ops::Add(s0, s3));
+		typename Ops::V t = Ops::Shl9(s1);
+		s2 = Ops::Xor(s2, s0);
+		s3 = Ops::Xor(s3, s1);
+		s1 = Ops::Xor(s1, s2);
+		s0 = Ops::Xor(s0, s3);
+		s2 = Ops::Xor(s2, t);
+		s3 = Ops::Rotl11(s3);
+	}
+	Ops::Store(state[0], s0);
+	Ops::Store(state[1], s1);
+	Ops::Store(state[2], s2);
+	Ops::Store(state[3], s3);
+}
+
+static void SfFillScalar(uint32_t state[4][kSfLanes], uint32_t *out, size_t count)
+{
+	SfFillBody<SfScalarOps>(state, out, count);
+}
+
+#if SIMD_X86
+static SIMD_TARGET_AVX2 SIMD_FLATTEN void SfFillAvx2(uint32_t state[4][kSfLanes], uint32_t *out, size_t count)
+{
+	SfFillBody<SfAvx2Ops>(state, out, count);
+}
+#endif
+
+SIMD_END_KERNELS
+
+//------------------------------------------------------------------------------
+// Frame generation
+//------------------------------------------------------------------------------
+
+// Electrons out of the EM register for n in, Gamma(n, gain)
+static SIMD_INLINE float SfMultiply(int n, float gain, uint32_t word, const float *normal)
+{
+	if (n == 0)
+		return 0.0f;
+	if (n > kSfGammaSwitch)
+		return n * gain + sqrtf((float)n) * gain * normal[word >> 16];
+	// Sum of n exponentials, from the product of n uniforms stepped by an LCG
+	float product = 1.0f;
+	for (int k = 0; k < n; k++) {
+		product *= ((word >> 8) + 0.5f) * (1.0f / 16777216.0f);
+		word = word * 747796405u + 2891336453u;
+	}
+	return -gain * logf(product);
+}
+
+template <typename T>
+static void SfGenerateRow(const SyntheticFrames *sf, uint32_t frame, int y, uint32_t *words, T *out)
+{
+	const SfParameters &p = sf->params;
+	const int width = p.width;
+	const float *normal = SfNormalTable();
+	const float *signal = &sf->signal[(size_t)y * width];
+	const double *expSignal = &sf->expSignal[(size_t)y * width];
+	const double *backgroundCdf = sf->backgroundCdf.data();
+	const float *columnBias = sf->columnBias.data();
+	const float perCount = 1.0f / p.sensitivity;
+	const float fullScale = (float)p.maxValue;
+	const bool em = p.emGain > 1.0f;
+
+	// Each row has its own stream, so rows can go to any thread in any order
+	uint64_t seed = ((uint64_t)p.seed << 32) ^ ((uint64_t)frame * 0x9e3779b97f4a7c15ull) ^ ((uint64_t)y * 0xd1b54a32d192ed03ull);
+	uint32_t state[4][kSfLanes];
+	for (int k = 0; k < kSfLanes; k++) {
+		uint64_t a = SfSplitMix(&seed), b = SfSplitMix(&seed);
+		state[0][k] = (uint32_t)a;
+		state[1][k] = (uint32_t)(a >> 32);
+		state[2][k] = (uint32_t)b;
+		state[3][k] = (uint32_t)(b >> 32) | 1;	// the state must not be all zero
+	}
+	size_t count = ((size_t)width * kSfWordsPerPixel + kSfLanes - 1) / kSfLanes * kSfLanes;
+#if SIMD_X86
+	if (GetSimdLevel() >= SIMD_AVX2)
+		SfFillAvx2(state, words, count);
+	else
+#endif
+		SfFillScalar(state, words, count);
+
+	for (int x = 0; x < width; x++) {
+		const uint32_t *w = words + (size_t)x * kSfWordsPerPixel;
+		float lambda = signal[x];
+		int n;
+		if (lambda == p.background && !sf->backgroundGuide.empty()) {
+			// Most pixels see only the background: start from its guide table
+			double u = (w[0] + 0.5) * (1.0 / 4294967296.0);
+			n = sf->backgroundGuide[w[0] >> (32 - kSfGuideBits)];
+			while (u > backgroundCdf[n])
+				n++;
+		}
+		else if (lambda < kSfPoissonSwitch) {
+			// Inversion from zero; the mean number of steps is lambda. Double
+			// precision keeps the sum from stalling short of u near 1.
+			double u = (w[0] + 0.5) * (1.0 / 4294967296.0);
+			double term = expSignal[x], cdf = term;
+			n = 0;
+			while (u > cdf && n < kSfPoissonMax) {
+				n++;
+				term *= lambda / n;
+				cdf += term;
+			}
+		}
+		else
+			n = std::max(0, (int)(lambda + sqrtf(lambda) * normal[w[0] >> 16] + 0.5f));
+
+		float electrons = em ? SfMultiply(n, p.emGain, w[1], normal) : (float)n;
+		float counts = columnBias[x] + (electrons + p.readNoise * normal[w[2] >> 16]) * perCount;
+		counts = std::min(std::max(counts + 0.5f, 0.0f), fullScale);
+		out[x] = (T)counts;
+	}
+}
+
+// Straight tracks of charge, walked one pixel at a time
+template <typename T>
+static void SfAddCosmics(const SyntheticFrames *sf, uint32_t frame, T *out)
+{
+	const SfParameters &p = sf->params;
+	if (!(p.cosmicRate > 0.0f))
+		return;
+	uint64_t seed = ((uint64_t)p.seed << 32) ^ ((uint64_t)frame * 0x9e3779b97f4a7c15ull) ^ 0x2545f4914f6cdd1dull;
+	int tracks = 0;
+	float limit = expf(-p.cosmicRate), product = SfUniform(&seed);
+	while (product > limit && tracks < 10000) {
+		tracks++;
+		product *= SfUniform(&seed);
+	}
+	float gain = (p.emGain > 1.0f ? p.emGain : 1.0f) / p.sensitivity;
+	for (int t = 0; t < tracks; t++) {
+		float x = SfUniform(&seed) * p.width, y = SfUniform(&seed) * p.height;
+		float angle = SfUniform(&seed) * 6.2831853f;
+		float dx = cosf(angle), dy = sinf(angle);
+		int length = 1 + (int)(-p.cosmicLength * logf(SfUniform(&seed)));
+		for (int s = 0; s < length; s++, x += dx, y += dy) {
+			if (x < 0.0f || y < 0.0f || x >= p.width || y >= p.height)
+				break;
+			T &pixel = out[(size_t)y * p.width + (size_t)x];
+			float counts = pixel + p.cosmicCharge * (0.5f + SfUniform(&seed)) * gain;
+			pixel = (T)std::min(counts, (float)p.maxValue);
+		}
+	}
+}
+
+template <typename T>
+static unsigned int SfGenerateT(SyntheticFrames *sf, uint32_t frame, T *out)
+{
+	if (sf == NULL || sf->signal.empty())
+		return DRV_P1INVALID;
+	if (out == NULL)
+		return DRV_P3INVALID;
+
+	auto task = [&](int y, int thread) {
+		SfGenerateRow(sf, frame, y, sf->scratch[thread].data(), out + (size_t)y * sf->params.width);
+	};
+	if (sf->pool)
+		sf->pool->Run(sf->params.height, task);
+	else
+		for (int y = 0; y < sf->params.height; y++)
+			task(y, 0);
+	SfAddCosmics(sf, frame, out);
+	return DRV_SUCCESS;
+}
+
+//------------------------------------------------------------------------------
+// Public interface
+//------------------------------------------------------------------------------
+
+void SfDefaultParameters(SfParameters *params, int width, int height)
+{
+	params->width = width;
+	params->height = height;
+	params->maxValue = 65535;
+	params->bias = 100.0f;
+	params->columnSigma = 1.5f;
+	params->readNoise = 8.0f;
+	params->sensitivity = 2.0f;
+	params->emGain = 1.0f;
+	params->background = 5.0f;
+	params->hotFraction = 1e-4f;
+	params->hotLevel = 200.0f;
+	// About two tracks per 512 x 512 frame
+	params->cosmicRate = 2.0f * width * height / (512.0f * 512.0f);
+	params->cosmicCharge = 500.0f;
+	params->cosmicLength = 8.0f;
+	params->sources = 20;
+	params->sourceFlux = 5000.0f;
+	params->sourceSigma = 1.5f;
+	params->seed = 1;
+}
+
+unsigned int SfQueryCamera(SfParameters *params)
+{
+	if (params == NULL)
+		return DRV_P1INVALID;
+
+	int width, height, depth;
+	unsigned int error = GetDetector(&width, &height);
+	if (error != DRV_SUCCESS)
+		return error;
+	if (width != params->width || height != params->height) {
+		params->cosmicRate *= (float)width * height / ((float)params->width * params->height);
+		params->width = width;
+		params->height = height;
+	}
+	if (GetBitDepth(0, &depth) == DRV_SUCCESS && depth > 0 && depth <= 16)
+		params->maxValue = (1 << depth) - 1;
+
+	// The EM amplifier is 0 and the conventional one 1 on EMCCDs; the
+	// sensitivity is for the fastest horizontal shift and the first pre-amp
+	int low, high, gain, amplifier = 0;
+	params->emGain = 1.0f;
+	if (GetEMGainRange(&low, &high) == DRV_SUCCESS && high > 1) {
+		amplifier = 1;
+		if (GetEMCCDGain(&gain) == DRV_SUCCESS && gain > 1) {
+			params->emGain = (float)std::min(std::max(gain, low), high);
+			amplifier = 0;
+		}
+	}
+	float sensitivity;
+	if (GetSensitivity(0, 0, amplifier, 0, &sensitivity) == DRV_SUCCESS && sensitivity > 0.0f)
+		params->sensitivity = sensitivity;
+	return DRV_SUCCESS;
+}
+
+unsigned int SfInitialise(SyntheticFrames *sf, const SfParameters *params, WorkerPool *pool)
+{
+	if (sf == NULL)
+		return DRV_P1INVALID;
+	if (params == NULL || params->width <= 0 || params->height <= 0 || params->maxValue <= 0
+		|| !(params->sensitivity > 0.0f) || params->background < 0.0f)
+		return DRV_P2INVALID;
+
+	const SfParameters &p = *params;
+	sf->params = p;
+	sf->pool = pool;
+	size_t pixels = (size_t)p.width * p.height;
+	uint64_t seed = p.seed;
+	const float *normal = SfNormalTable();
+
+	sf->columnBias.resize(p.width);
+	for (int x = 0; x < p.width; x++)
+		sf->columnBias[x] = p.bias + p.columnSigma * normal[SfSplitMix(&seed) >> 48];
+
+	sf->signal.assign(pixels, p.background);
+	size_t hot = (size_t)(pixels * p.hotFraction + 0.5f);
+	for (size_t h = 0; h < hot; h++)
+		sf->signal[SfSplitMix(&seed) % pixels] += p.hotLevel;
+
+	// Sources are summed over +-4 sigma, normalised to their flux
+	int reach = (int)ceilf(4.0f * p.sourceSigma);
+	float norm = p.sourceSigma > 0.0f ? p.sourceFlux / (6.2831853f * p.sourceSigma * p.sourceSigma) : 0.0f;
+	for (int s = 0; s < p.sources && norm > 0.0f; s++) {
+		float cx = SfUniform(&seed) * p.width, cy = SfUniform(&seed) * p.height;
+		for (int y = std::max(0, (int)cy - reach); y <= std::min(p.height - 1, (int)cy + reach); y++) {
+			for (int x = std::max(0, (int)cx - reach); x <= std::min(p.width - 1, (int)cx + reach); x++) {
+				float dx = x + 0.5f - cx, dy = y + 0.5f - cy;
+				sf->signal[(size_t)y * p.width + x] += norm * expf(-(dx * dx + dy * dy) / (2.0f * p.sourceSigma * p.sourceSigma));
+			}
+		}
+	}
+
+	sf->expSignal.resize(pixels);
+	for (size_t i = 0; i < pixels; i++)
+		sf->expSignal[i] = exp(-(double)sf->signal[i]);
+
+	// Guide table for the background (Chen and Asau): entry j is the first
+	// count whose CDF reaches j / 2^kSfGuideBits, so a search takes a step or two
+	sf->backgroundCdf.clear();
+	sf->backgroundGuide.clear();
+	if (p.background < kSfPoissonSwitch) {
+		double term = exp(-(double)p.background), cdf = term;
+		for (int n = 0; n < kSfPoissonMax; n++) {
+			sf->backgroundCdf.push_back(cdf);
+			term *= p.background / (n + 1);
+			cdf += term;
+		}
+		sf->backgroundCdf.push_back(2.0);		// stops every search
+		int guides = 1 << kSfGuideBits, n = 0;
+		for (int j = 0; j < guides; j++) {
+			while (sf->backgroundCdf[n] < (double)j / guides)
+				n++;
+			sf->backgroundGuide.push_back((uint8_t)n);
+		}
+	}
+
+	size_t words = ((size_t)p.width * kSfWordsPerPixel + kSfLanes - 1) / kSfLanes * kSfLanes;
+	sf->scratch.assign(pool ? pool->GetThreadCount() : 1, std::vector<uint32_t>(words));
+	return DRV_SUCCESS;
+}
+
+unsigned int SfGenerate16(SyntheticFrames *sf, uint32_t frame, WORD *out)
+{
+	return SfGenerateT(sf, frame, out);
+}
+
+unsigned int SfGenerate32(SyntheticFrames *sf, uint32_t frame, at_32 *out)
+{
+	return SfGenerateT(sf, frame, out);
+}
+
+void SfRelease(SyntheticFrames *sf)
+{
+	std::vector<float>().swap(sf->columnBias);
+	std::vector<float>().swap(sf->signal);
+	std::vector<double>().swap(sf->expSignal);
+	std::vector<double>().swap(sf->backgroundCdf);
+	std::vector<uint8_t>().swap(sf->backgroundGuide);
+	std::vector<std::vector<uint32_t> >().swap(sf->scratch);
+}
@@ -0,0 +1,83 @@
+// SyntheticFrames.h : Physically modelled synthetic frames for benchmarks and tests.
+//
+// Constant or uniformly random frames make compression, thresholding and noise
+// filters look better or worse than they are on real data. This generator
+// builds frames the way a camera does: an expected signal per pixel (sky and
+// dark background, hot pixels, Gaussian sources) is turned into electrons with
+// Poisson shot noise, multiplied through the EM register (gamma distributed
+// for n input electrons), has Gaussian read noise added at the output
+// amplifier and is converted to counts over a bias level with fixed column
+// structure. Cosmic-ray tracks are added per frame, and counts clip at the
+// digitiser's full scale.
+//
+// SfQueryCamera() fills the parameters from the camera attached (detector
+// size, bit depth, EM gain and its range, sensitivity in electrons per count)
+// so the frames match what that camera would produce.
+//
+// Frame k of a given seed is the same whatever the thread count. Random words
+// come from an 8-lane xoshiro128+ generator, in AVX2 registers where the CPU
+// has them, seeded afresh for every row; Gaussian deviates are looked up in a
+// 65536-entry inverse normal table, which clips the tails at about 4.2 sigma.
+// Rows are spread over a WorkerPool when one is given. Benchmarks that need
+// more than the generator's few hundred MB/s per core should generate a bank
+// of frames once and cycle through it.
+
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+extern "C" {
+	#include "atmcd32d.h"
+}
+
+class WorkerPool;
+
+struct SfParameters {
+	int					width;
+	int					height;
+	int					maxValue;		// full scale in counts, 2^bitDepth - 1
+	float				bias;			// counts
+	float				columnSigma;	// spread of the per-column bias, counts
+	float				readNoise;		// electrons rms at the output amplifier
+	float				sensitivity;	// electrons per count
+	float				emGain;			// 1 for the conventional amplifier
+	float				background;		// electrons per pixel per frame, sky and dark
+	float				hotFraction;	// fraction of pixels that are hot
+	float				hotLevel;		// extra electrons per frame in a hot pixel
+	float				cosmicRate;		// tracks per frame on average
+	float				cosmicCharge;	// electrons per pixel crossed
+	float				cosmicLength;	// mean track length, pixels
+	int					sources;		// Gaussian sources placed at random
+	float				sourceFlux;		// electrons per frame in each source
+	float				sourceSigma;	// pixels
+	uint32_t			seed;
+};
+
+struct SyntheticFrames {
+	SfParameters		params;
+	std::vector<float>	columnBias;		// bias plus column structure, width values
+	std::vector<float>	signal;			// expected electrons per pixel
+	std::vector<double>	expSignal;		// exp(-signal), for Poisson inversion
+	std::vector<double>	backgroundCdf;	// Poisson CDF of the background level
+	std::vector<uint8_t> backgroundGuide;	// first count to search from, by top bits of u
+	std::vector<std::vector<uint32_t> > scratch;	// random words per thread
+	WorkerPool			*pool;			// NULL runs on the calling thread
+};
+
+// Conventional-amplifier defaults for a frame of the given size
+void SfDefaultParameters(SfParameters *params, int width, int height);
+
+// Overrides size, full scale, EM gain and sensitivity with the current camera's
+unsigned int SfQueryCamera(SfParameters *params);
+
+// Lays out the bias columns, hot pixels and sources. pool may be NULL. It
+// may be shared with other stages run from the same thread, but never used
+// by two threads at once or from inside its own tasks.
+unsigned int SfInitialise(SyntheticFrames *sf, const SfParameters *params, WorkerPool *pool);
+
+// Writes frame number frame of the sequence
+unsigned int SfGenerate16(SyntheticFrames *sf, uint32_t frame, WORD *out);
+unsigned int SfGenerate32(SyntheticFrames *sf, uint32_t frame, at_32 *out);
+
+void SfRelease(SyntheticFrames *sf);
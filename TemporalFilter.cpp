@@ -0,0 +1,309 @@
+// TemporalFilter.cpp : Temporal cosmic-ray rejection across a kinetic series.
+//
+// Every ring slot holds a whole frame, so the K samples of a run of pixels are
+// K plain vector loads at the same offset. They are sorted in registers with
+// an odd-even transposition network, which is fully unrolled for each K.
+
+#include "stdafx.h"
+#include "TemporalFilter.h"
+#include "SimdSupport.h"
+#include "WorkerPool.h"
+
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+
+static const size_t kTfTilePixels = 16384;		// pixels per task, multiple of every lane count
+
+typedef void (*TfKernel)(const WORD *const *frames, WORD *out, size_t begin, size_t end,
+	TemporalMode mode, float clipSigma);
+
+//------------------------------------------------------------------------------
+// Per-ISA operations on a run of 16-bit pixels
+//------------------------------------------------------------------------------
+
+SIMD_BEGIN_KERNELS
+
+struct TfScalarOps {
+	typedef WORD V;
+	static const int kLanes = 1;
+	static SIMD_INLINE V Load(const WORD *p) { return *p; }
+	static SIMD_INLINE void Store(WORD *p, V v) { *p = v; }
+	static SIMD_INLINE V Min(V a, V b) { return a < b ? a : b; }
+	static SIMD_INLINE V Max(V a, V b) { return a < b ? b : a; }
+	static SIMD_INLINE V Avg(V a, V b) { return (WORD)(((unsigned int)a + b + 1) >> 1); }
+};
+
+#if SIMD_X86
+struct TfSse41Ops {
+	typedef __m128i V;
+	static const int kLanes = 8;
+	static SIMD_TARGET_SSE42 SIMD_INLINE V Load(const WORD *p) { return _mm_loadu_si128((const __m128i *)p); }
+	static SIMD_TARGET_SSE42 SIMD_INLINE void Store(WORD *p, V v) { _mm_storeu_si128((__m128i *)p, v); }
+	static SIMD_TARGET_SSE42 SIMD_INLINE V Min(V a, V b) { return _mm_min_epu16(a, b); }
+	static SIMD_TARGET_SSE42 SIMD_INLINE V Max(V a, V b) { return _mm_max_epu16(a, b); }
+	static SIMD_TARGET_SSE42 SIMD_INLINE V Avg(V a, V b) { return _mm_avg_epu16(a, b); }
+};
+
+struct TfAvx2Ops {
+	typedef __m256i V;
+	static const int kLanes = 16;
+	static SIMD_TARGET_AVX2 SIMD_INLINE V Load(const WORD *p) { return _mm256_loadu_si256((const __m256i *)p); }
+	static SIMD_TARGET_AVX2 SIMD_INLINE void Store(WORD *p, V v) { _mm256_storeu_si256((__m256i *)p, v); }
+	static SIMD_TARGET_AVX2 SIMD_INLINE V Min(V a, V b) { return _mm256_min_epu16(a, b); }
+	static SIMD_TARGET_AVX2 SIMD_INLINE V Max(V a, V b) { return _mm256_max_epu16(a, b); }
+	static SIMD_TARGET_AVX2 SIMD_INLINE V Avg(V a, V b) { return _mm256_avg_epu16(a, b); }
+};
+#endif
+
+//------------------------------------------------------------------------------
+// Shared kernel body
+//------------------------------------------------------------------------------
+
+// Mean of the sorted samples lying within clipSigma robust deviations of the
+// median. The deviation comes from the MAD, since a single cosmic ray in a
+// short window inflates the ordinary standard deviation enough to hide itself.
+static float TfClippedMean(const WORD *sorted, int count, float clipSigma)
+{
+	float median = (count & 1) ? sorted[count / 2]
+		: 0.5f * ((float)sorted[count / 2 - 1] + (float)sorted[count / 2]);
+
+	float dev[kTfMaxNetworkWindow];
+	for (int k = 0; k < count; k++)
+		dev[k] = fabsf((float)sorted[k] - median);
+	std::nth_element(dev, dev + count / 2, dev + count);
+	float sigma = 1.4826f * dev[count / 2];
+	float limit = clipSigma * (sigma > 1.0f ? sigma : 1.0f);	// floor at one ADU of quantisation
+
+	float sum = 0.0f;
+	int kept = 0;
+	for (int k = 0; k < count; k++) {
+		if (fabsf((float)sorted[k] - median) <= limit) {
+			sum += sorted[k];
+			kept++;
+		}
+	}
+	return kept ? sum / kept : median;
+}
+
+template <typename Ops, int K>
+static SIMD_INLINE void TfSortNetwork(typename Ops::V *v)
+{
+	for (int round = 0; round < K; round++) {
+		for (int i = round & 1; i + 1 < K; i += 2) {
+			typename Ops::V lo = Ops::Min(v[i], v[i + 1]);
+			v[i + 1] = Ops::Max(v[i], v[i + 1]);
+			v[i] = lo;
+		}
+	}
+}
+
+template <typename Ops, int K>
+static SIMD_INLINE size_t TfRun(const WORD *const *frames, WORD *out, size_t begin, size_t end,
+	TemporalMode mode, float clipSigma)
+{
+	const int lanes = Ops::kLanes;
+	size_t i = begin;
+	for (; i + lanes <= end; i += lanes) {
+		typename Ops::V v[K];
+		for (int k = 0; k < K; k++)
+			v[k] = Ops::Load(frames[k] + i);
+		TfSortNetwork<Ops, K>(v);
+
+		if (mode == TEMPORAL_MEDIAN) {
+			Ops::Store(out + i, (K & 1) ? v[K / 2] : Ops::Avg(v[K / 2 - 1], v[K / 2]));
+			continue;
+		}
+
+		// Transpose the sorted registers through memory, then clip per pixel
+		WORD sorted[K][lanes];
+		for (int k = 0; k < K; k++)
+			Ops::Store(sorted[k], v[k]);
+		for (int lane = 0; lane < lanes; lane++) {
+			WORD column[K];
+			for (int k = 0; k < K; k++)
+				column[k] = sorted[k][lane];
+			out[i + lane] = (WORD)(TfClippedMean(column, K, clipSigma) + 0.5f);
+		}
+	}
+	return i;
+}
+
+template <typename Ops, int K>
+static SIMD_INLINE void TfKernelBody(const WORD *const *frames, WORD *out, size_t begin, size_t end,
+	TemporalMode mode, float clipSigma)
+{
+	size_t done = TfRun<Ops, K>(frames, out, begin, end, mode, clipSigma);
+	TfRun<TfScalarOps, K>(frames, out, done, end, mode, clipSigma);
+}
+
+template <int K>
+static void TfKernelScalar(const WORD *const *frames, WORD *out, size_t begin, size_t end,
+	TemporalMode mode, float clipSigma)
+{
+	TfRun<TfScalarOps, K>(frames, out, begin, end, mode, clipSigma);
+}
+
+#if SIMD_X86
+template <int K>
+static SIMD_TARGET_SSE42 SIMD_FLATTEN void TfKernelSse41(const WORD *const *frames, WORD *out, size_t begin, size_t end,
+	TemporalMode mode, float clipSigma)
+{
+	TfKernelBody<TfSse41Ops, K>(frames, out, begin, end, mode, clipSigma);
+}
+
+template <int K>
+static SIMD_TARGET_AVX2 SIMD_FLATTEN void TfKernelAvx2(const WORD *const *frames, WORD *out, size_t begin, size_t end,
+	TemporalMode mode, float clipSigma)
+{
+	TfKernelBody<TfAvx2Ops, K>(frames, out, begin, end, mode, clipSigma);
+}
+#endif
+
+#define TF_KERNEL_TABLE(NAME) { NULL, \
+	NAME<1>, NAME<2>, NAME<3>, NAME<4>, NAME<5>, NAME<6>, NAME<7>, NAME<8>, \
+	NAME<9>, NAME<10>, NAME<11>, NAME<12>, NAME<13>, NAME<14>, NAME<15>, NAME<16> }
+
+static const TfKernel kTfScalarKernels[kTfMaxNetworkWindow + 1] = TF_KERNEL_TABLE(TfKernelScalar);
+#if SIMD_X86
+static const TfKernel kTfSse41Kernels[kTfMaxNetworkWindow + 1] = TF_KERNEL_TABLE(TfKernelSse41);
+static const TfKernel kTfAvx2Kernels[kTfMaxNetworkWindow + 1] = TF_KERNEL_TABLE(TfKernelAvx2);
+#endif
+
+SIMD_END_KERNELS
+
+// Windows too long for a network: select per pixel
+static void TfKernelLongWindow(const WORD *const *frames, int window, WORD *out, size_t begin, size_t end,
+	TemporalMode mode, float clipSigma)
+{
+	std::vector<WORD> samples(window);
+	std::vector<float> dev(window);
+	for (size_t i = begin; i < end; i++) {
+		for (int k = 0; k < window; k++)
+			samples[k] = frames[k][i];
+
+		std::nth_element(samples.begin(), samples.begin() + window / 2, samples.end());
+		float median = samples[window / 2];
+		if (!(window & 1)) {
+			WORD below = *std::max_element(samples.begin(), samples.begin() + window / 2);
+			median = 0.5f * (median + below);
+		}
+		if (mode == TEMPORAL_MEDIAN) {
+			out[i] = (WORD)(median + 0.5f);
+			continue;
+		}
+
+		for (int k = 0; k < window; k++)
+			dev[k] = fabsf((float)samples[k] - median);
+		std::nth_element(dev.begin(), dev.begin() + window / 2, dev.end());
+		float sigma = 1.4826f * dev[window / 2];
+		float limit = clipSigma * (sigma > 1.0f ? sigma : 1.0f);
+		float sum = 0.0f;
+		int kept = 0;
+		for (int k = 0; k < window; k++) {
+			if (fabsf((float)samples[k] - median) <= limit) {
+				sum += samples[k];
+				kept++;
+			}
+		}
+		out[i] = (WORD)((kept ? sum / kept : median) + 0.5f);
+	}
+}
+
+//------------------------------------------------------------------------------
+// Public interface
+//------------------------------------------------------------------------------
+
+unsigned int TfInitialise(TemporalFilter *tf, int width, int height, int window,
+	TemporalMode mode, float clipSigma, WorkerPool *pool)
+{
+	if (tf == NULL)
+		return DRV_P1INVALID;
+	if (width <= 0)
+		return DRV_P2INVALID;
+	if (height <= 0)
+		return DRV_P3INVALID;
+	if (window < 1)
+		return DRV_P4INVALID;
+	if (mode != TEMPORAL_MEDIAN && mode != TEMPORAL_SIGMA_CLIP)
+		return DRV_P5INVALID;
+	if (mode == TEMPORAL_SIGMA_CLIP && !(clipSigma > 0.0f))
+		return DRV_P6INVALID;
+
+	tf->width = width;
+	tf->height = height;
+	tf->window = window;
+	tf->mode = mode;
+	tf->clipSigma = clipSigma;
+	tf->pool = pool;
+	tf->ring.assign((size_t)width * height * window, 0);
+	TfReset(tf);
+	return DRV_SUCCESS;
+}
+
+void TfReset(TemporalFilter *tf)
+{
+	tf->filled = 0;
+	tf->next = 0;
+}
+
+void TfRelease(TemporalFilter *tf)
+{
+	std::vector<WORD>().swap(tf->ring);
+	TfReset(tf);
+}
+
+unsigned int TfAddFrame(TemporalFilter *tf, const WORD *frame, WORD *out)
+{
+	if (tf == NULL || tf->ring.empty())
+		return DRV_P1INVALID;
+	if (frame == NULL)
+		return DRV_P2INVALID;
+	if (out == NULL)
+		return DRV_P3INVALID;
+
+	size_t pixels = (size_t)tf->width * tf->height;
+	memcpy(&tf->ring[pixels * tf->next], frame, pixels * sizeof(WORD));
+	tf->next = (tf->next + 1) % tf->window;
+	if (tf->filled < tf->window)
+		tf->filled++;
+	if (tf->filled < tf->window)
+		return DRV_NO_NEW_DATA;
+
+	// Order within the window does not matter for either statistic
+	std::vector<const WORD *> frames(tf->window);
+	for (int k = 0; k < tf->window; k++)
+		frames[k] = &tf->ring[pixels * k];
+
+	TfKernel kernel = NULL;
+	if (tf->window <= kTfMaxNetworkWindow) {
+		kernel = kTfScalarKernels[tf->window];
+#if SIMD_X86
+		SimdLevel level = GetSimdLevel();
+		if (level >= SIMD_AVX2)
+			kernel = kTfAvx2Kernels[tf->window];
+		else if (level >= SIMD_SSE42)
+			kernel = kTfSse41Kernels[tf->window];
+#endif
+	}
+
+	int tiles = (int)((pixels + kTfTilePixels - 1) / kTfTilePixels);
+	TemporalMode mode = tf->mode;
+	float clipSigma = tf->clipSigma;
+	int window = tf->window;
+	auto task = [&](int tile, int) {
+		size_t begin = (size_t)tile * kTfTilePixels;
+		size_t end = std::min(begin + kTfTilePixels, pixels);
+		if (kernel)
+			kernel(frames.data(), out, begin, end, mode, clipSigma);
+		else
+			TfKernelLongWindow(frames.data(), window, out, begin, end, mode, clipSigma);
+	};
+
+	if (tf->pool)
+		tf->pool->Run(tiles, task);
+	else
+		for (int tile = 0; tile < tiles; tile++)
+			task(tile, 0);
+	return DRV_SUCCESS;
+}
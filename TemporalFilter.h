@@ -0,0 +1,55 @@
+// TemporalFilter.h : Temporal cosmic-ray rejection across a kinetic series.
+//
+// The SDK spurious noise filter only looks within one frame. This stage keeps
+// a rolling window of the last K frames and outputs, per pixel, either the
+// temporal median or a sigma-clipped mean of the window, so a cosmic ray that
+// hits one scan is rejected while static signal is kept. Memory is bounded to
+// K frames however long the series runs.
+//
+// Windows up to kTfMaxNetworkWindow frames are sorted per pixel with a SIMD
+// sorting network, 16 pixels per AVX2 register; longer windows fall back to a
+// per-pixel selection. Each frame is split into tiles across a WorkerPool.
+
+#pragma once
+
+#include <vector>
+
+extern "C" {
+	#include "atmcd32d.h"
+}
+
+class WorkerPool;
+
+enum TemporalMode {
+	TEMPORAL_MEDIAN = 0,
+	TEMPORAL_SIGMA_CLIP = 1		// mean of samples within clipSigma of the median
+};
+
+static const int kTfMaxNetworkWindow = 16;
+
+struct TemporalFilter {
+	int					width;
+	int					height;
+	int					window;			// K, frames in the rolling window
+	TemporalMode		mode;
+	float				clipSigma;
+	int					filled;			// frames currently held, up to window
+	int					next;			// ring slot the next frame goes into
+	std::vector<WORD>	ring;			// window frames of width*height
+	WorkerPool			*pool;			// NULL runs on the calling thread
+};
+
+// pool may be NULL. It may be shared with other stages run from the same
+// thread, but never used by two threads at once or from inside its own tasks.
+unsigned int TfInitialise(TemporalFilter *tf, int width, int height, int window,
+	TemporalMode mode, float clipSigma, WorkerPool *pool);
+
+// Adds a frame to the window. Once the window is full every call writes the
+// filtered frame for the latest K frames to out and returns DRV_SUCCESS; while
+// it is still filling DRV_NO_NEW_DATA is returned and out is untouched.
+unsigned int TfAddFrame(TemporalFilter *tf, const WORD *frame, WORD *out);
+
+// Drops the window contents, e.g. when acquisition settings change
+void TfReset(TemporalFilter *tf);
+
+void TfRelease(TemporalFilter *tf);
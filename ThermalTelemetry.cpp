@@ -0,0 +1,184 @@
+// ThermalTelemetry.cpp : Background sensor temperature and TEC telemetry.
+//
+
+#include "stdafx.h"
+#include "ThermalTelemetry.h"
+#include "CameraManager.h"
+#if defined(SDK_RECORD) || defined(SDK_REPLAY)
+#include "StreamReplay.h"
+#endif
+
+#include <chrono>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+ThermalTelemetry::ThermalTelemetry(CameraManager *manager, int camera)
+	: mCount(0), mManager(manager), mCamera(camera), mPeriod(1.0), mStop(false)
+{
+	for (Slot &slot : mSlots)
+		slot.seq.store(0, std::memory_order_relaxed);
+}
+
+ThermalTelemetry::~ThermalTelemetry()
+{
+	Stop();
+}
+
+double ThermalTelemetry::Now()
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void ThermalTelemetry::Start(double periodSeconds)
+{
+	Stop();
+	mPeriod = periodSeconds > 0.0 ? periodSeconds : 1.0;
+	mStop = false;
+	mThread = std::thread(&ThermalTelemetry::ThreadMain, this);
+}
+
+void ThermalTelemetry::Stop()
+{
+	if (!mThread.joinable())
+		return;
+	{
+		std::lock_guard<std::mutex> guard(mLock);
+		mStop = true;
+	}
+	mWake.notify_all();
+	mThread.join();
+}
+
+void ThermalTelemetry::Sample(ThermalSample *sample)
+{
+	sample->temperature = 0.0f;
+	sample->tecOverheated = 0;
+	sample->coolerOn = 0;
+	auto calls = [&] {
+		sample->status = GetTemperatureF(&sample->temperature);
+		GetTECStatus(&sample->tecOverheated);
+		IsCoolerOn(&sample->coolerOn);
+		return (unsigned int)DRV_SUCCESS;
+	};
+	if (mManager)
+		mManager->Call(mCamera, calls);
+	else {
+		std::lock_guard<std::mutex> guard(mSdkLock);
+		calls();
+	}
+	sample->time = Now();
+}
+
+void ThermalTelemetry::Publish(const ThermalSample &sample)
+{
+	uint64_t n = mCount.load(std::memory_order_relaxed);
+	Slot &slot = mSlots[n % kSlots];
+	slot.seq.store(2 * n + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	slot.time.store(sample.time, std::memory_order_relaxed);
+	slot.temperature.store(sample.temperature, std::memory_order_relaxed);
+	slot.status.store(sample.status, std::memory_order_relaxed);
+	slot.tecOverheated.store(sample.tecOverheated, std::memory_order_relaxed);
+	slot.coolerOn.store(sample.coolerOn, std::memory_order_relaxed);
+	slot.seq.store(2 * n + 2, std::memory_order_release);
+	mCount.store(n + 1, std::memory_order_release);
+}
+
+bool ThermalTelemetry::ReadSlot(uint64_t n, ThermalSample *sample) const
+{
+	const Slot &slot = mSlots[n % kSlots];
+	uint64_t before = slot.seq.load(std::memory_order_acquire);
+	if (before != 2 * n + 2)
+		return false;		// being written, or already reused for a later sample
+	sample->time = slot.time.load(std::memory_order_relaxed);
+	sample->temperature = slot.temperature.load(std::memory_order_relaxed);
+	sample->status = slot.status.load(std::memory_order_relaxed);
+	sample->tecOverheated = slot.tecOverheated.load(std::memory_order_relaxed);
+	sample->coolerOn = slot.coolerOn.load(std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_acquire);
+	return slot.seq.load(std::memory_order_relaxed) == before;
+}
+
+void ThermalTelemetry::ThreadMain()
+{
+#ifdef _WIN32
+	SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_LOWEST);
+#endif
+	std::chrono::duration<double> period(mPeriod);
+	std::chrono::steady_clock::time_point next = std::chrono::steady_clock::now();
+	for (;;) {
+		ThermalSample sample;
+		Sample(&sample);
+		Publish(sample);
+
+		next += std::chrono::duration_cast<std::chrono::steady_clock::duration>(period);
+		std::unique_lock<std::mutex> lock(mLock);
+		if (mWake.wait_until(lock, next, [&] { return mStop; }))
+			return;
+	}
+}
+
+bool ThermalTelemetry::GetLatest(ThermalSample *sample) const
+{
+	// Only fails if the writer laps the reader, which at telemetry rates
+	// means the reader was descheduled for a whole ring; just try again
+	for (int attempt = 0; attempt < 4; attempt++) {
+		uint64_t count = mCount.load(std::memory_order_acquire);
+		if (count == 0)
+			return false;
+		if (ReadSlot(count - 1, sample))
+			return true;
+	}
+	return false;
+}
+
+bool ThermalTelemetry::GetSampleAt(double time, ThermalSample *sample) const
+{
+	uint64_t count = mCount.load(std::memory_order_acquire);
+	uint64_t oldest = count > (uint64_t)kSlots ? count - kSlots : 0;
+	// Frames are almost always newer than the last sample, so walk back
+	// from the newest
+	for (uint64_t n = count; n > oldest; n--) {
+		ThermalSample candidate;
+		if (!ReadSlot(n - 1, &candidate))
+			return false;
+		if (candidate.time <= time) {
+			*sample = candidate;
+			return true;
+		}
+	}
+	return false;
+}
+
+unsigned int ThermalTelemetry::WaitForTemperature(float low, float high, double stableSeconds, int timeoutMs)
+{
+	double start = Now();
+	double deadline = start + timeoutMs * 0.001;
+	double inRangeSince = -1.0;
+	uint64_t seen = 0;
+	for (;;) {
+		uint64_t count = mCount.load(std::memory_order_acquire);
+		ThermalSample sample;
+		if (count != seen && GetLatest(&sample)) {
+			seen = count;
+			bool valid = sample.status == DRV_SUCCESS
+				|| (sample.status >= DRV_TEMP_OFF && sample.status <= DRV_TEMP_DRIFT
+					&& sample.status != DRV_TEMP_OUT_RANGE && sample.status != DRV_TEMP_NOT_SUPPORTED);
+			if (!valid)
+				return sample.status;
+			if (sample.temperature >= low && sample.temperature <= high) {
+				if (inRangeSince < 0.0)
+					inRangeSince = sample.time;
+				if (sample.time - inRangeSince >= stableSeconds)
+					return DRV_SUCCESS;
+			}
+			else
+				inRangeSince = -1.0;
+		}
+		if (Now() >= deadline)
+			return DRV_TEMP_NOT_REACHED;
+		std::this_thread::sleep_for(std::chrono::duration<double>(mPeriod * 0.25));
+	}
+}
@@ -0,0 +1,99 @@
+// ThermalTelemetry.h : Background sensor temperature and TEC telemetry.
+//
+// A low-priority thread samples GetTemperatureF, GetTECStatus and IsCoolerOn
+// at a fixed period into a ring of samples. The ring is single-writer and
+// lock-free: each slot carries a sequence number that readers check before
+// and after copying it out, so readers never hold up the sampling thread and
+// the sampling thread never waits for a reader. Acquisition code stamps its
+// frames with ThermalTelemetry::Now() and asks for the sample in effect at a
+// frame's timestamp.
+//
+// WaitForTemperature() replaces a fixed cool-down: acquisition can start as
+// soon as the sensor has been inside a "good enough" band for a while, rather
+// than waiting for DRV_TEMP_STABILIZED.
+//
+// With a CameraManager the SDK calls go through its lock. Without one they
+// are made under GetSdkLock(), which any other thread calling the SDK while
+// sampling runs must hold around its own calls; holding it through a whole
+// acquisition simply pauses sampling until it is released. The SDK is never
+// called from two threads at once either way.
+
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+extern "C" {
+	#include "atmcd32d.h"
+}
+
+class CameraManager;
+
+struct ThermalSample {
+	double					time;			// ThermalTelemetry::Now() when sampled
+	float					temperature;	// degrees C
+	unsigned int			status;			// GetTemperatureF result, DRV_TEMP_* when valid
+	int						tecOverheated;	// GetTECStatus flag
+	int						coolerOn;		// IsCoolerOn status
+};
+
+class ThermalTelemetry {
+public:
+	// manager may be NULL for a single camera driven without one
+	explicit ThermalTelemetry(CameraManager *manager = nullptr, int camera = 0);
+	~ThermalTelemetry();
+
+	ThermalTelemetry(const ThermalTelemetry &) = delete;
+	ThermalTelemetry &operator=(const ThermalTelemetry &) = delete;
+
+	void Start(double periodSeconds);
+	void Stop();
+
+	// Clock used for sample times, in seconds; stamp frames with it too
+	static double Now();
+
+	bool GetLatest(ThermalSample *sample) const;
+
+	// Most recent sample taken at or before time. False when the ring no
+	// longer reaches back that far or nothing has been sampled yet.
+	bool GetSampleAt(double time, ThermalSample *sample) const;
+
+	// Blocks the caller until the temperature has stayed within [low, high]
+	// for stableSeconds. Returns DRV_TEMP_NOT_REACHED on timeout, or the SDK
+	// error when the camera cannot report its temperature.
+	unsigned int WaitForTemperature(float low, float high, double stableSeconds, int timeoutMs);
+
+	// Taken by the sampling thread around its SDK calls when there is no
+	// CameraManager. Release it before calling Stop().
+	std::mutex &GetSdkLock() { return mSdkLock; }
+
+private:
+	struct Slot {
+		std::atomic<uint64_t>		seq;		// 2n + 1 while sample n is written, 2n + 2 once done
+		std::atomic<double>			time;
+		std::atomic<float>			temperature;
+		std::atomic<unsigned int>	status;
+		std::atomic<int>			tecOverheated;
+		std::atomic<int>			coolerOn;
+	};
+	static const int kSlots = 1024;
+
+	void ThreadMain();
+	void Sample(ThermalSample *sample);
+	void Publish(const ThermalSample &sample);
+	bool ReadSlot(uint64_t n, ThermalSample *sample) const;
+
+	Slot					mSlots[kSlots];
+	std::atomic<uint64_t>	mCount;			// samples published
+	CameraManager			*mManager;
+	int						mCamera;
+	double					mPeriod;
+	std::thread				mThread;
+	std::mutex				mSdkLock;		// SDK calls without a CameraManager
+	std::mutex				mLock;			// only for the stop signal
+	std::condition_variable	mWake;
+	bool					mStop;
+};
@@ -0,0 +1,205 @@
+// TimeLapse.cpp : Time-lapse acquisition fired by software trigger on a fixed timeline.
+//
+
+#include "stdafx.h"
+#include "TimeLapse.h"
+
+#include <algorithm>
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <windows.h>
+
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+
+typedef std::chrono::steady_clock TlClock;
+
+// How long before each trigger the timer wakes the thread to spin. Without a
+// high-resolution timer (before Windows 10 1803) waits round to the tick.
+static const double kTlSpinHighRes = 0.001;
+static const double kTlSpinLowRes = 0.020;
+
+TimeLapse::TimeLapse()
+	: mTimer(NULL), mStopEvent(NULL), mStop(false), mResult(DRV_SUCCESS)
+{
+	mSchedule = {};
+}
+
+TimeLapse::~TimeLapse()
+{
+	Stop();
+}
+
+unsigned int TimeLapse::Start(const TlSchedule *schedule, const TlFrameFn &onFrame)
+{
+	if (schedule == NULL || schedule->interval <= 0.0 || schedule->count <= 0
+		|| schedule->width <= 0 || schedule->height <= 0)
+		return DRV_P1INVALID;
+	Stop();
+
+	unsigned int error = SetAcquisitionMode(5);
+	if (error == DRV_SUCCESS)
+		error = SetTriggerMode(10);
+	if (error == DRV_SUCCESS)
+		error = IsTriggerModeAvailable(10);
+	if (error != DRV_SUCCESS)
+		return error;
+
+	mTimer = CreateWaitableTimerExW(NULL, NULL, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+	if (mTimer == NULL)
+		mTimer = CreateWaitableTimerW(NULL, TRUE, NULL);
+	mStopEvent = CreateEventW(NULL, TRUE, FALSE, NULL);
+	if (mTimer == NULL || mStopEvent == NULL) {
+		Stop();
+		return DRV_NOT_AVAILABLE;
+	}
+
+	error = StartAcquisition();
+	if (error != DRV_SUCCESS) {
+		Stop();
+		return error;
+	}
+
+	mSchedule = *schedule;
+	mOnFrame = onFrame;
+	mEvents.clear();
+	mEvents.reserve(schedule->count);
+	mBuffer.resize((size_t)schedule->width * schedule->height);
+	mStop = false;
+	mResult = DRV_SUCCESS;
+	mThread = std::thread(&TimeLapse::ThreadMain, this);
+	return DRV_SUCCESS;
+}
+
+unsigned int TimeLapse::Wait()
+{
+	if (mThread.joinable())
+		mThread.join();
+	AbortAcquisition();
+	return mResult;
+}
+
+void TimeLapse::Stop()
+{
+	if (mThread.joinable()) {
+		mStop = true;
+		SetEvent(mStopEvent);
+		CancelWait();
+		mThread.join();
+		AbortAcquisition();
+	}
+	if (mTimer)
+		CloseHandle(mTimer);
+	if (mStopEvent)
+		CloseHandle(mStopEvent);
+	mTimer = NULL;
+	mStopEvent = NULL;
+}
+
+void TimeLapse::ThreadMain()
+{
+	SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL);
+
+	// Probe whether the timer is high resolution: a fallback timer rounds
+	// a 0.5 ms wait up to the scheduler tick
+	TlClock::time_point probe = TlClock::now();
+	LARGE_INTEGER due;
+	due.QuadPart = -5000;
+	SetWaitableTimer(mTimer, &due, 0, NULL, NULL, FALSE);
+	WaitForSingleObject(mTimer, INFINITE);
+	double spin = std::chrono::duration<double>(TlClock::now() - probe).count() < 0.004 ? kTlSpinHighRes : kTlSpinLowRes;
+
+	int timeoutMs = mSchedule.frameTimeoutMs > 0 ? mSchedule.frameTimeoutMs : (int)(mSchedule.interval * 1000.0) + 1;
+	unsigned long pixels = (unsigned long)mBuffer.size();
+	TlClock::duration interval = std::chrono::duration_cast<TlClock::duration>(std::chrono::duration<double>(mSchedule.interval));
+	TlClock::time_point first = TlClock::now()
+		+ std::chrono::duration_cast<TlClock::duration>(std::chrono::duration<double>(mSchedule.startDelay));
+	HANDLE handles[2] = { mStopEvent, mTimer };
+
+	for (int k = 0; k < mSchedule.count && !mStop; k++) {
+		TlClock::time_point target = first + interval * k;
+
+		// Sleep until just before the instant, then spin up to it
+		double remaining = std::chrono::duration<double>(target - TlClock::now()).count();
+		if (remaining > spin) {
+			due.QuadPart = -(LONGLONG)((remaining - spin) * 1e7);
+			SetWaitableTimer(mTimer, &due, 0, NULL, NULL, FALSE);
+			if (WaitForMultipleObjects(2, handles, FALSE, INFINITE) == WAIT_OBJECT_0)
+				break;
+		}
+		while (TlClock::now() < target)
+			;
+
+		TlEvent event;
+		event.index = k;
+		event.due = std::chrono::duration<double>(target - first).count();
+		unsigned int error = SendSoftwareTrigger();
+		TlClock::time_point fired = TlClock::now();
+		event.fired = std::chrono::duration<double>(fired - first).count();
+		event.received = 0.0;
+		if (error == DRV_SUCCESS)
+			error = WaitForAcquisitionTimeOut(timeoutMs);
+		if (error == DRV_SUCCESS)
+			error = GetOldestImage16(mBuffer.data(), pixels);
+		if (error == DRV_SUCCESS) {
+			event.received = std::chrono::duration<double>(TlClock::now() - first).count();
+			if (mOnFrame)
+				mOnFrame(k, mBuffer.data(), mSchedule.width, mSchedule.height, event.received);
+		}
+		else if (mResult == DRV_SUCCESS && !mStop)
+			mResult = error;
+		event.result = error;
+		mEvents.push_back(event);
+	}
+}
+
+void TimeLapse::GetStats(TlStats *stats) const
+{
+	*stats = {};
+	std::vector<double> lateness;
+	double latency = 0.0;
+	int received = 0;
+	for (const TlEvent &event : mEvents) {
+		if (event.result != DRV_SUCCESS)
+			stats->missed++;
+		lateness.push_back((event.fired - event.due) * 1e6);
+		if (event.received > 0.0) {
+			latency += (event.received - event.fired) * 1e3;
+			received++;
+		}
+	}
+	stats->events = (int)mEvents.size();
+	if (lateness.empty())
+		return;
+
+	double sum = 0.0, squares = 0.0;
+	for (double value : lateness) {
+		sum += value;
+		squares += value * value;
+	}
+	double n = (double)lateness.size();
+	stats->meanLateness = sum / n;
+	stats->stdLateness = sqrt(std::max(0.0, squares / n - stats->meanLateness * stats->meanLateness));
+	std::sort(lateness.begin(), lateness.end());
+	stats->minLateness = lateness.front();
+	stats->maxLateness = lateness.back();
+	stats->p99Lateness = lateness[(size_t)((n - 1) * 0.99)];
+	stats->meanLatency = received ? latency / received : 0.0;
+}
+
+unsigned int TimeLapse::WriteCsv(const char *filename) const
+{
+	if (filename == NULL)
+		return DRV_P1INVALID;
+
+	FILE *file = fopen(filename, "w");
+	if (file == NULL)
+		return DRV_ERROR_FILESAVE;
+	fprintf(file, "index,due_s,fired_s,received_s,lateness_us,result\n");
+	for (const TlEvent &event : mEvents)
+		fprintf(file, "%d,%.6f,%.6f,%.6f,%.1f,%u\n", event.index, event.due, event.fired,
+			event.received, (event.fired - event.due) * 1e6, event.result);
+	return fclose(file) == 0 ? DRV_SUCCESS : DRV_ERROR_FILESAVE;
+}
@@ -0,0 +1,89 @@
+// TimeLapse.h : Time-lapse acquisition fired by software trigger on a fixed timeline.
+//
+// Sleeping for the interval between StartAcquisition calls drifts, because
+// every frame's set-up and read-out time is added to the sleep. The scheduler
+// instead starts one run till abort acquisition in software trigger mode
+// (trigger mode 10, as in the Continuous example) and fires SendSoftwareTrigger
+// at start + k * interval on the steady clock, so lateness never accumulates.
+//
+// A dedicated time-critical thread sleeps on a high-resolution waitable timer
+// until shortly before each instant and spins the rest of the way. The same
+// thread then waits for the frame, fetches it and hands it to the callback,
+// which must return well within the interval; pass it on to a FrameBroadcast
+// or another thread for anything slow. Each event records when it was due,
+// when the trigger went out and when the frame arrived.
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <thread>
+#include <vector>
+
+extern "C" {
+	#include "atmcd32d.h"
+}
+
+struct TlSchedule {
+	double					interval;		// seconds between triggers
+	int						count;			// triggers to fire
+	double					startDelay;		// seconds from Start() to the first trigger
+	int						width;			// image size set up with SetImage
+	int						height;
+	int						frameTimeoutMs;	// 0 waits at most one interval
+};
+
+struct TlEvent {
+	int						index;
+	double					due;			// seconds after the first trigger was due
+	double					fired;			// SendSoftwareTrigger returned
+	double					received;		// frame fetched, or 0 when none came
+	unsigned int			result;
+};
+
+struct TlStats {
+	int						events;
+	int						missed;			// trigger or frame failed
+	double					meanLateness;	// fired - due, microseconds
+	double					stdLateness;
+	double					minLateness;
+	double					maxLateness;
+	double					p99Lateness;
+	double					meanLatency;	// received - fired, milliseconds
+};
+
+typedef std::function<void(int index, const WORD *frame, int width, int height, double time)> TlFrameFn;
+
+class TimeLapse {
+public:
+	TimeLapse();
+	~TimeLapse();
+
+	TimeLapse(const TimeLapse &) = delete;
+	TimeLapse &operator=(const TimeLapse &) = delete;
+
+	// The image area and exposure must already be set. Switches to run till
+	// abort with software triggering, starts the acquisition and the thread.
+	unsigned int Start(const TlSchedule *schedule, const TlFrameFn &onFrame);
+	// Blocks until every trigger has fired; returns the first error
+	unsigned int Wait();
+	// Cancels the remaining triggers
+	void Stop();
+
+	const std::vector<TlEvent> &GetEvents() const { return mEvents; }
+	void GetStats(TlStats *stats) const;
+	unsigned int WriteCsv(const char *filename) const;
+
+private:
+	void ThreadMain();
+
+	TlSchedule				mSchedule;
+	TlFrameFn				mOnFrame;
+	std::vector<TlEvent>	mEvents;
+	std::vector<WORD>		mBuffer;
+	std::thread				mThread;
+	void					*mTimer;		// waitable timer
+	void					*mStopEvent;
+	std::atomic<bool>		mStop;
+	unsigned int			mResult;
+};
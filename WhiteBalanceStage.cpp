@@ -0,0 +1,189 @@
+// WhiteBalanceStage.cpp : Streaming white balance statistics and correction.
+//
+
+#include "stdafx.h"
+#include "WhiteBalanceStage.h"
+
+static int WbClampIndex(int value, int limit)
+{
+	if (value < 0)
+		return 0;
+	if (value > limit)
+		return limit;
+	return value;
+}
+
+static BYTE WbToByte(float value)
+{
+	if (value <= 0.0f)
+		return 0;
+	if (value >= 255.0f)
+		return 255;
+	return (BYTE)(value + 0.5f);
+}
+
+unsigned int WbInitialise(WbState *state, const WhiteBalanceInfo *info, float smoothing)
+{
+	if (state == NULL)
+		return DRV_P1INVALID;
+	if (info == NULL || info->iX <= 0 || info->iY <= 0)
+		return DRV_P2INVALID;
+	if (!(smoothing > 0.0f && smoothing <= 1.0f))
+		return DRV_P3INVALID;
+
+	state->info = *info;
+	state->info.iSize = sizeof(WhiteBalanceInfo);
+
+	// Normalise the ROI so accumulation only needs simple bounds checks. An
+	// empty or out of range ROI falls back to the whole frame.
+	int left = WbClampIndex(info->iROI_left, info->iX);
+	int right = WbClampIndex(info->iROI_right, info->iX);
+	int bottom = WbClampIndex(info->iROI_bottom, info->iY);
+	int top = WbClampIndex(info->iROI_top, info->iY);
+	if (left > right) { int t = left; left = right; right = t; }
+	if (bottom > top) { int t = bottom; bottom = top; top = t; }
+	if (left < 1 || bottom < 1) {
+		left = 1; right = info->iX;
+		bottom = 1; top = info->iY;
+	}
+	state->info.iROI_left = left;
+	state->info.iROI_right = right;
+	state->info.iROI_bottom = bottom;
+	state->info.iROI_top = top;
+
+	state->smoothing = smoothing;
+	state->gainR = 1.0f;
+	state->gainG = 1.0f;
+	state->gainB = 1.0f;
+	state->frames = 0;
+	WbBeginFrame(state);
+	return DRV_SUCCESS;
+}
+
+void WbBeginFrame(WbState *state)
+{
+	state->sumR = 0;
+	state->sumG = 0;
+	state->sumB = 0;
+	state->count = 0;
+}
+
+void WbAccumulateRow(WbState *state, int row, const WORD *red, const WORD *green, const WORD *blue)
+{
+	// row is 0-based in buffer order, the ROI is 1-based like SetImage()
+	if (row + 1 < state->info.iROI_bottom || row + 1 > state->info.iROI_top)
+		return;
+
+	int first = state->info.iROI_left - 1;
+	int last = state->info.iROI_right;
+	unsigned long sumR = 0, sumG = 0, sumB = 0;	// one row cannot overflow 32 bits
+	for (int x = first; x < last; x++) {
+		sumR += red[x];
+		sumG += green[x];
+		sumB += blue[x];
+	}
+	state->sumR += sumR;
+	state->sumG += sumG;
+	state->sumB += sumB;
+	state->count += (unsigned long)(last - first);
+}
+
+void WbEndFrame(WbState *state)
+{
+	if (state->count == 0 || state->sumR == 0 || state->sumB == 0)
+		return;
+
+	// Grey world over the ROI, green is the reference channel
+	float newR = (float)((double)state->sumG / (double)state->sumR);
+	float newB = (float)((double)state->sumG / (double)state->sumB);
+
+	if (state->frames == 0) {
+		state->gainR = newR;
+		state->gainB = newB;
+	}
+	else {
+		state->gainR += state->smoothing * (newR - state->gainR);
+		state->gainB += state->smoothing * (newB - state->gainB);
+	}
+	state->frames++;
+}
+
+void WbGetRelativeGains(const WbState *state, float *fRelR, float *fRelB)
+{
+	if (fRelR)
+		*fRelR = state->gainR;
+	if (fRelB)
+		*fRelB = state->gainB;
+}
+
+unsigned int WbConvertToBGR(WbState *state, const WORD *red, const WORD *green, const WORD *blue,
+	WORD black, WORD white, BYTE *bgr, int bgrStride)
+{
+	if (state == NULL)
+		return DRV_P1INVALID;
+	if (red == NULL || green == NULL || blue == NULL)
+		return DRV_P2INVALID;
+	if (white <= black)
+		return DRV_P6INVALID;
+	if (bgr == NULL)
+		return DRV_P7INVALID;
+	if (bgrStride < state->info.iX * 3)
+		return DRV_P8INVALID;
+
+	int width = state->info.iX;
+	int height = state->info.iY;
+	float range = 255.0f / (float)(white - black);
+	float scaleR = state->gainR * range;
+	float scaleG = state->gainG * range;
+	float scaleB = state->gainB * range;
+	float offset = (float)black;
+
+	WbBeginFrame(state);
+	for (int y = 0; y < height; y++) {
+		const WORD *r = red + (size_t)y * width;
+		const WORD *g = green + (size_t)y * width;
+		const WORD *b = blue + (size_t)y * width;
+		BYTE *out = bgr + (size_t)y * bgrStride;
+
+		WbAccumulateRow(state, y, r, g, b);
+		for (int x = 0; x < width; x++) {
+			out[3 * x + 0] = WbToByte(((float)b[x] - offset) * scaleB);
+			out[3 * x + 1] = WbToByte(((float)g[x] - offset) * scaleG);
+			out[3 * x + 2] = WbToByte(((float)r[x] - offset) * scaleR);
+		}
+	}
+	WbEndFrame(state);
+	return DRV_SUCCESS;
+}
+
+unsigned int WbApplyInPlace(WbState *state, WORD *red, WORD *green, WORD *blue)
+{
+	if (state == NULL)
+		return DRV_P1INVALID;
+	if (red == NULL || green == NULL || blue == NULL)
+		return DRV_P2INVALID;
+
+	int width = state->info.iX;
+	int height = state->info.iY;
+	float gainR = state->gainR;
+	float gainB = state->gainB;
+
+	WbBeginFrame(state);
+	for (int y = 0; y < height; y++) {
+		WORD *r = red + (size_t)y * width;
+		WORD *g = green + (size_t)y * width;
+		WORD *b = blue + (size_t)y * width;
+
+		// Statistics must see the uncorrected values, so gather the row
+		// while it is still hot in cache and before it is rewritten
+		WbAccumulateRow(state, y, r, g, b);
+		for (int x = 0; x < width; x++) {
+			float vr = (float)r[x] * gainR;
+			float vb = (float)b[x] * gainB;
+			r[x] = (WORD)(vr >= 65535.0f ? 65535 : (int)(vr + 0.5f));
+			b[x] = (WORD)(vb >= 65535.0f ? 65535 : (int)(vb + 0.5f));
+		}
+	}
+	WbEndFrame(state);
+	return DRV_SUCCESS;
+}
@@ -0,0 +1,49 @@
+// WhiteBalanceStage.h : Streaming white balance for continuous colour acquisition.
+//
+// WhiteBalance() in the SDK computes the red/blue gains from an ROI in its own
+// pass over the demosaiced planes. For continuous imaging the statistics are
+// instead gathered row by row while the planes are being converted for output,
+// and the gains derived from frame N are smoothed and applied to frame N+1.
+// White balance therefore never needs an extra full-frame pass.
+
+#pragma once
+
+extern "C" {
+	#include "atmcd32d.h"
+}
+
+struct WbState {
+	WhiteBalanceInfo	info;			// iX/iY frame size, 1-based inclusive ROI
+	float				smoothing;		// weight given to each new estimate (0..1]
+	float				gainR;			// gains currently applied to output,
+	float				gainG;			// green is always 1 (SDK convention
+	float				gainB;			// of red/blue relative to green)
+	unsigned long long	sumR;			// ROI sums for the frame in progress
+	unsigned long long	sumG;
+	unsigned long long	sumB;
+	unsigned long		count;
+	int					frames;			// frames folded into the gains so far
+};
+
+// Prepare a state for frames of info->iX by info->iY pixels. smoothing is the
+// weight of the newest estimate; 1 disables temporal smoothing.
+unsigned int WbInitialise(WbState *state, const WhiteBalanceInfo *info, float smoothing);
+
+// Statistics hooks for passes that already touch every row (demosaic, etc.).
+// Rows outside the ROI are ignored, so callers may feed every row unfiltered.
+void WbBeginFrame(WbState *state);
+void WbAccumulateRow(WbState *state, int row, const WORD *red, const WORD *green, const WORD *blue);
+void WbEndFrame(WbState *state);
+
+// Relative gains in the same form WhiteBalance() returns them.
+void WbGetRelativeGains(const WbState *state, float *fRelR, float *fRelB);
+
+// Fused output conversion: scales the demosaiced planes between black and white
+// into a bottom-up 24-bit BGR DIB with the current gains, collecting the ROI
+// statistics for the next frame on the way through.
+unsigned int WbConvertToBGR(WbState *state, const WORD *red, const WORD *green, const WORD *blue,
+	WORD black, WORD white, BYTE *bgr, int bgrStride);
+
+// Fused 16-bit conversion: applies the current gains to the planes in place,
+// collecting the ROI statistics from the unscaled values as it goes.
+unsigned int WbApplyInPlace(WbState *state, WORD *red, WORD *green, WORD *blue);
@@ -0,0 +1,82 @@
+// WorkerPool.cpp : Persistent worker threads for splitting a frame across cores.
+//
+
+#include "stdafx.h"
+#include "WorkerPool.h"
+
+WorkerPool::WorkerPool(int threads)
+	: mTask(nullptr), mNext(0), mCount(0), mBusy(0), mGeneration(0), mStop(false)
+{
+	if (threads <= 0)
+		threads = (int)std::thread::hardware_concurrency();
+	if (threads <= 0)
+		threads = 1;
+	for (int i = 1; i < threads; i++)
+		mWorkers.emplace_back(&WorkerPool::WorkerMain, this, i);
+}
+
+WorkerPool::~WorkerPool()
+{
+	{
+		std::lock_guard<std::mutex> guard(mLock);
+		mStop = true;
+	}
+	mWake.notify_all();
+	for (auto &worker : mWorkers)
+		worker.join();
+}
+
+void WorkerPool::Drain(int thread)
+{
+	int index;
+	while ((index = mNext.fetch_add(1)) < mCount)
+		(*mTask)(index, thread);
+}
+
+void WorkerPool::WorkerMain(int thread)
+{
+	unsigned int seen = 0;
+	for (;;) {
+		{
+			std::unique_lock<std::mutex> lock(mLock);
+			mWake.wait(lock, [&] { return mStop || mGeneration != seen; });
+			if (mStop)
+				return;
+			seen = mGeneration;
+		}
+
+		Drain(thread);
+
+		std::lock_guard<std::mutex> guard(mLock);
+		if (--mBusy == 0)
+			mDone.notify_one();
+	}
+}
+
+void WorkerPool::Run(int count, const std::function<void(int, int)> &task)
+{
+	if (count <= 0)
+		return;
+	if (mWorkers.empty() || count == 1) {
+		for (int i = 0; i < count; i++)
+			task(i, 0);
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> guard(mLock);
+		mTask = &task;
+		mCount = count;
+		mNext.store(0);
+		mBusy = (int)mWorkers.size();
+		mGeneration++;
+	}
+	mWake.notify_all();
+
+	Drain(0);
+
+	// Workers still hold a pointer to task until they have checked in
+	std::unique_lock<std::mutex> lock(mLock);
+	mDone.wait(lock, [&] { return mBusy == 0; });
+	mTask = nullptr;
+}
@@ -0,0 +1,48 @@
+// WorkerPool.h : Persistent worker threads for splitting a frame across cores.
+//
+// Threads are created once and parked between frames, so handing a frame out
+// in tiles costs a wake-up rather than a thread start. The calling thread
+// takes part in the work, so a pool of one thread runs everything inline.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class WorkerPool {
+public:
+	// threads <= 0 uses one thread per hardware thread
+	explicit WorkerPool(int threads = 0);
+	~WorkerPool();
+
+	WorkerPool(const WorkerPool &) = delete;
+	WorkerPool &operator=(const WorkerPool &) = delete;
+
+	// Total threads taking part in Run(), including the caller
+	int GetThreadCount() const { return (int)mWorkers.size() + 1; }
+
+	// Calls task(index, thread) for every index in [0, count) and returns once
+	// all calls have finished. thread is in [0, GetThreadCount()) and is stable
+	// for the duration of a call, for per-thread scratch space. Not reentrant:
+	// one caller at a time, and never from inside a task of the same pool.
+	void Run(int count, const std::function<void(int index, int thread)> &task);
+
+private:
+	void WorkerMain(int thread);
+	void Drain(int thread);
+
+	std::vector<std::thread>	mWorkers;
+	std::mutex					mLock;
+	std::condition_variable		mWake;
+	std::condition_variable		mDone;
+	const std::function<void(int, int)> *mTask;
+	std::atomic<int>			mNext;
+	int							mCount;
+	int							mBusy;
+	unsigned int				mGeneration;
+	bool						mStop;
+};